@@ -0,0 +1,188 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+// Start-time skew of several grippers given a new goal position together, on
+// the simulated bus with 2 Mbps wire timing : write4ByteTxRx() to each gripper
+// in turn, against GripperGroup::writeGoals() (one Sync Write) and
+// GripperGroup::writeGoalsOnAction() (Reg Write to each, then one Action).
+// The skew of a command is the time between the first and the last gripper
+// applying its goal, as stamped by the simulated grippers.
+//
+// usage : action_skew_benchmark [rn|rna] [max grippers] [commands per run] [json file|-]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/gripper_group.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "rh_p12_rn/sim_port_handler.h"
+#include "benchmark_stats.h"
+
+#define PROTOCOL_VERSION        2.0
+#define BAUDRATE                2000000
+#define MAX_GRIPPERS            16
+
+enum Method
+{
+  METHOD_SEQUENTIAL,
+  METHOD_SYNC_WRITE,
+  METHOD_ACTION,
+  METHOD_COUNT
+};
+
+static const char *METHOD_NAME[METHOD_COUNT] = { "sequential", "sync_write", "reg_write_action" };
+
+// time between the first and the last gripper of the bus applying its goal
+static uint64_t getSkew(const rh_p12_rn::SimBus &bus, int count)
+{
+  uint64_t _first = UINT64_MAX, _last = 0;
+
+  for (int id = 1; id <= count; id++)
+  {
+    uint64_t _time = bus.getGripper((uint8_t)id)->getGoalChangeTime();
+    _first  = std::min(_first, _time);
+    _last   = std::max(_last, _time);
+  }
+  return _last - _first;
+}
+
+int main(int argc, char* argv[])
+{
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+  int         _max_count  = MAX_GRIPPERS;
+  int         _commands   = 1000;
+  const char *_json_path  = NULL;
+
+  if (argc > 1 && strcmp(argv[1], "rna") == 0)
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 2)
+    _max_count = atoi(argv[2]);
+  if (argc > 3)
+    _commands = atoi(argv[3]);
+  if (argc > 4)
+    _json_path = argv[4];
+  if (_max_count < 2 || _max_count > MAX_GRIPPERS)
+    _max_count = MAX_GRIPPERS;
+
+  dynamixel::PacketHandler *_ph = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+
+  std::vector<LatencyStats>   _stats((_max_count - 1) * METHOD_COUNT);
+  std::vector<unsigned long>  _fail((_max_count - 1) * METHOD_COUNT, 0);
+
+  printf("%s, simulated bus at %d bps, %d commands per run\n\n", _table->name, BAUDRATE, _commands);
+  printf(" grippers   start skew p50 / max (us)\n");
+  printf("            sequential            sync write            reg write + action\n");
+
+  for (int n = 2; n <= _max_count; n++)
+  {
+    std::string _name = SIM_PORT_PREFIX ":";
+    for (int id = 1; id <= n; id++)
+      _name += std::to_string(id) + ((id < n)? ",":"");
+    _name += (_table == &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA)? ":rna":":rn";
+
+    rh_p12_rn::SimPortHandler *_port = static_cast<rh_p12_rn::SimPortHandler *>(
+        rh_p12_rn::getPortHandler(_name.c_str(), *_table));
+    if (_port->openPort() == false || _port->setBaudRate(BAUDRATE) == false)
+    {
+      printf("Failed to open %s.\n", _name.c_str());
+      return 1;
+    }
+
+    rh_p12_rn::GripperGroup _group(_ph, _port, *_table);
+    for (int id = 1; id <= n; id++)
+      _group.addGripper((uint8_t)id);
+
+    LatencyStats  *_run_stats = &_stats[(n - 2) * METHOD_COUNT];
+    unsigned long *_run_fail  = &_fail[(n - 2) * METHOD_COUNT];
+    for (int m = 0; m < METHOD_COUNT; m++)
+      _run_stats[m].reserve(_commands);
+
+    for (int c = 0; c < _commands; c++)
+    {
+      for (int m = 0; m < METHOD_COUNT; m++)
+      {
+        // a different goal every command, so that every gripper stamps a change
+        int32_t _goal   = ((c * METHOD_COUNT + m) % 2 == 0)? _table->min_position : _table->max_position;
+        int     _result = COMM_SUCCESS;
+
+        if (m == METHOD_SEQUENTIAL)
+        {
+          for (int id = 1; id <= n; id++)
+          {
+            int _write_result = _ph->write4ByteTxRx(_port, (uint8_t)id, _table->addr_goal_position, _goal);
+            if (_write_result != COMM_SUCCESS)
+              _result = _write_result;
+          }
+        }
+        else
+        {
+          for (int i = 0; i < n; i++)
+            _group.setGoalPosition(i, _goal);
+          _result = (m == METHOD_SYNC_WRITE)? _group.writeGoals() : _group.writeGoalsOnAction();
+        }
+
+        if (_result != COMM_SUCCESS)
+          _run_fail[m]++;
+        else
+          _run_stats[m].add(getSkew(_port->getBus(), n));
+      }
+    }
+
+    printf(" %5d ", n);
+    for (int m = 0; m < METHOD_COUNT; m++)
+      printf("    %8.1f / %8.1f", _run_stats[m].getPercentile(50) / 1e3, _run_stats[m].getMax() / 1e3);
+    printf("  (%lu / %lu / %lu failed)\n", _run_fail[METHOD_SEQUENTIAL], _run_fail[METHOD_SYNC_WRITE], _run_fail[METHOD_ACTION]);
+
+    _port->closePort();
+    delete _port;
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"model\": \"%s\", \"baudrate\": %d, \"commands\": %d,\n \"results\": [\n", _table->name, BAUDRATE, _commands);
+    for (int n = 2; n <= _max_count; n++)
+    {
+      for (int m = 0; m < METHOD_COUNT; m++)
+      {
+        char _name[48];
+        snprintf(_name, sizeof(_name), "%s_%d", METHOD_NAME[m], n);
+        fprintf(_fp, "  ");
+        _stats[(n - 2) * METHOD_COUNT + m].printJSON(_fp, _name, _fail[(n - 2) * METHOD_COUNT + m]);
+        fprintf(_fp, "%s\n", (n < _max_count || m < METHOD_COUNT - 1)? ",":"");
+      }
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+
+// Packet timeout of the serial port as given against AdaptivePortHandler :
+// the time a read of an ID that does not answer takes to fail, and the reads
+// of a gripper that does answer which fail anyway (false timeouts). One read
+// in ten goes to the missing ID, so the adaptive port has learned the Read
+// round trip by the time most of them are sent.
+//
+// usage : adaptive_timeout_benchmark [device] [rn|rna] [id] [iterations] [baudrate] [json file|-] [missing id]
+//         device may be sim[:<id>][:fast] or a gripper_emulator terminal
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/adaptive_port_handler.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "benchmark_stats.h"
+
+#define PROTOCOL_VERSION        2.0
+#define MISSING_READ_INTERVAL   10
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+int main(int argc, char* argv[])
+{
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+  const char *_dev_name   = "sim";
+  uint8_t     _id         = 1;
+  int         _iterations = 1000;
+  int         _baudrate   = 2000000;
+  const char *_json_path  = NULL;
+  uint8_t     _missing_id = 200;
+
+  if (argc > 1)
+    _dev_name = argv[1];
+  if (argc > 2 && strcmp(argv[2], "rna") == 0)
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 3)
+    _id = (uint8_t)atoi(argv[3]);
+  if (argc > 4)
+    _iterations = atoi(argv[4]);
+  if (argc > 5)
+    _baudrate = atoi(argv[5]);
+  if (argc > 6 && strcmp(argv[6], "") != 0)
+    _json_path = argv[6];
+  if (argc > 7)
+    _missing_id = (uint8_t)atoi(argv[7]);
+
+  dynamixel::PacketHandler *_ph = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+
+  // the adaptive port wraps the plain one, so both runs share the device
+  rh_p12_rn::AdaptivePortHandler *_adaptive_port = new rh_p12_rn::AdaptivePortHandler(rh_p12_rn::getPortHandler(_dev_name, *_table));
+  dynamixel::PortHandler         *_plain_port    = _adaptive_port->getWrappedPort();
+
+  uint32_t _position;
+  if (_adaptive_port->openPort() == false || _adaptive_port->setBaudRate(_baudrate) == false)
+  {
+    printf("Failed to open %s.\n", _dev_name);
+    return 1;
+  }
+  if (_ph->read4ByteTxRx(_plain_port, _id, _table->addr_present_position, &_position) != COMM_SUCCESS)
+  {
+    printf("%s ID %d does not answer on %s at %d bps.\n", _table->name, _id, _dev_name, _baudrate);
+    return 1;
+  }
+
+  printf("%s ID %d on %s at %d bps, missing ID %d, %d reads per port\n\n",
+         _table->name, _id, _dev_name, _baudrate, _missing_id, _iterations);
+
+  const char             *_name[2]  = { "fixed", "adaptive" };
+  dynamixel::PortHandler *_port[2]  = { _plain_port, _adaptive_port };
+  LatencyStats            _read_stats[2];
+  LatencyStats            _missing_stats[2];
+  unsigned long           _false_timeout[2] = { 0, 0 };
+
+  for (int m = 0; m < 2; m++)
+  {
+    _read_stats[m].reserve(_iterations);
+    _missing_stats[m].reserve(_iterations / MISSING_READ_INTERVAL + 1);
+
+    for (int i = 0; i < _iterations; i++)
+    {
+      uint64_t _start = getMonotonicTimeNsec();
+      if (_ph->read4ByteTxRx(_port[m], _id, _table->addr_present_position, &_position) != COMM_SUCCESS)
+        _false_timeout[m]++;
+      else
+        _read_stats[m].add(getMonotonicTimeNsec() - _start);
+
+      if (i % MISSING_READ_INTERVAL == MISSING_READ_INTERVAL - 1)
+      {
+        _start = getMonotonicTimeNsec();
+        _ph->read4ByteTxRx(_port[m], _missing_id, _table->addr_present_position, &_position);
+        _missing_stats[m].add(getMonotonicTimeNsec() - _start);
+      }
+    }
+
+    printf(" %-9s read p50 %8.1f us  p99 %8.1f us  false timeouts %lu  |  missing ID fails after p50 %9.1f us  max %9.1f us\n",
+           _name[m], _read_stats[m].getPercentile(50) / 1e3, _read_stats[m].getPercentile(99) / 1e3, _false_timeout[m],
+           _missing_stats[m].getPercentile(50) / 1e3, _missing_stats[m].getMax() / 1e3);
+  }
+
+  std::vector<rh_p12_rn::AdaptiveTimeoutModel> _model = _adaptive_port->getModel();
+  printf("\n learned model    samples   p50 (us)   p%g (us)   timeout (us)   timeouts   late replies\n",
+         _adaptive_port->param().percentile);
+  for (size_t i = 0; i < _model.size(); i++)
+  {
+    printf("  inst 0x%02X   %10llu %10u %10u %14u %10llu %14llu\n", _model[i].instruction,
+           (unsigned long long)_model[i].sample_count, _model[i].p50_usec, _model[i].percentile_usec,
+           _model[i].timeout_usec, (unsigned long long)_model[i].timeout_count,
+           (unsigned long long)_model[i].late_reply_count);
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"model\": \"%s\", \"device\": \"%s\", \"baudrate\": %d,\n \"results\": [\n", _table->name, _dev_name, _baudrate);
+    for (int m = 0; m < 2; m++)
+    {
+      char _stats_name[32];
+      snprintf(_stats_name, sizeof(_stats_name), "%s_read", _name[m]);
+      fprintf(_fp, "  ");
+      _read_stats[m].printJSON(_fp, _stats_name, _false_timeout[m]);
+      snprintf(_stats_name, sizeof(_stats_name), "%s_missing", _name[m]);
+      fprintf(_fp, ",\n  ");
+      _missing_stats[m].printJSON(_fp, _stats_name);
+      fprintf(_fp, "%s\n", (m == 0)? ",":"");
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  _adaptive_port->closePort();
+  delete _adaptive_port;
+  return 0;
+}
@@ -0,0 +1,65 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+// Heap allocation counting shared by the benchmarks (Linux, glibc).
+// Include it in one translation unit only : it replaces malloc, calloc, realloc
+// and free of the whole program, the SDK library and operator new included.
+
+#ifndef RH_P12_RN_BENCHMARK_ALLOCCOUNTER_H_
+#define RH_P12_RN_BENCHMARK_ALLOCCOUNTER_H_
+
+
+#include <stddef.h>
+#include <atomic>
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void  __libc_free(void *ptr);
+
+static std::atomic<unsigned long> g_alloc_count(0);
+
+extern "C" void *malloc(size_t size)
+{
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void *ptr)
+{
+  __libc_free(ptr);
+}
+
+// allocations since the start of the program, every thread
+inline unsigned long getAllocCount()
+{
+  return g_alloc_count.load(std::memory_order_relaxed);
+}
+
+
+#endif /* RH_P12_RN_BENCHMARK_ALLOCCOUNTER_H_ */
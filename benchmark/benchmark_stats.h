@@ -0,0 +1,112 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+// Latency sample collection shared by the benchmarks.
+
+#ifndef RH_P12_RN_BENCHMARK_BENCHMARKSTATS_H_
+#define RH_P12_RN_BENCHMARK_BENCHMARKSTATS_H_
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+class LatencyStats
+{
+ private:
+  std::vector<uint64_t> samples_;   // nanoseconds
+  bool                  is_sorted_;
+
+  void sort()
+  {
+    if (is_sorted_ == false)
+    {
+      std::sort(samples_.begin(), samples_.end());
+      is_sorted_ = true;
+    }
+  }
+
+ public:
+  LatencyStats() : is_sorted_(true) { }
+
+  void      reserve(size_t count)   { samples_.reserve(count); }
+  void      clear()                 { samples_.clear(); is_sorted_ = true; }
+  size_t    getCount() const        { return samples_.size(); }
+
+  void add(uint64_t nsec)
+  {
+    samples_.push_back(nsec);
+    is_sorted_ = false;
+  }
+
+  void merge(const LatencyStats &other)
+  {
+    samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+    is_sorted_ = false;
+  }
+
+  // percent in [0, 100]
+  uint64_t getPercentile(double percent)
+  {
+    if (samples_.empty())
+      return 0;
+    sort();
+    size_t _index = (size_t)(percent / 100.0 * (samples_.size() - 1) + 0.5);
+    return samples_[_index];
+  }
+
+  uint64_t getMax()
+  {
+    return getPercentile(100.0);
+  }
+
+  double getMean() const
+  {
+    if (samples_.empty())
+      return 0;
+    double _sum = 0;
+    for (size_t i = 0; i < samples_.size(); i++)
+      _sum += samples_[i];
+    return _sum / samples_.size();
+  }
+
+  // back to back rate the mean latency allows
+  double getRate() const
+  {
+    double _mean = getMean();
+    return (_mean > 0)? 1e9 / _mean:0;
+  }
+
+  // one line : name, count, p50 / p99 / max in microseconds
+  void print(const char *name)
+  {
+    printf(" %-28s n=%-8lu p50 %9.1f us  p99 %9.1f us  max %9.1f us\n", name, (unsigned long)getCount(),
+           getPercentile(50) / 1e3, getPercentile(99) / 1e3, getMax() / 1e3);
+  }
+
+  // one JSON object, no trailing separator
+  void printJSON(FILE *fp, const char *name, unsigned long fail_count = 0)
+  {
+    fprintf(fp, "{\"name\": \"%s\", \"count\": %lu, \"p50_us\": %.2f, \"p99_us\": %.2f, \"p999_us\": %.2f, "
+                "\"max_us\": %.2f, \"mean_us\": %.2f, \"hz\": %.1f, \"fail\": %lu}",
+            name, (unsigned long)getCount(), getPercentile(50) / 1e3, getPercentile(99) / 1e3,
+            getPercentile(99.9) / 1e3, getMax() / 1e3, getMean() / 1e3, getRate(), fail_count);
+  }
+};
+
+
+#endif /* RH_P12_RN_BENCHMARK_BENCHMARKSTATS_H_ */
@@ -0,0 +1,233 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+// Cost of taking the status packets of one Bulk Read apart, against the number
+// of IDs : GroupBulkRead::rxPacket() and FlatBulkRead::rxPacket() parse the same
+// recorded status packets. The IDs read different spans in turn (Present Position
+// alone, Moving to Present Current, Present Voltage and Present Temperature), and
+// every register of a span is fetched with getData(). The port replays the
+// recording, so only the host side is measured; heap allocations per cycle are
+// counted as well.
+//
+// usage : bulk_read_benchmark [rn|rna] [max IDs] [cycles per run] [json file|-]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/flat_bulk_read.h"
+#include "rh_p12_rn/protocol2.h"
+#include "alloc_counter.h"
+#include "benchmark_stats.h"
+#include "replay_port_handler.h"
+
+#define PROTOCOL_VERSION        2.0
+#define MAX_IDS                 32
+#define SPAN_COUNT              3
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+struct Register
+{
+  uint16_t  address;
+  uint16_t  length;
+};
+
+struct Span
+{
+  uint16_t  start;
+  uint16_t  length;
+  Register  register_list[3];
+  int       register_count;
+};
+
+struct Result
+{
+  LatencyStats  sdk_stats;
+  LatencyStats  flat_stats;
+  double        sdk_alloc;      // per cycle
+  double        flat_alloc;
+  unsigned long sdk_fail;
+  unsigned long flat_fail;
+};
+
+static Span makeSpan(const Register *register_list, int register_count)
+{
+  Span _span;
+  uint16_t _end = 0;
+  _span.start = 0xFFFF;
+  for (int i = 0; i < register_count; i++)
+  {
+    _span.register_list[i] = register_list[i];
+    _span.start = std::min(_span.start, register_list[i].address);
+    _end        = std::max(_end, (uint16_t)(register_list[i].address + register_list[i].length));
+  }
+  _span.length          = _end - _span.start;
+  _span.register_count  = register_count;
+  return _span;
+}
+
+int main(int argc, char* argv[])
+{
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+  int         _max_count  = MAX_IDS;
+  int         _cycles     = 20000;
+  const char *_json_path  = NULL;
+
+  if (argc > 1 && strcmp(argv[1], "rna") == 0)
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 2)
+    _max_count = atoi(argv[2]);
+  if (argc > 3)
+    _cycles = atoi(argv[3]);
+  if (argc > 4)
+    _json_path = argv[4];
+  if (_max_count < 1 || _max_count > MAX_IDS)
+    _max_count = MAX_IDS;
+
+  dynamixel::PacketHandler *_ph = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+
+  // ID n reads _span_list[n % SPAN_COUNT]
+  Register _position[]  = { { _table->addr_present_position, LEN_PRESENT_POSITION } };
+  Register _motion[]    = { { _table->addr_moving, LEN_MOVING },
+                            { _table->addr_present_position, LEN_PRESENT_POSITION },
+                            { _table->addr_present_current, LEN_PRESENT_CURRENT } };
+  Register _health[]    = { { _table->addr_present_voltage, LEN_PRESENT_VOLTAGE },
+                            { _table->addr_present_temperature, LEN_PRESENT_TEMPERATURE } };
+  Span _span_list[SPAN_COUNT] = { makeSpan(_position, 1), makeSpan(_motion, 3), makeSpan(_health, 2) };
+
+  std::vector<Result> _result_list(_max_count);
+
+  printf("%s, spans of %d, %d and %d bytes, %d cycles per run\n\n", _table->name,
+         _span_list[0].length, _span_list[1].length, _span_list[2].length, _cycles);
+  printf("   IDs   GroupBulkRead (p50 / p99)   FlatBulkRead (p50 / p99)   speedup   allocs per cycle\n");
+
+  for (int n = 1; n <= _max_count; n++)
+  {
+    Result &_result = _result_list[n - 1];
+
+    // one recorded status packet per ID, in the order GroupBulkRead reads them
+    std::vector<uint8_t> _reply;
+    srand(n);
+    for (int id = 1; id <= n; id++)
+    {
+      const Span &_span = _span_list[id % SPAN_COUNT];
+      uint8_t _payload[P2_MAX_PACKET_LENGTH];
+      uint8_t _packet[P2_MAX_PACKET_LENGTH];
+      _payload[0] = 0;
+      for (uint16_t i = 0; i < _span.length; i++)
+        _payload[1 + i] = (uint8_t)rand();
+      size_t _packet_length = rh_p12_rn::buildPacket((uint8_t)id, P2_INST_STATUS, _payload, 1 + _span.length, _packet);
+      _reply.insert(_reply.end(), _packet, _packet + _packet_length);
+    }
+
+    ReplayPortHandler _port;
+    _port.setReply(_reply);
+
+    dynamixel::GroupBulkRead  _sdk_read(&_port, _ph);
+    rh_p12_rn::FlatBulkRead   _flat_read(&_port, _ph);
+    for (int id = 1; id <= n; id++)
+    {
+      const Span &_span = _span_list[id % SPAN_COUNT];
+      _sdk_read.addParam((uint8_t)id, _span.start, _span.length);
+      _flat_read.addParam((uint8_t)id, _span.start, _span.length);
+    }
+    _result.sdk_stats.reserve(_cycles);
+    _result.flat_stats.reserve(_cycles);
+    _result.sdk_fail  = 0;
+    _result.flat_fail = 0;
+
+    volatile uint32_t _sink = 0;
+
+    unsigned long _alloc = getAllocCount();
+    for (int c = 0; c < _cycles; c++)
+    {
+      _port.rewind();
+      uint64_t _start_nsec = getMonotonicTimeNsec();
+      if (_sdk_read.rxPacket() != COMM_SUCCESS)
+        _result.sdk_fail++;
+      for (int id = 1; id <= n; id++)
+      {
+        const Span &_span = _span_list[id % SPAN_COUNT];
+        for (int r = 0; r < _span.register_count; r++)
+          _sink += _sdk_read.getData((uint8_t)id, _span.register_list[r].address, _span.register_list[r].length);
+      }
+      _result.sdk_stats.add(getMonotonicTimeNsec() - _start_nsec);
+    }
+    _result.sdk_alloc = (double)(getAllocCount() - _alloc) / _cycles;
+
+    _alloc = getAllocCount();
+    for (int c = 0; c < _cycles; c++)
+    {
+      _port.rewind();
+      uint64_t _start_nsec = getMonotonicTimeNsec();
+      if (_flat_read.rxPacket() != COMM_SUCCESS)
+        _result.flat_fail++;
+      for (int id = 1; id <= n; id++)
+      {
+        const Span &_span = _span_list[id % SPAN_COUNT];
+        for (int r = 0; r < _span.register_count; r++)
+          _sink += _flat_read.getData((uint8_t)id, _span.register_list[r].address, _span.register_list[r].length);
+      }
+      _result.flat_stats.add(getMonotonicTimeNsec() - _start_nsec);
+    }
+    _result.flat_alloc = (double)(getAllocCount() - _alloc) / _cycles;
+
+    double _sdk_p50   = _result.sdk_stats.getPercentile(50) / 1e3;
+    double _flat_p50  = _result.flat_stats.getPercentile(50) / 1e3;
+    printf(" %5d   %7.2f / %7.2f us        %7.2f / %7.2f us       x%5.2f    %5.1f / %5.1f%s\n", n,
+           _sdk_p50, _result.sdk_stats.getPercentile(99) / 1e3,
+           _flat_p50, _result.flat_stats.getPercentile(99) / 1e3,
+           (_flat_p50 > 0)? _sdk_p50 / _flat_p50 : 0.0, _result.sdk_alloc, _result.flat_alloc,
+           (_result.sdk_fail + _result.flat_fail > 0)? "  (failed reads)":"");
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"model\": \"%s\", \"cycles\": %d,\n \"results\": [\n", _table->name, _cycles);
+    for (int n = 1; n <= _max_count; n++)
+    {
+      char _name[32];
+      snprintf(_name, sizeof(_name), "group_bulk_read_%d", n);
+      fprintf(_fp, "  ");
+      _result_list[n - 1].sdk_stats.printJSON(_fp, _name, _result_list[n - 1].sdk_fail);
+      snprintf(_name, sizeof(_name), "flat_bulk_read_%d", n);
+      fprintf(_fp, ",\n  ");
+      _result_list[n - 1].flat_stats.printJSON(_fp, _name, _result_list[n - 1].flat_fail);
+      fprintf(_fp, ",\n  {\"name\": \"allocs_%d\", \"group_bulk_read\": %.2f, \"flat_bulk_read\": %.2f}%s\n", n,
+              _result_list[n - 1].sdk_alloc, _result_list[n - 1].flat_alloc, (n < _max_count)? ",":"");
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+
+// Telemetry throughput against the number of serial adapters : BusManager
+// reads the motion state of every gripper with one Sync Read per port, each
+// port on its own bus thread pinned to its own CPU, for 1, 2 ... N ports.
+// The ports are simulated buses with 2 Mbps wire timing by default; give the
+// links of gripper_emulator instances to run the real serial port code.
+//
+// usage : bus_manager_benchmark [rn|rna] [grippers per port] [seconds per run] [json file|-|""] [device ...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/bus_manager.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "rh_p12_rn/sim_port_handler.h"
+#include "benchmark_stats.h"
+
+#define PROTOCOL_VERSION        2.0
+#define BAUDRATE                2000000
+#define SIM_PORT_COUNT          4
+#define MAX_GRIPPERS            16
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+int main(int argc, char* argv[])
+{
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+  int         _gripper_count  = 4;
+  double      _seconds        = 3.0;
+  const char *_json_path      = NULL;
+  std::vector<std::string> _device_list;
+
+  if (argc > 1 && strcmp(argv[1], "rna") == 0)
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 2)
+    _gripper_count = atoi(argv[2]);
+  if (argc > 3)
+    _seconds = atof(argv[3]);
+  if (argc > 4 && strcmp(argv[4], "") != 0)
+    _json_path = argv[4];
+  for (int i = 5; i < argc; i++)
+    _device_list.push_back(argv[i]);
+  if (_gripper_count < 1 || _gripper_count > MAX_GRIPPERS)
+    _gripper_count = 4;
+
+  if (_device_list.empty())
+  {
+    std::string _name = SIM_PORT_PREFIX ":";
+    for (int id = 1; id <= _gripper_count; id++)
+      _name += std::to_string(id) + ((id < _gripper_count)? ",":"");
+    _name += (_table == &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA)? ":rna":":rn";
+    _device_list.assign(SIM_PORT_COUNT, _name);
+  }
+
+  dynamixel::PacketHandler *_ph = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+  int _cpu_count = (int)std::thread::hardware_concurrency();
+  int _port_max  = (int)_device_list.size();
+
+  std::vector<LatencyStats>   _stats(_port_max);
+  std::vector<double>         _rate(_port_max, 0.0);
+  std::vector<unsigned long>  _fail(_port_max, 0);
+
+  printf("%s, %d grippers per port at %d bps, %.1f s per run, %d CPUs\n\n", _table->name, _gripper_count,
+         BAUDRATE, _seconds, _cpu_count);
+  printf(" ports   cycle p50 / p99 (us)     grippers read / s    scaling\n");
+
+  for (int n = 1; n <= _port_max; n++)
+  {
+    rh_p12_rn::BusManager _manager(_ph, *_table);
+
+    for (int p = 0; p < n; p++)
+    {
+      dynamixel::PortHandler *_port = rh_p12_rn::getPortHandler(_device_list[p].c_str(), *_table);
+      if (_port->openPort() == false || _port->setBaudRate(BAUDRATE) == false)
+      {
+        printf("Failed to open %s.\n", _device_list[p].c_str());
+        delete _port;
+        return 1;
+      }
+
+      // keep CPU 0 for the thread driving the cycles when there are enough of them
+      size_t _index = _manager.addPort(_port, (_cpu_count > 1)? 1 + p % (_cpu_count - 1) : -1);
+      for (int id = 1; id <= _gripper_count; id++)
+        _manager.addGripper(_index, (uint8_t)id);
+    }
+    _manager.start();
+
+    uint64_t _start = getMonotonicTimeNsec();
+    uint64_t _end   = _start + (uint64_t)(_seconds * 1e9);
+    uint64_t _now   = _start;
+    unsigned long _cycles = 0;
+
+    while (_now < _end)
+    {
+      if (_manager.readTelemetry() != COMM_SUCCESS)
+        _fail[n - 1]++;
+
+      uint64_t _done = getMonotonicTimeNsec();
+      _stats[n - 1].add(_done - _now);
+      _now = _done;
+      _cycles++;
+    }
+    _manager.stop();
+
+    _rate[n - 1] = (double)_cycles * n * _gripper_count / ((_now - _start) / 1e9);
+    printf(" %5d     %8.1f / %8.1f      %12.0f          x%.2f  (%lu failed)\n", n,
+           _stats[n - 1].getPercentile(50) / 1e3, _stats[n - 1].getPercentile(99) / 1e3,
+           _rate[n - 1], (_rate[0] > 0)? _rate[n - 1] / _rate[0] : 0.0, _fail[n - 1]);
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"model\": \"%s\", \"baudrate\": %d, \"grippers_per_port\": %d,\n \"results\": [\n",
+            _table->name, BAUDRATE, _gripper_count);
+    for (int n = 1; n <= _port_max; n++)
+    {
+      char _name[32];
+      snprintf(_name, sizeof(_name), "ports_%d", n);
+      fprintf(_fp, "  {\"grippers_per_sec\": %.1f, \"cycle\": ", _rate[n - 1]);
+      _stats[n - 1].printJSON(_fp, _name, _fail[n - 1]);
+      fprintf(_fp, "}%s\n", (n < _port_max)? ",":"");
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+// BusOwner enqueue -> completion throughput and latency under contention.
+// Transactions do not touch a port; each one spins for [work_usec] to stand
+// in for the wire time of a real packet.
+//
+// usage : bus_owner_benchmark [requests per producer] [work_usec]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#include "rh_p12_rn/bus_owner.h"
+#include "rh_p12_rn/clock.h"
+#include "benchmark_stats.h"
+
+using rh_p12_rn::BusOwner;
+using rh_p12_rn::getMonotonicTimeNsec;
+
+int g_work_usec = 0;
+
+int doWork(dynamixel::PacketHandler *, dynamixel::PortHandler *)
+{
+  if (g_work_usec > 0)
+  {
+    uint64_t _end = getMonotonicTimeNsec() + (uint64_t)g_work_usec * 1000;
+    while (getMonotonicTimeNsec() < _end) { }
+  }
+  return COMM_SUCCESS;
+}
+
+// every producer waits on the future of each request : round trip latency
+void runFuture(int producers, int requests)
+{
+  BusOwner _bus(NULL, NULL);
+  _bus.start();
+
+  std::vector<LatencyStats> _stats(producers);
+  std::vector<std::thread>  _threads;
+
+  uint64_t _start = getMonotonicTimeNsec();
+  for (int p = 0; p < producers; p++)
+  {
+    _threads.push_back(std::thread([&_bus, &_stats, p, requests]()
+    {
+      _stats[p].reserve(requests);
+      for (int i = 0; i < requests; i++)
+      {
+        uint64_t _t0 = getMonotonicTimeNsec();
+        _bus.submit(&doWork).get();
+        _stats[p].add(getMonotonicTimeNsec() - _t0);
+      }
+    }));
+  }
+  for (size_t i = 0; i < _threads.size(); i++)
+    _threads[i].join();
+  uint64_t _elapsed = getMonotonicTimeNsec() - _start;
+  _bus.stop();
+
+  LatencyStats _all;
+  for (int p = 0; p < producers; p++)
+    _all.merge(_stats[p]);
+
+  char _name[64];
+  snprintf(_name, sizeof(_name), "future   x%d producers", producers);
+  _all.print(_name);
+  printf(" %-28s %.0f transactions/s\n", "", _all.getCount() / (_elapsed / 1e9));
+}
+
+// producers fire and forget, completion time is taken in the callback
+void runCallback(int producers, int requests)
+{
+  BusOwner _bus(NULL, NULL);
+  _bus.start();
+
+  LatencyStats _stats;   // only touched by the bus thread
+  _stats.reserve((size_t)producers * requests);
+
+  std::vector<std::thread> _threads;
+
+  uint64_t _start = getMonotonicTimeNsec();
+  for (int p = 0; p < producers; p++)
+  {
+    _threads.push_back(std::thread([&_bus, &_stats, requests]()
+    {
+      for (int i = 0; i < requests; i++)
+      {
+        uint64_t _t0 = getMonotonicTimeNsec();
+        _bus.post(&doWork, [&_stats, _t0](int) { _stats.add(getMonotonicTimeNsec() - _t0); });
+      }
+    }));
+  }
+  for (size_t i = 0; i < _threads.size(); i++)
+    _threads[i].join();
+  while (_bus.getCompletedCount() < (uint64_t)producers * requests)
+    std::this_thread::yield();
+  uint64_t _elapsed = getMonotonicTimeNsec() - _start;
+  _bus.stop();
+
+  char _name[64];
+  snprintf(_name, sizeof(_name), "callback x%d producers", producers);
+  _stats.print(_name);
+  printf(" %-28s %.0f transactions/s\n", "", _stats.getCount() / (_elapsed / 1e9));
+}
+
+int main(int argc, char* argv[])
+{
+  int _requests = 100000;
+
+  if (argc > 1)
+    _requests = atoi(argv[1]);
+  if (argc > 2)
+    g_work_usec = atoi(argv[2]);
+
+  printf("BusOwner : %d requests per producer, %d us per transaction\n\n", _requests, g_work_usec);
+
+  const int _producers[] = { 1, 2, 4, 8 };
+  for (size_t i = 0; i < sizeof(_producers) / sizeof(_producers[0]); i++)
+    runFuture(_producers[i], _requests);
+  printf("\n");
+  for (size_t i = 0; i < sizeof(_producers) / sizeof(_producers[0]); i++)
+    runCallback(_producers[i], _requests);
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+// Pacing of a control loop whose step takes a varying time (a stand-in for
+// one transaction) : usleep(period) after the step, as the examples used to
+// do, against ControlLoop's absolute deadlines.
+//
+// usage : control_loop_benchmark [period_usec] [seconds] [rt_priority] [cpu] [mlock 0|1]
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_loop.h"
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+// 150-450 us of busy work, varying from cycle to cycle
+void doStep()
+{
+  static unsigned int _seed = 1;
+  _seed = _seed * 1103515245 + 12345;
+  uint64_t _end = getMonotonicTimeNsec() + 150 * 1000 + (_seed >> 16) % (300 * 1000);
+  while (getMonotonicTimeNsec() < _end) { }
+}
+
+int main(int argc, char* argv[])
+{
+  uint32_t  _period_usec  = 1000;
+  double    _seconds      = 5.0;
+  int       _priority     = 0;
+  int       _cpu          = -1;
+  bool      _lock_memory  = false;
+
+  if (argc > 1) _period_usec  = atoi(argv[1]);
+  if (argc > 2) _seconds      = atof(argv[2]);
+  if (argc > 3) _priority     = atoi(argv[3]);
+  if (argc > 4) _cpu          = atoi(argv[4]);
+  if (argc > 5) _lock_memory  = atoi(argv[5]) != 0;
+
+  printf("period %u us (%.0f Hz), %.1f s per run\n\n", _period_usec, 1e6 / _period_usec, _seconds);
+
+  // usleep after the step : the period stretches by the step time
+  uint64_t _start = getMonotonicTimeNsec();
+  uint64_t _end   = _start + (uint64_t)(_seconds * 1e9);
+  uint64_t _count = 0;
+  while (getMonotonicTimeNsec() < _end)
+  {
+    doStep();
+    usleep(_period_usec);
+    _count++;
+  }
+  double _rate = _count / ((getMonotonicTimeNsec() - _start) / 1e9);
+  printf(" usleep pacing     : %8.1f Hz (%.1f%% of target)\n", _rate, _rate * _period_usec / 1e4);
+
+  // ControlLoop : absolute deadlines
+  rh_p12_rn::ControlLoop _loop(_period_usec);
+  _loop.setRealtimePriority(_priority);
+  _loop.setCpuAffinity(_cpu);
+  _loop.setLockMemory(_lock_memory);
+
+  _start = getMonotonicTimeNsec();
+  _loop.start(&doStep);
+  usleep((useconds_t)(_seconds * 1e6));
+  _loop.stop();
+
+  rh_p12_rn::ControlLoopStats _stats = _loop.getStats();
+  _rate = _stats.cycle_count / ((getMonotonicTimeNsec() - _start) / 1e9);
+  printf(" ControlLoop       : %8.1f Hz (%.1f%% of target)\n", _rate, _rate * _period_usec / 1e4);
+  printf("   SCHED_FIFO %s, CPU pinning %s, mlockall %s\n",
+         (_stats.is_realtime)? "on":"off", (_stats.is_cpu_pinned)? "on":"off", (_stats.is_memory_locked)? "on":"off");
+  printf("   cycles %lu, overruns %lu, missed deadlines %lu, longest step %.1f us\n",
+         (unsigned long)_stats.cycle_count, (unsigned long)_stats.overrun_count,
+         (unsigned long)_stats.missed_count, _stats.max_step_nsec / 1e3);
+  printf("   jitter min %.1f us, mean %.1f us, max %.1f us\n",
+         _stats.min_jitter_nsec / 1e3, _stats.mean_jitter_nsec / 1e3, _stats.max_jitter_nsec / 1e3);
+  printf("   jitter histogram :\n");
+  for (int i = 0; i < JITTER_HISTOGRAM_SIZE; i++)
+  {
+    if (_stats.jitter_histogram[i] == 0)
+      continue;
+    if (i == JITTER_HISTOGRAM_SIZE - 1)
+      printf("     >= %5d us : %lu\n", 1 << (i - 1), (unsigned long)_stats.jitter_histogram[i]);
+    else
+      printf("     <  %5d us : %lu\n", 1 << i, (unsigned long)_stats.jitter_histogram[i]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,180 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+
+// Cost of the Protocol 2.0 CRC against the number of bytes, from the 10 bytes of
+// a ping to the 4 KB of a firmware or log block :
+//   bytewise        one table lookup per byte, the SDK's updateCRC
+//   slicing-by-8    eight tables, eight bytes per step
+//   pclmulqdq       128-bit folding with carry-less multiplies (x86-64 only)
+//   updateCRC       whichever of them this CPU runs, as the packet code calls it
+// Every implementation is first checked against the bytewise CRC on random data,
+// random lengths and random initial CRCs; the benchmark exits with 1 on a mismatch.
+// Each sample times CRC_REPEAT calls and is divided down to one call.
+//
+// usage : crc_benchmark [samples per size] [json file|-]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/crc16.h"
+#include "benchmark_stats.h"
+
+#define CRC_REPEAT              64
+#define CHECK_COUNT             20000
+#define MAX_SIZE                4096
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+static const size_t SIZE_LIST[]   = { 10, 14, 22, 48, 64, 128, 256, 1024, MAX_SIZE };
+static const int    SIZE_COUNT    = sizeof(SIZE_LIST) / sizeof(SIZE_LIST[0]);
+static const int    METHOD_COUNT  = 4;    // the three implementations and updateCRC
+
+static const char *getMethodName(int method)
+{
+  return (method < 3)? rh_p12_rn::getCRCImplementationName((rh_p12_rn::CRCImplementation)method):"updateCRC";
+}
+
+static uint16_t runMethod(int method, uint16_t crc, const uint8_t *data, size_t size)
+{
+  if (method < 3)
+    return rh_p12_rn::updateCRC((rh_p12_rn::CRCImplementation)method, crc, data, size);
+  return rh_p12_rn::updateCRC(crc, data, size);
+}
+
+static bool isMethodAvailable(int method)
+{
+  return method == 3 || rh_p12_rn::isCRCImplementationAvailable((rh_p12_rn::CRCImplementation)method);
+}
+
+int main(int argc, char* argv[])
+{
+  int         _samples    = 20000;
+  const char *_json_path  = NULL;
+
+  if (argc > 1)
+    _samples = atoi(argv[1]);
+  if (argc > 2)
+    _json_path = argv[2];
+  if (_samples < 1)
+    _samples = 1;
+
+  std::vector<uint8_t> _data(MAX_SIZE + 16);
+  srand(1);
+  for (size_t i = 0; i < _data.size(); i++)
+    _data[i] = (uint8_t)rand();
+
+  // bit-exactness against the bytewise table, at every offset and length
+  for (int c = 0; c < CHECK_COUNT; c++)
+  {
+    size_t    _offset = rand() % 16;
+    size_t    _size   = (c < MAX_SIZE)? c : rand() % (MAX_SIZE + 1);
+    uint16_t  _init   = (c & 1)? (uint16_t)rand() : 0;
+    uint16_t  _expect = rh_p12_rn::updateCRC(rh_p12_rn::CRC_BYTEWISE, _init, &_data[_offset], _size);
+
+    for (int m = 1; m < METHOD_COUNT; m++)
+    {
+      uint16_t _crc = runMethod(m, _init, &_data[_offset], _size);
+      if (isMethodAvailable(m) && _crc != _expect)
+      {
+        fprintf(stderr, "%s : CRC 0x%04X of %lu bytes at offset %lu from 0x%04X, expected 0x%04X\n", getMethodName(m),
+                _crc, (unsigned long)_size, (unsigned long)_offset, _init, _expect);
+        return 1;
+      }
+    }
+  }
+
+  printf("updateCRC runs %s, %d samples per size, ns per call (p50 / p99) and MB/s at p50\n\n",
+         rh_p12_rn::getCRCImplementationName(rh_p12_rn::getCRCImplementation()), _samples);
+  printf("  bytes");
+  for (int m = 0; m < METHOD_COUNT; m++)
+    printf("   %-27s", getMethodName(m));
+  printf("\n");
+
+  std::vector<LatencyStats> _stats_list(SIZE_COUNT * METHOD_COUNT);
+  volatile uint16_t _sink = 0;
+
+  for (int s = 0; s < SIZE_COUNT; s++)
+  {
+    size_t _size = SIZE_LIST[s];
+
+    printf(" %6lu", (unsigned long)_size);
+    for (int m = 0; m < METHOD_COUNT; m++)
+    {
+      LatencyStats &_stats = _stats_list[s * METHOD_COUNT + m];
+      if (isMethodAvailable(m) == false)
+      {
+        printf("   %-27s", "-");
+        continue;
+      }
+
+      _stats.reserve(_samples);
+      for (int i = 0; i < _samples; i++)
+      {
+        uint16_t _crc = 0;
+        uint64_t _start_nsec = getMonotonicTimeNsec();
+        for (int r = 0; r < CRC_REPEAT; r++)
+          _crc = runMethod(m, _crc, &_data[0], _size);
+        _stats.add(getMonotonicTimeNsec() - _start_nsec);
+        _sink ^= _crc;
+      }
+
+      double _p50 = (double)_stats.getPercentile(50) / CRC_REPEAT;
+      double _p99 = (double)_stats.getPercentile(99) / CRC_REPEAT;
+      printf("   %7.1f / %7.1f %7.0f", _p50, _p99, (_p50 > 0)? _size * 1e3 / _p50:0);
+    }
+    printf("\n");
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"update_crc\": \"%s\", \"samples\": %d,\n \"results\": [\n",
+            rh_p12_rn::getCRCImplementationName(rh_p12_rn::getCRCImplementation()), _samples);
+    bool _first = true;
+    for (int s = 0; s < SIZE_COUNT; s++)
+    {
+      for (int m = 0; m < METHOD_COUNT; m++)
+      {
+        LatencyStats &_stats = _stats_list[s * METHOD_COUNT + m];
+        if (_stats.getCount() == 0)
+          continue;
+
+        double _p50 = (double)_stats.getPercentile(50) / CRC_REPEAT;
+        fprintf(_fp, "%s  {\"name\": \"%s\", \"bytes\": %lu, \"p50_ns\": %.2f, \"p99_ns\": %.2f, \"mb_per_s\": %.1f}",
+                _first? "":",\n", getMethodName(m), (unsigned long)SIZE_LIST[s], _p50,
+                (double)_stats.getPercentile(99) / CRC_REPEAT, (_p50 > 0)? SIZE_LIST[s] * 1e3 / _p50:0);
+        _first = false;
+      }
+    }
+    fprintf(_fp, "\n ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  return 0;
+}
@@ -0,0 +1,207 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+// Cost of decoding Moving, Present Position and Present Current of every ID once
+// the status packets of a Sync Read have been received, against the number of IDs :
+//   GroupSyncRead::getData()  map lookup and DXL_MAKEDWORD on the copy of each ID
+//   FlatSyncRead::getData()   slot index and register assembly, three calls per ID
+//   MotionView                one view per ID on the data where it was received
+// Each sample decodes every ID DECODE_REPEAT times and is divided down to one
+// decode of all IDs, so the clock resolution does not hide the small groups.
+//
+// usage : decode_benchmark [rn|rna] [max IDs] [samples per run] [json file|-]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/flat_sync_read.h"
+#include "rh_p12_rn/protocol2.h"
+#include "rh_p12_rn/register_view.h"
+#include "benchmark_stats.h"
+#include "replay_port_handler.h"
+
+#define PROTOCOL_VERSION        2.0
+#define MAX_IDS                 32
+#define DECODE_REPEAT           64
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+struct Result
+{
+  LatencyStats  sdk_stats;
+  LatencyStats  flat_stats;
+  LatencyStats  view_stats;
+};
+
+int main(int argc, char* argv[])
+{
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+  int         _max_count  = MAX_IDS;
+  int         _samples    = 20000;
+  const char *_json_path  = NULL;
+
+  if (argc > 1 && strcmp(argv[1], "rna") == 0)
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 2)
+    _max_count = atoi(argv[2]);
+  if (argc > 3)
+    _samples = atoi(argv[3]);
+  if (argc > 4)
+    _json_path = argv[4];
+  if (_max_count < 1 || _max_count > MAX_IDS)
+    _max_count = MAX_IDS;
+
+  dynamixel::PacketHandler *_ph = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+
+  rh_p12_rn::MotionLayout _layout(*_table);
+  uint16_t _start   = std::min(_table->addr_moving, std::min(_table->addr_present_position, _table->addr_present_current));
+  uint16_t _length  = std::max(_table->addr_moving + LEN_MOVING,
+                               std::max(_table->addr_present_position + LEN_PRESENT_POSITION,
+                                        _table->addr_present_current + LEN_PRESENT_CURRENT)) - _start;
+
+  std::vector<Result> _result_list(_max_count);
+
+  printf("%s, %d bytes per ID, %d samples per run, ns per decode of all IDs (p50 / p99)\n\n", _table->name, _length, _samples);
+  printf("   IDs   GroupSyncRead::getData   FlatSyncRead::getData        MotionView\n");
+
+  for (int n = 1; n <= _max_count; n++)
+  {
+    Result &_result = _result_list[n - 1];
+
+    // one recorded status packet per ID
+    std::vector<uint8_t> _reply;
+    srand(n);
+    for (int id = 1; id <= n; id++)
+    {
+      uint8_t _payload[64];
+      uint8_t _packet[P2_MAX_PACKET_LENGTH];
+      _payload[0] = 0;
+      for (uint16_t i = 0; i < _length; i++)
+        _payload[1 + i] = (uint8_t)rand();
+      size_t _packet_length = rh_p12_rn::buildPacket((uint8_t)id, P2_INST_STATUS, _payload, 1 + _length, _packet);
+      _reply.insert(_reply.end(), _packet, _packet + _packet_length);
+    }
+
+    ReplayPortHandler _port;
+    _port.setReply(_reply);
+
+    dynamixel::GroupSyncRead  _sdk_read(&_port, _ph, _start, _length);
+    rh_p12_rn::FlatSyncRead   _flat_read(&_port, _ph, _start, _length);
+    for (int id = 1; id <= n; id++)
+    {
+      _sdk_read.addParam((uint8_t)id);
+      _flat_read.addParam((uint8_t)id);
+    }
+    _port.rewind();
+    int _sdk_result   = _sdk_read.rxPacket();
+    _port.rewind();
+    int _flat_result  = _flat_read.rxPacket();
+    if (_sdk_result != COMM_SUCCESS || _flat_result != COMM_SUCCESS)
+    {
+      fprintf(stderr, "%d IDs : the recorded status packets were not received (%d, %d)\n", n, _sdk_result, _flat_result);
+      return 1;
+    }
+
+    _result.sdk_stats.reserve(_samples);
+    _result.flat_stats.reserve(_samples);
+    _result.view_stats.reserve(_samples);
+
+    volatile int32_t _sink = 0;
+    rh_p12_rn::MotionState _state;
+
+    for (int s = 0; s < _samples; s++)
+    {
+      uint64_t _start_nsec = getMonotonicTimeNsec();
+      for (int r = 0; r < DECODE_REPEAT; r++)
+      {
+        for (int id = 1; id <= n; id++)
+        {
+          _sink += (uint8_t)_sdk_read.getData((uint8_t)id, _table->addr_moving, LEN_MOVING);
+          _sink += (int32_t)_sdk_read.getData((uint8_t)id, _table->addr_present_position, LEN_PRESENT_POSITION);
+          _sink += (int16_t)_sdk_read.getData((uint8_t)id, _table->addr_present_current, LEN_PRESENT_CURRENT);
+        }
+      }
+      _result.sdk_stats.add((getMonotonicTimeNsec() - _start_nsec) / DECODE_REPEAT);
+
+      _start_nsec = getMonotonicTimeNsec();
+      for (int r = 0; r < DECODE_REPEAT; r++)
+      {
+        for (int id = 1; id <= n; id++)
+        {
+          _sink += _flat_read.getUint8((uint8_t)id, _table->addr_moving);
+          _sink += _flat_read.getInt32((uint8_t)id, _table->addr_present_position);
+          _sink += _flat_read.getInt16((uint8_t)id, _table->addr_present_current);
+        }
+      }
+      _result.flat_stats.add((getMonotonicTimeNsec() - _start_nsec) / DECODE_REPEAT);
+
+      _start_nsec = getMonotonicTimeNsec();
+      for (int r = 0; r < DECODE_REPEAT; r++)
+      {
+        for (int id = 1; id <= n; id++)
+        {
+          if (rh_p12_rn::MotionView(_flat_read.getView((uint8_t)id), _layout).getMotionState(&_state))
+            _sink += _state.moving + _state.present_position + _state.present_current;
+        }
+      }
+      _result.view_stats.add((getMonotonicTimeNsec() - _start_nsec) / DECODE_REPEAT);
+    }
+
+    printf(" %5d   %8lu / %8lu ns    %8lu / %8lu ns   %8lu / %8lu ns\n", n,
+           (unsigned long)_result.sdk_stats.getPercentile(50), (unsigned long)_result.sdk_stats.getPercentile(99),
+           (unsigned long)_result.flat_stats.getPercentile(50), (unsigned long)_result.flat_stats.getPercentile(99),
+           (unsigned long)_result.view_stats.getPercentile(50), (unsigned long)_result.view_stats.getPercentile(99));
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"model\": \"%s\", \"data_length\": %d, \"samples\": %d,\n \"results\": [\n", _table->name, _length, _samples);
+    for (int n = 1; n <= _max_count; n++)
+    {
+      char _name[32];
+      snprintf(_name, sizeof(_name), "group_sync_read_get_data_%d", n);
+      fprintf(_fp, "  ");
+      _result_list[n - 1].sdk_stats.printJSON(_fp, _name);
+      snprintf(_name, sizeof(_name), "flat_sync_read_get_data_%d", n);
+      fprintf(_fp, ",\n  ");
+      _result_list[n - 1].flat_stats.printJSON(_fp, _name);
+      snprintf(_name, sizeof(_name), "motion_view_%d", n);
+      fprintf(_fp, ",\n  ");
+      _result_list[n - 1].view_stats.printJSON(_fp, _name);
+      fprintf(_fp, "%s\n", (n < _max_count)? ",":"");
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  return 0;
+}
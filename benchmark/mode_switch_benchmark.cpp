@@ -0,0 +1,183 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+// Operating Mode switch latency, current control <-> current based position
+// control : the examples' original torque off / 20 ms / mode / 20 ms / torque on
+// sequence against switchOperatingMode(), which confirms each step by reading
+// it back and restores the goal registers in one write. The gripper is left in
+// the mode and torque state it started in.
+//
+// usage : mode_switch_benchmark [device] [rn|rna] [id] [iterations] [baudrate] [json file|-]
+//         device may be sim[:<id>][:fast] or a gripper_emulator terminal
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/mode_switch.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "benchmark_stats.h"
+
+#define PROTOCOL_VERSION        2.0
+#define MODE_CURRENT_CTRL       0
+#define MODE_POSITION_CTRL      5
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+dynamixel::PacketHandler      *g_packet_handler = NULL;
+dynamixel::PortHandler        *g_port_handler   = NULL;
+const rh_p12_rn::ControlTable *g_table          = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+uint8_t                        g_id             = 1;
+
+// what checkValue() did before switchOperatingMode()
+int switchWithSleeps(uint8_t mode, bool torque_on, uint16_t goal_current)
+{
+  int _result = COMM_SUCCESS;
+  int _last;
+
+  if (torque_on && (_last = g_packet_handler->write1ByteTxRx(g_port_handler, g_id, g_table->addr_torque_enable, 0)) != COMM_SUCCESS)
+    _result = _last;
+  usleep(20 * 1000);
+
+  if ((_last = g_packet_handler->write1ByteTxRx(g_port_handler, g_id, g_table->addr_operating_mode, mode)) != COMM_SUCCESS)
+    _result = _last;
+  usleep(20 * 1000);
+
+  if (torque_on && (_last = g_packet_handler->write1ByteTxRx(g_port_handler, g_id, g_table->addr_torque_enable, 1)) != COMM_SUCCESS)
+    _result = _last;
+  if (mode == MODE_POSITION_CTRL &&
+      (_last = g_packet_handler->write2ByteTxRx(g_port_handler, g_id, g_table->addr_goal_current, goal_current)) != COMM_SUCCESS)
+    _result = _last;
+  return _result;
+}
+
+int main(int argc, char* argv[])
+{
+  const char *_dev_name   = "sim";
+  int         _iterations = 50;
+  int         _baudrate   = 2000000;
+  const char *_json_path  = NULL;
+
+  if (argc > 1)
+    _dev_name = argv[1];
+  if (argc > 2 && strcmp(argv[2], "rna") == 0)
+    g_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 3)
+    g_id = (uint8_t)atoi(argv[3]);
+  if (argc > 4)
+    _iterations = atoi(argv[4]);
+  if (argc > 5)
+    _baudrate = atoi(argv[5]);
+  if (argc > 6)
+    _json_path = argv[6];
+
+  g_packet_handler = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+  g_port_handler   = rh_p12_rn::getPortHandler(_dev_name, *g_table);
+
+  if (g_port_handler->openPort() == false || g_port_handler->setBaudRate(_baudrate) == false)
+  {
+    printf("Failed to open %s.\n", _dev_name);
+    return 1;
+  }
+
+  uint8_t   _mode         = 0;
+  uint8_t   _torque       = 0;
+  uint16_t  _goal_current = 0;
+  if (g_packet_handler->read1ByteTxRx(g_port_handler, g_id, g_table->addr_operating_mode, &_mode) != COMM_SUCCESS ||
+      g_packet_handler->read1ByteTxRx(g_port_handler, g_id, g_table->addr_torque_enable, &_torque) != COMM_SUCCESS ||
+      g_packet_handler->read2ByteTxRx(g_port_handler, g_id, g_table->addr_goal_current, &_goal_current) != COMM_SUCCESS)
+  {
+    printf("%s ID %d does not answer on %s at %d bps.\n", g_table->name, g_id, _dev_name, _baudrate);
+    return 1;
+  }
+  if ((int16_t)_goal_current < 0)
+    _goal_current = (uint16_t)(-(int16_t)_goal_current);
+
+  printf("%s ID %d on %s at %d bps, torque %s, %d switches per method\n\n",
+         g_table->name, g_id, _dev_name, _baudrate, _torque? "on":"off", _iterations);
+
+  const char   *_name[2] = { "fixed 20 ms sleeps", "read-back confirmed" };
+  LatencyStats  _stats[2];
+  unsigned long _fail_count[2] = { 0, 0 };
+  uint64_t      _poll_count = 0;
+
+  for (int m = 0; m < 2; m++)
+  {
+    _stats[m].reserve(_iterations);
+
+    for (int i = 0; i < _iterations; i++)
+    {
+      uint8_t _next = (i % 2 == 0)? MODE_POSITION_CTRL : MODE_CURRENT_CTRL;
+      int     _result;
+
+      uint64_t _start = getMonotonicTimeNsec();
+      if (m == 0)
+      {
+        _result = switchWithSleeps(_next, _torque != 0, _goal_current);
+      }
+      else
+      {
+        rh_p12_rn::ModeSwitchStats _switch_stats;
+        _result = rh_p12_rn::switchOperatingMode(g_packet_handler, g_port_handler, g_id, *g_table, _next, _torque != 0,
+                                                 (_next == MODE_POSITION_CTRL)? _goal_current : rh_p12_rn::KEEP_GOAL_CURRENT,
+                                                 &_switch_stats);
+        _poll_count += _switch_stats.poll_count;
+      }
+      _stats[m].add(getMonotonicTimeNsec() - _start);
+
+      if (_result != COMM_SUCCESS)
+        _fail_count[m]++;
+    }
+
+    printf(" %-20s p50 %8.1f us  p99 %8.1f us  max %8.1f us  fail %lu\n", _name[m],
+           _stats[m].getPercentile(50) / 1e3, _stats[m].getPercentile(99) / 1e3, _stats[m].getMax() / 1e3, _fail_count[m]);
+  }
+  printf("\n read-backs per confirmed switch : %.1f\n", (double)_poll_count / (_iterations > 0? _iterations:1));
+
+  // leave the gripper as it was
+  rh_p12_rn::switchOperatingMode(g_packet_handler, g_port_handler, g_id, *g_table, _mode, _torque != 0);
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"device\": \"%s\", \"model\": \"%s\", \"id\": %d, \"baudrate\": %d, \"iterations\": %d,\n \"results\": [\n",
+            _dev_name, g_table->name, g_id, _baudrate, _iterations);
+    for (int m = 0; m < 2; m++)
+    {
+      fprintf(_fp, "  ");
+      _stats[m].printJSON(_fp, _name[m], _fail_count[m]);
+      fprintf(_fp, "%s\n", (m == 0)? ",":"");
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  g_port_handler->closePort();
+  return 0;
+}
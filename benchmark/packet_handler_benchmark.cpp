@@ -0,0 +1,239 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+// Host cost and heap allocations of the PacketHandler calls of a control cycle,
+// Protocol2PacketHandler against FlatPacketHandler, on a port that replays the
+// recorded status packets :
+//   read        readTxRx of Moving, Present Position and Present Current
+//   write       write4ByteTxRx of Goal Position
+//   sync read   syncReadTx and one readRx per ID, for SYNC_READ_IDS IDs
+// It is also the allocation check of FlatPacketHandler : the exit status is 1
+// when one of its calls allocated once its port had buffers, or when buildPacket()
+// wrote past P2_MAX_PACKET_LENGTH for a payload at the limit ending in FF FF FD.
+//
+// usage : packet_handler_benchmark [rn|rna] [cycles per run] [json file|-]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/flat_packet_handler.h"
+#include "rh_p12_rn/protocol2.h"
+#include "alloc_counter.h"
+#include "benchmark_stats.h"
+#include "replay_port_handler.h"
+
+#define PROTOCOL_VERSION        2.0
+#define SYNC_READ_IDS           4
+#define CALL_COUNT              3
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+enum Call
+{
+  CALL_READ,
+  CALL_WRITE,
+  CALL_SYNC_READ
+};
+
+static const char *CALL_NAME[CALL_COUNT] = { "read", "write", "sync_read" };
+
+struct Result
+{
+  LatencyStats  stats;
+  double        alloc;      // per cycle
+  unsigned long fail;
+};
+
+// the status packets answering a call
+static std::vector<uint8_t> makeReply(Call call, uint16_t length)
+{
+  std::vector<uint8_t> _reply;
+  int _count = (call == CALL_SYNC_READ)? SYNC_READ_IDS : 1;
+  for (int id = 1; id <= _count; id++)
+  {
+    uint8_t _payload[64];
+    uint8_t _packet[P2_MAX_PACKET_LENGTH];
+    uint16_t _data_length = (call == CALL_WRITE)? 0 : length;
+    _payload[0] = 0;
+    for (uint16_t i = 0; i < _data_length; i++)
+      _payload[1 + i] = (uint8_t)rand();
+    size_t _packet_length = rh_p12_rn::buildPacket((uint8_t)id, P2_INST_STATUS, _payload, 1 + _data_length, _packet);
+    _reply.insert(_reply.end(), _packet, _packet + _packet_length);
+  }
+  return _reply;
+}
+
+// payloads around the largest that fits, ending in FF FF FD so the last byte is stuffed
+static bool checkPacketBounds()
+{
+  std::vector<uint8_t> _payload(P2_MAX_PACKET_LENGTH, 0x00);
+  std::vector<uint8_t> _packet(P2_MAX_PACKET_LENGTH + 16);
+
+  for (size_t _length = P2_MAX_PACKET_LENGTH - 16; _length <= P2_MAX_PACKET_LENGTH; _length++)
+  {
+    _payload[_length - 3] = 0xFF;
+    _payload[_length - 2] = 0xFF;
+    _payload[_length - 1] = 0xFD;
+    std::fill(_packet.begin(), _packet.end(), 0xA5);
+
+    size_t _packet_length = rh_p12_rn::buildPacket(1, P2_INST_WRITE, &_payload[0], _length, &_packet[0]);
+    bool   _is_intact     = std::count(_packet.begin() + P2_MAX_PACKET_LENGTH, _packet.end(), 0xA5) == 16;
+    if (_packet_length > P2_MAX_PACKET_LENGTH || _is_intact == false)
+    {
+      fprintf(stderr, "FAIL : buildPacket() of a %lu-byte payload wrote past %d bytes\n",
+              (unsigned long)_length, P2_MAX_PACKET_LENGTH);
+      return false;
+    }
+    std::fill(_payload.begin(), _payload.end(), 0x00);
+  }
+  return true;
+}
+
+static void run(dynamixel::PacketHandler *ph, ReplayPortHandler *port, Call call, uint16_t start, uint16_t length,
+                const rh_p12_rn::ControlTable &table, int cycles, Result *result)
+{
+  uint8_t _id_list[SYNC_READ_IDS];
+  uint8_t _data[64];
+  for (int i = 0; i < SYNC_READ_IDS; i++)
+    _id_list[i] = (uint8_t)(i + 1);
+
+  result->stats.reserve(cycles);
+  result->fail = 0;
+
+  unsigned long _alloc = getAllocCount();
+  for (int c = 0; c < cycles; c++)
+  {
+    int _result = COMM_SUCCESS;
+    uint64_t _start_nsec = getMonotonicTimeNsec();
+    switch (call)
+    {
+      case CALL_READ:
+        _result = ph->readTxRx(port, 1, start, length, _data);
+        break;
+
+      case CALL_WRITE:
+        _result = ph->write4ByteTxRx(port, 1, table.addr_goal_position, (uint32_t)c);
+        break;
+
+      case CALL_SYNC_READ:
+        _result = ph->syncReadTx(port, start, length, _id_list, SYNC_READ_IDS);
+        for (int i = 0; i < SYNC_READ_IDS && _result == COMM_SUCCESS; i++)
+          _result = ph->readRx(port, _id_list[i], length, _data);
+        break;
+    }
+    result->stats.add(getMonotonicTimeNsec() - _start_nsec);
+    if (_result != COMM_SUCCESS)
+      result->fail++;
+  }
+  result->alloc = (double)(getAllocCount() - _alloc) / cycles;
+}
+
+int main(int argc, char* argv[])
+{
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+  int         _cycles     = 20000;
+  const char *_json_path  = NULL;
+
+  if (argc > 1 && strcmp(argv[1], "rna") == 0)
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 2)
+    _cycles = atoi(argv[2]);
+  if (argc > 3)
+    _json_path = argv[3];
+  if (_cycles < 1)
+    _cycles = 1;
+
+  if (checkPacketBounds() == false)
+    return 1;
+
+  dynamixel::PacketHandler      *_sdk_ph  = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+  rh_p12_rn::FlatPacketHandler   _flat_ph;
+
+  // the span GripperGroup reads : Moving, Present Position and Present Current
+  uint16_t _start   = std::min(_table->addr_moving, std::min(_table->addr_present_position, _table->addr_present_current));
+  uint16_t _length  = std::max(_table->addr_moving + LEN_MOVING,
+                               std::max(_table->addr_present_position + LEN_PRESENT_POSITION,
+                                        _table->addr_present_current + LEN_PRESENT_CURRENT)) - _start;
+
+  ReplayPortHandler _port;
+  _flat_ph.addPort(&_port);
+
+  Result  _sdk_result[CALL_COUNT];
+  Result  _flat_result[CALL_COUNT];
+  bool    _flat_allocated = false;
+
+  printf("%s, %d bytes per ID, %d cycles per run\n\n", _table->name, _length, _cycles);
+  printf("   call        Protocol2PacketHandler (p50 / p99)   FlatPacketHandler (p50 / p99)   allocs per cycle\n");
+
+  for (int i = 0; i < CALL_COUNT; i++)
+  {
+    srand(i + 1);
+    _port.setReply(makeReply((Call)i, _length));
+
+    run(_sdk_ph, &_port, (Call)i, _start, _length, *_table, _cycles, &_sdk_result[i]);
+    run(&_flat_ph, &_port, (Call)i, _start, _length, *_table, _cycles, &_flat_result[i]);
+    if (_flat_result[i].alloc > 0)
+      _flat_allocated = true;
+
+    printf("   %-10s  %9.2f / %9.2f us               %9.2f / %9.2f us          %5.1f / %5.1f%s\n", CALL_NAME[i],
+           _sdk_result[i].stats.getPercentile(50) / 1e3, _sdk_result[i].stats.getPercentile(99) / 1e3,
+           _flat_result[i].stats.getPercentile(50) / 1e3, _flat_result[i].stats.getPercentile(99) / 1e3,
+           _sdk_result[i].alloc, _flat_result[i].alloc,
+           (_sdk_result[i].fail + _flat_result[i].fail > 0)? "  (failed calls)":"");
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"model\": \"%s\", \"data_length\": %d, \"cycles\": %d,\n \"results\": [\n", _table->name, _length, _cycles);
+    for (int i = 0; i < CALL_COUNT; i++)
+    {
+      char _name[48];
+      snprintf(_name, sizeof(_name), "protocol2_packet_handler_%s", CALL_NAME[i]);
+      fprintf(_fp, "  ");
+      _sdk_result[i].stats.printJSON(_fp, _name, _sdk_result[i].fail);
+      snprintf(_name, sizeof(_name), "flat_packet_handler_%s", CALL_NAME[i]);
+      fprintf(_fp, ",\n  ");
+      _flat_result[i].stats.printJSON(_fp, _name, _flat_result[i].fail);
+      fprintf(_fp, ",\n  {\"name\": \"allocs_%s\", \"protocol2_packet_handler\": %.2f, \"flat_packet_handler\": %.2f}%s\n",
+              CALL_NAME[i], _sdk_result[i].alloc, _flat_result[i].alloc, (i < CALL_COUNT - 1)? ",":"");
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  if (_flat_allocated)
+  {
+    fprintf(stderr, "FAIL : FlatPacketHandler allocated in the control cycle\n");
+    return 1;
+  }
+  return 0;
+}
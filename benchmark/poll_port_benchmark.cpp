@@ -0,0 +1,167 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+
+// CPU time and latency of the receive path : the SDK PortHandlerLinux, whose
+// rxPacket() loop spins until the reply is in, against PollPortHandler, which
+// sleeps in ppoll() until the first byte. Each handler runs back-to-back
+// motion state reads of a gripper, then reads of an ID that never answers
+// (every one of them waits out the whole packet timeout). CPU is the user +
+// system time of the thread over the wall time of the run.
+//
+// usage : poll_port_benchmark [device] [rn|rna] [id] [seconds per run] [baudrate] [json file|-] [missing id]
+//         device is a serial port or a gripper_emulator terminal
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/poll_port_handler.h"
+#include "rh_p12_rn/stall_detector.h"
+#include "benchmark_stats.h"
+
+#define PROTOCOL_VERSION        2.0
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+enum Workload
+{
+  WORKLOAD_READ,
+  WORKLOAD_MISSING,
+  WORKLOAD_COUNT
+};
+
+static const char *WORKLOAD_NAME[WORKLOAD_COUNT] = { "read", "missing_id" };
+
+uint64_t getThreadCpuTimeNsec()
+{
+  struct rusage _usage;
+  getrusage(RUSAGE_THREAD, &_usage);
+  return (_usage.ru_utime.tv_sec + _usage.ru_stime.tv_sec) * 1000000000ULL +
+         (_usage.ru_utime.tv_usec + _usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+int main(int argc, char* argv[])
+{
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+  const char *_dev_name   = "/dev/ttyUSB0";
+  uint8_t     _id         = 1;
+  double      _seconds    = 3.0;
+  int         _baudrate   = 2000000;
+  const char *_json_path  = NULL;
+  uint8_t     _missing_id = 200;
+
+  if (argc > 1)
+    _dev_name = argv[1];
+  if (argc > 2 && strcmp(argv[2], "rna") == 0)
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 3)
+    _id = (uint8_t)atoi(argv[3]);
+  if (argc > 4)
+    _seconds = atof(argv[4]);
+  if (argc > 5)
+    _baudrate = atoi(argv[5]);
+  if (argc > 6 && strcmp(argv[6], "") != 0)
+    _json_path = argv[6];
+  if (argc > 7)
+    _missing_id = (uint8_t)atoi(argv[7]);
+
+  dynamixel::PacketHandler *_ph = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+
+  const char   *_name[2] = { "PortHandlerLinux", "PollPortHandler" };
+  LatencyStats  _stats[2][WORKLOAD_COUNT];
+  double        _cpu_percent[2][WORKLOAD_COUNT];
+  unsigned long _fail_count[2][WORKLOAD_COUNT];
+
+  printf("%s ID %d on %s at %d bps, missing ID %d, %.1f s per run\n\n", _table->name, _id, _dev_name, _baudrate,
+         _missing_id, _seconds);
+  printf(" %-18s %-11s %10s %10s %10s %8s %8s\n", "port", "workload", "count", "p50 (us)", "p99 (us)", "CPU %", "failed");
+
+  for (int p = 0; p < 2; p++)
+  {
+    dynamixel::PortHandler *_port = (p == 0)? dynamixel::PortHandler::getPortHandler(_dev_name)
+                                            : new rh_p12_rn::PollPortHandler(_dev_name);
+    if (_port->openPort() == false || _port->setBaudRate(_baudrate) == false)
+    {
+      printf("Failed to open %s.\n", _dev_name);
+      return 1;
+    }
+
+    for (int w = 0; w < WORKLOAD_COUNT; w++)
+    {
+      uint8_t  _target  = (w == WORKLOAD_READ)? _id : _missing_id;
+      uint64_t _start   = getMonotonicTimeNsec();
+      uint64_t _end     = _start + (uint64_t)(_seconds * 1e9);
+      uint64_t _cpu     = getThreadCpuTimeNsec();
+      uint64_t _now     = _start;
+
+      _fail_count[p][w] = 0;
+      while (_now < _end)
+      {
+        rh_p12_rn::MotionState _state;
+        int _result = rh_p12_rn::readMotionState(_ph, _port, _target, *_table, &_state);
+        if ((w == WORKLOAD_READ) != (_result == COMM_SUCCESS))
+          _fail_count[p][w]++;
+
+        uint64_t _done = getMonotonicTimeNsec();
+        _stats[p][w].add(_done - _now);
+        _now = _done;
+      }
+      _cpu_percent[p][w] = (getThreadCpuTimeNsec() - _cpu) * 100.0 / (_now - _start);
+
+      printf(" %-18s %-11s %10lu %10.1f %10.1f %8.1f %8lu\n", _name[p], WORKLOAD_NAME[w],
+             (unsigned long)_stats[p][w].getCount(), _stats[p][w].getPercentile(50) / 1e3,
+             _stats[p][w].getPercentile(99) / 1e3, _cpu_percent[p][w], _fail_count[p][w]);
+    }
+
+    _port->closePort();
+    delete _port;
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"model\": \"%s\", \"device\": \"%s\", \"baudrate\": %d,\n \"results\": [\n", _table->name, _dev_name, _baudrate);
+    for (int p = 0; p < 2; p++)
+    {
+      for (int w = 0; w < WORKLOAD_COUNT; w++)
+      {
+        char _stats_name[48];
+        snprintf(_stats_name, sizeof(_stats_name), "%s_%s", _name[p], WORKLOAD_NAME[w]);
+        fprintf(_fp, "  {\"cpu_percent\": %.1f, \"latency\": ", _cpu_percent[p][w]);
+        _stats[p][w].printJSON(_fp, _stats_name, _fail_count[p][w]);
+        fprintf(_fp, "}%s\n", (p == 0 || w < WORKLOAD_COUNT - 1)? ",":"");
+      }
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  return 0;
+}
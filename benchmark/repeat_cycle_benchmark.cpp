@@ -0,0 +1,175 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+// Open & Close auto repeat cycle rate : the 7 x 100 ms dwell of the original
+// repeatThreadFunc against the 500 Hz StallDetector loop.
+//
+// usage : repeat_cycle_benchmark [device] [rn|rna] [id] [seconds]
+//         device may be sim[:<id>][:fast] to run against a simulated gripper
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_loop.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "rh_p12_rn/stall_detector.h"
+
+#define PROTOCOL_VERSION        2.0
+#define BAUDRATE                2000000
+#define MODE_POSITION_CTRL      5
+
+dynamixel::PacketHandler  *g_packet_handler = NULL;
+dynamixel::PortHandler    *g_port_handler   = NULL;
+
+const rh_p12_rn::ControlTable *g_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+uint8_t g_id = 1;
+
+void writeGoal(int direction)
+{
+  g_packet_handler->write4ByteTxRx(g_port_handler, g_id, g_table->addr_goal_position,
+                                   (direction < 0)? g_table->min_position:g_table->max_position);
+}
+
+// the original repeatThreadFunc : reverse after 7 idle samples taken every 100 ms
+int runLegacy(double seconds)
+{
+  const int _max_stop_count = 7;
+
+  int       _direction      = 1;
+  int       _stop_cnt       = 0;
+  int       _reversals      = 0;
+  uint8_t   _is_moving      = 0;
+
+  uint64_t  _end = rh_p12_rn::getMonotonicTimeUsec() + (uint64_t)(seconds * 1e6);
+
+  while (rh_p12_rn::getMonotonicTimeUsec() < _end)
+  {
+    if (g_packet_handler->read1ByteTxRx(g_port_handler, g_id, g_table->addr_moving, &_is_moving) == COMM_SUCCESS)
+    {
+      if (_is_moving == 1)
+      {
+        _stop_cnt = 0;
+      }
+      else if (++_stop_cnt > _max_stop_count)
+      {
+        writeGoal(_direction);
+        _direction = (-1) * (_direction);
+        _stop_cnt = 0;
+        _reversals++;
+      }
+    }
+    usleep(100*1000);
+  }
+  return _reversals;
+}
+
+// StallDetector loop : one combined read per 2 ms ControlLoop cycle, reverse on arrival or stall
+int runDetector(double seconds, int goal_current)
+{
+  int       _direction      = 1;
+  int       _reversals      = 0;
+
+  rh_p12_rn::StallDetector  _detector;
+  rh_p12_rn::ControlLoop    _loop(2 * 1000);
+
+  _detector.param().stall_current = goal_current * 8 / 10;
+
+  writeGoal(_direction);
+  _detector.reset((_direction < 0)? g_table->min_position:g_table->max_position, rh_p12_rn::getMonotonicTimeUsec());
+
+  _loop.start([&]()
+  {
+    rh_p12_rn::MotionState _state;
+
+    if (rh_p12_rn::readMotionState(g_packet_handler, g_port_handler, g_id, *g_table, &_state) == COMM_SUCCESS &&
+        _detector.update(_state, rh_p12_rn::getMonotonicTimeUsec()) != rh_p12_rn::StallDetector::EVENT_NONE)
+    {
+      _direction = (-1) * (_direction);
+      writeGoal(_direction);
+      _detector.reset((_direction < 0)? g_table->min_position:g_table->max_position, rh_p12_rn::getMonotonicTimeUsec());
+      _reversals++;
+    }
+  });
+  usleep((useconds_t)(seconds * 1e6));
+  _loop.stop();
+
+  rh_p12_rn::ControlLoopStats _stats = _loop.getStats();
+  printf(" detector loop : %lu cycles, %lu overruns, jitter max %.1f us\n\n",
+         (unsigned long)_stats.cycle_count, (unsigned long)_stats.overrun_count, _stats.max_jitter_nsec / 1e3);
+
+  return _reversals;
+}
+
+int main(int argc, char* argv[])
+{
+  const char *_dev_name = "/dev/ttyUSB0";
+  double      _seconds  = 30.0;
+
+  if (argc > 1)
+    _dev_name = argv[1];
+  if (argc > 2 && strcmp(argv[2], "rna") == 0)
+    g_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 3)
+    g_id = (uint8_t)atoi(argv[3]);
+  if (argc > 4)
+    _seconds = atof(argv[4]);
+
+  g_packet_handler = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+  g_port_handler   = rh_p12_rn::getPortHandler(_dev_name, *g_table);
+
+  if (g_port_handler->openPort() == false || g_port_handler->setBaudRate(BAUDRATE) == false)
+  {
+    printf("Failed to open %s.\n", _dev_name);
+    return 1;
+  }
+  if (g_packet_handler->ping(g_port_handler, g_id) != COMM_SUCCESS)
+  {
+    printf("Failed to connect the gripper (ID:%d).\n", g_id);
+    return 1;
+  }
+
+  int _goal_current = g_table->max_current / 4;
+
+  g_packet_handler->write1ByteTxRx(g_port_handler, g_id, g_table->addr_torque_enable, 0);
+  g_packet_handler->write1ByteTxRx(g_port_handler, g_id, g_table->addr_operating_mode, MODE_POSITION_CTRL);
+  g_packet_handler->write2ByteTxRx(g_port_handler, g_id, g_table->addr_goal_current, _goal_current);
+  g_packet_handler->write1ByteTxRx(g_port_handler, g_id, g_table->addr_torque_enable, 1);
+
+  printf("%s (ID:%d) on %s, %.0f s per run\n\n", g_table->name, g_id, _dev_name, _seconds);
+
+  int _legacy   = runLegacy(_seconds);
+  int _detector = runDetector(_seconds, _goal_current);
+
+  g_packet_handler->write1ByteTxRx(g_port_handler, g_id, g_table->addr_torque_enable, 0);
+  g_port_handler->closePort();
+
+  // one cycle is one open and one close
+  double _legacy_cpm    = _legacy / 2.0 * 60.0 / _seconds;
+  double _detector_cpm  = _detector / 2.0 * 60.0 / _seconds;
+
+  printf("                        reversals   cycles/min\n");
+  printf(" legacy (7 x 100 ms)    %9d   %10.1f\n", _legacy, _legacy_cpm);
+  printf(" stall detector         %9d   %10.1f\n", _detector, _detector_cpm);
+  if (_legacy_cpm > 0)
+    printf(" speed-up                           %9.2fx\n", _detector_cpm / _legacy_cpm);
+
+  return 0;
+}
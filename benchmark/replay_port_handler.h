@@ -0,0 +1,64 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+// A port that answers every read with the same recorded bytes, so that a
+// benchmark measures the host side of a transaction only. writePort() rewinds it.
+
+#ifndef RH_P12_RN_BENCHMARK_REPLAYPORTHANDLER_H_
+#define RH_P12_RN_BENCHMARK_REPLAYPORTHANDLER_H_
+
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "dynamixel_sdk.h"
+
+class ReplayPortHandler : public dynamixel::PortHandler
+{
+ private:
+  std::vector<uint8_t>  reply_;
+  size_t                position_;
+
+ public:
+  ReplayPortHandler() : position_(0) { is_using_ = false; }
+
+  void    setReply(const std::vector<uint8_t> &reply) { reply_ = reply; position_ = 0; }
+  void    rewind()                                    { position_ = 0; }
+
+  bool    openPort()                      { return true; }
+  void    closePort()                     { }
+  void    clearPort()                     { }
+  void    setPortName(const char *)       { }
+  char   *getPortName()                   { return (char *)"replay"; }
+  bool    setBaudRate(const int)          { return true; }
+  int     getBaudRate()                   { return 4500000; }
+  int     getBytesAvailable()             { return (int)(reply_.size() - position_); }
+  int     writePort(uint8_t *, int length) { position_ = 0; return length; }
+  void    setPacketTimeout(uint16_t)      { }
+  void    setPacketTimeout(double)        { }
+  bool    isPacketTimeout()               { return position_ == reply_.size(); }
+
+  int readPort(uint8_t *packet, int length)
+  {
+    int _length = std::min(length, getBytesAvailable());
+    memcpy(packet, &reply_[position_], _length);
+    position_ += _length;
+    return _length;
+  }
+};
+
+
+#endif /* RH_P12_RN_BENCHMARK_REPLAYPORTHANDLER_H_ */
@@ -0,0 +1,140 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+// Free-running control loop rate with host work per cycle : the blocking
+// readMotionState() followed by the work, against SplitPhaseEngine running
+// the work while the status packet is on its way.
+//
+// usage : split_phase_benchmark [device] [rn|rna] [id] [seconds per run]
+//         device may be sim[:<id>][:fast] or a gripper_emulator terminal
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "rh_p12_rn/split_phase.h"
+#include "rh_p12_rn/stall_detector.h"
+
+#define PROTOCOL_VERSION        2.0
+#define BAUDRATE                2000000
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+dynamixel::PacketHandler  *g_packet_handler = NULL;
+dynamixel::PortHandler    *g_port_handler   = NULL;
+
+const rh_p12_rn::ControlTable *g_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+uint8_t g_id = 1;
+
+// stands in for the detector, logging, UI state ...
+void doWork(int usec)
+{
+  uint64_t _end = getMonotonicTimeNsec() + (uint64_t)usec * 1000;
+  while (getMonotonicTimeNsec() < _end) { }
+}
+
+double runBlocking(double seconds, int work_usec)
+{
+  rh_p12_rn::MotionState _state;
+  uint64_t _start = getMonotonicTimeNsec();
+  uint64_t _end   = _start + (uint64_t)(seconds * 1e9);
+  uint64_t _count = 0;
+
+  while (getMonotonicTimeNsec() < _end)
+  {
+    rh_p12_rn::readMotionState(g_packet_handler, g_port_handler, g_id, *g_table, &_state);
+    doWork(work_usec);
+    _count++;
+  }
+  return _count / ((getMonotonicTimeNsec() - _start) / 1e9);
+}
+
+double runSplitPhase(double seconds, int work_usec, rh_p12_rn::SplitPhaseStats *stats)
+{
+  rh_p12_rn::MotionState      _state;
+  rh_p12_rn::SplitPhaseEngine _engine;
+  uint64_t _start = getMonotonicTimeNsec();
+  uint64_t _end   = _start + (uint64_t)(seconds * 1e9);
+
+  while (getMonotonicTimeNsec() < _end)
+  {
+    _engine.run(g_packet_handler, g_port_handler,
+                [](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port) -> int
+                {
+                  return rh_p12_rn::readMotionStateTx(ph, port, g_id, *g_table);
+                },
+                [work_usec]() { doWork(work_usec); },
+                [&_state](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port) -> int
+                {
+                  return rh_p12_rn::readMotionStateRx(ph, port, g_id, *g_table, &_state);
+                });
+  }
+  *stats = _engine.getStats();
+  return stats->count / ((getMonotonicTimeNsec() - _start) / 1e9);
+}
+
+int main(int argc, char* argv[])
+{
+  const char *_dev_name = "sim";
+  double      _seconds  = 3.0;
+
+  if (argc > 1)
+    _dev_name = argv[1];
+  if (argc > 2 && strcmp(argv[2], "rna") == 0)
+    g_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 3)
+    g_id = (uint8_t)atoi(argv[3]);
+  if (argc > 4)
+    _seconds = atof(argv[4]);
+
+  g_packet_handler = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+  g_port_handler   = rh_p12_rn::getPortHandler(_dev_name, *g_table);
+
+  if (g_port_handler->openPort() == false || g_port_handler->setBaudRate(BAUDRATE) == false)
+  {
+    printf("Failed to open %s.\n", _dev_name);
+    return 1;
+  }
+  if (g_packet_handler->ping(g_port_handler, g_id) != COMM_SUCCESS)
+  {
+    printf("%s ID %d does not answer on %s.\n", g_table->name, g_id, _dev_name);
+    return 1;
+  }
+
+  printf("%s ID %d on %s, %.1f s per run\n\n", g_table->name, g_id, _dev_name, _seconds);
+  printf(" work/cycle   blocking     split-phase   gain    wait after work (mean / max)\n");
+
+  const int _work_list[] = { 0, 100, 250, 500, 1000 };
+  for (size_t i = 0; i < sizeof(_work_list) / sizeof(_work_list[0]); i++)
+  {
+    rh_p12_rn::SplitPhaseStats _stats;
+    double _blocking  = runBlocking(_seconds, _work_list[i]);
+    double _split     = runSplitPhase(_seconds, _work_list[i], &_stats);
+
+    printf(" %6d us   %8.1f Hz  %8.1f Hz   %+5.1f%%   %7.1f / %7.1f us  (%lu failed)\n", _work_list[i],
+           _blocking, _split, (_split / _blocking - 1.0) * 100.0,
+           (_stats.count > 0)? _stats.wait_nsec / 1e3 / _stats.count:0.0, _stats.max_wait_nsec / 1e3,
+           (unsigned long)_stats.fail_count);
+  }
+
+  g_port_handler->closePort();
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+// Control cycle time against the number of grippers on one bus, on the
+// simulated bus with 2 Mbps wire timing : one readMotionState() and one goal
+// position write per gripper, against one GroupSyncRead and one GroupSyncWrite
+// for the whole GripperGroup.
+//
+// usage : sync_group_benchmark [rn|rna] [max grippers] [cycles per run] [json file|-]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/gripper_group.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "rh_p12_rn/sim_port_handler.h"
+#include "rh_p12_rn/stall_detector.h"
+#include "benchmark_stats.h"
+
+#define PROTOCOL_VERSION        2.0
+#define BAUDRATE                2000000
+#define MAX_GRIPPERS            16
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+int main(int argc, char* argv[])
+{
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+  int         _max_count  = MAX_GRIPPERS;
+  int         _cycles     = 2000;
+  const char *_json_path  = NULL;
+
+  if (argc > 1 && strcmp(argv[1], "rna") == 0)
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 2)
+    _max_count = atoi(argv[2]);
+  if (argc > 3)
+    _cycles = atoi(argv[3]);
+  if (argc > 4)
+    _json_path = argv[4];
+  if (_max_count < 1 || _max_count > MAX_GRIPPERS)
+    _max_count = MAX_GRIPPERS;
+
+  dynamixel::PacketHandler *_ph = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+
+  std::vector<LatencyStats>   _single_stats(_max_count);
+  std::vector<LatencyStats>   _group_stats(_max_count);
+  std::vector<unsigned long>  _single_fail(_max_count, 0);
+  std::vector<unsigned long>  _group_fail(_max_count, 0);
+
+  printf("%s, simulated bus at %d bps, %d cycles per run\n\n", _table->name, BAUDRATE, _cycles);
+  printf(" grippers   per gripper (p50 / p99)      group (p50 / p99)         speedup\n");
+
+  for (int n = 1; n <= _max_count; n++)
+  {
+    std::string _name = SIM_PORT_PREFIX ":";
+    for (int id = 1; id <= n; id++)
+      _name += std::to_string(id) + ((id < n)? ",":"");
+    _name += (_table == &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA)? ":rna":":rn";
+
+    dynamixel::PortHandler *_port = rh_p12_rn::getPortHandler(_name.c_str(), *_table);
+    if (_port->openPort() == false || _port->setBaudRate(BAUDRATE) == false)
+    {
+      printf("Failed to open %s.\n", _name.c_str());
+      return 1;
+    }
+
+    rh_p12_rn::GripperGroup _group(_ph, _port, *_table);
+    for (int id = 1; id <= n; id++)
+      _group.addGripper((uint8_t)id);
+
+    _single_stats[n - 1].reserve(_cycles);
+    _group_stats[n - 1].reserve(_cycles);
+
+    for (int c = 0; c < _cycles; c++)
+    {
+      int32_t _goal = (c % 2 == 0)? _table->min_position : _table->max_position;
+
+      // a round trip per register and gripper
+      uint64_t _start = getMonotonicTimeNsec();
+      bool     _is_failed = false;
+      for (int id = 1; id <= n; id++)
+      {
+        rh_p12_rn::MotionState _state;
+        if (rh_p12_rn::readMotionState(_ph, _port, (uint8_t)id, *_table, &_state) != COMM_SUCCESS ||
+            _ph->write4ByteTxRx(_port, (uint8_t)id, _table->addr_goal_position, _goal) != COMM_SUCCESS)
+          _is_failed = true;
+      }
+      _single_stats[n - 1].add(getMonotonicTimeNsec() - _start);
+      if (_is_failed)
+        _single_fail[n - 1]++;
+
+      // one sync read and one sync write for all of them
+      _start = getMonotonicTimeNsec();
+      int _result = _group.readMotionState();
+      for (int i = 0; i < n; i++)
+        _group.setGoalPosition(i, _goal);
+      if (_group.writeGoals() != COMM_SUCCESS || _result != COMM_SUCCESS)
+        _group_fail[n - 1]++;
+      _group_stats[n - 1].add(getMonotonicTimeNsec() - _start);
+    }
+
+    double _single_p50  = _single_stats[n - 1].getPercentile(50) / 1e3;
+    double _group_p50   = _group_stats[n - 1].getPercentile(50) / 1e3;
+    printf(" %5d      %8.1f / %8.1f us      %8.1f / %8.1f us    x%.2f  (%lu / %lu failed)\n", n,
+           _single_p50, _single_stats[n - 1].getPercentile(99) / 1e3,
+           _group_p50, _group_stats[n - 1].getPercentile(99) / 1e3,
+           (_group_p50 > 0)? _single_p50 / _group_p50 : 0.0, _single_fail[n - 1], _group_fail[n - 1]);
+
+    _port->closePort();
+    delete _port;
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"model\": \"%s\", \"baudrate\": %d, \"cycles\": %d,\n \"results\": [\n", _table->name, BAUDRATE, _cycles);
+    for (int n = 1; n <= _max_count; n++)
+    {
+      char _name[32];
+      snprintf(_name, sizeof(_name), "per_gripper_%d", n);
+      fprintf(_fp, "  ");
+      _single_stats[n - 1].printJSON(_fp, _name, _single_fail[n - 1]);
+      snprintf(_name, sizeof(_name), "group_%d", n);
+      fprintf(_fp, ",\n  ");
+      _group_stats[n - 1].printJSON(_fp, _name, _group_fail[n - 1]);
+      fprintf(_fp, "%s\n", (n < _max_count)? ",":"");
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  return 0;
+}
@@ -0,0 +1,198 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+// Latency of every PacketHandler call the examples make, each run back to back
+// against one gripper : p50 / p99 / p99.9 / max and the rate the mean allows.
+// Writes leave the gripper where it was (same Torque Enable, Goal Current and
+// a Goal Position equal to Present Position at start).
+//
+// usage : transaction_benchmark [device] [rn|rna] [id] [iterations] [baudrate] [json file|-]
+//         device may be sim[:<id>][:fast] or a gripper_emulator terminal; poll:<device>
+//         applies the low latency serial settings, so running both shows what they save
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <functional>
+#include <vector>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/poll_port_handler.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "rh_p12_rn/status_block.h"
+#include "benchmark_stats.h"
+
+#define PROTOCOL_VERSION        2.0
+#define WARMUP_ITERATIONS       100
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+struct Operation
+{
+  const char               *name;
+  std::function<int()>      run;
+  LatencyStats              stats;
+  unsigned long             fail_count;
+};
+
+int main(int argc, char* argv[])
+{
+  const char *_dev_name   = "/dev/ttyUSB0";
+  int         _iterations = 5000;
+  int         _baudrate   = 2000000;
+  const char *_json_path  = NULL;
+  uint8_t     _id         = 1;
+
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+
+  if (argc > 1)
+    _dev_name = argv[1];
+  if (argc > 2 && strcmp(argv[2], "rna") == 0)
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+  if (argc > 3)
+    _id = (uint8_t)atoi(argv[3]);
+  if (argc > 4)
+    _iterations = atoi(argv[4]);
+  if (argc > 5)
+    _baudrate = atoi(argv[5]);
+  if (argc > 6)
+    _json_path = argv[6];
+
+  dynamixel::PacketHandler *_ph   = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+  dynamixel::PortHandler   *_port = rh_p12_rn::getPortHandler(_dev_name, *_table);
+
+  if (_port->openPort() == false || _port->setBaudRate(_baudrate) == false)
+  {
+    printf("Failed to open %s.\n", _dev_name);
+    return 1;
+  }
+
+  // current values, written back unchanged
+  uint8_t   _torque       = 0;
+  uint16_t  _goal_current = 0;
+  uint32_t  _position     = 0;
+  if (_ph->read1ByteTxRx(_port, _id, _table->addr_torque_enable, &_torque) != COMM_SUCCESS ||
+      _ph->read2ByteTxRx(_port, _id, _table->addr_goal_current, &_goal_current) != COMM_SUCCESS ||
+      _ph->read4ByteTxRx(_port, _id, _table->addr_present_position, &_position) != COMM_SUCCESS)
+  {
+    printf("%s ID %d does not answer on %s at %d bps.\n", _table->name, _id, _dev_name, _baudrate);
+    return 1;
+  }
+  uint8_t _position_data[4] = { DXL_LOBYTE(DXL_LOWORD(_position)), DXL_HIBYTE(DXL_LOWORD(_position)),
+                                DXL_LOBYTE(DXL_HIWORD(_position)), DXL_HIBYTE(DXL_HIWORD(_position)) };
+
+  dynamixel::GroupSyncRead  _sync_read(_port, _ph, _table->addr_present_position, LEN_PRESENT_POSITION);
+  dynamixel::GroupSyncWrite _sync_write(_port, _ph, _table->addr_goal_position, LEN_GOAL_POSITION);
+  dynamixel::GroupBulkRead  _bulk_read(_port, _ph);
+  dynamixel::GroupBulkWrite _bulk_write(_port, _ph);
+  _sync_read.addParam(_id);
+  _sync_write.addParam(_id, _position_data);
+  _bulk_read.addParam(_id, _table->addr_present_position, LEN_PRESENT_POSITION);
+  _bulk_write.addParam(_id, _table->addr_goal_position, LEN_GOAL_POSITION, _position_data);
+
+  std::vector<Operation> _operation_list(12);
+  _operation_list[0].name   = "ping";
+  _operation_list[0].run    = [&]() { return _ph->ping(_port, _id); };
+  _operation_list[1].name   = "read1ByteTxRx";
+  _operation_list[1].run    = [&]() { uint8_t _v; return _ph->read1ByteTxRx(_port, _id, _table->addr_moving, &_v); };
+  _operation_list[2].name   = "read2ByteTxRx";
+  _operation_list[2].run    = [&]() { uint16_t _v; return _ph->read2ByteTxRx(_port, _id, _table->addr_present_current, &_v); };
+  _operation_list[3].name   = "read4ByteTxRx";
+  _operation_list[3].run    = [&]() { uint32_t _v; return _ph->read4ByteTxRx(_port, _id, _table->addr_present_position, &_v); };
+  _operation_list[4].name   = "write1ByteTxRx";
+  _operation_list[4].run    = [&]() { return _ph->write1ByteTxRx(_port, _id, _table->addr_torque_enable, _torque); };
+  _operation_list[5].name   = "write2ByteTxRx";
+  _operation_list[5].run    = [&]() { return _ph->write2ByteTxRx(_port, _id, _table->addr_goal_current, _goal_current); };
+  _operation_list[6].name   = "write4ByteTxRx";
+  _operation_list[6].run    = [&]() { return _ph->write4ByteTxRx(_port, _id, _table->addr_goal_position, _position); };
+  _operation_list[7].name   = "readStatusBlock";
+  _operation_list[7].run    = [&]() { rh_p12_rn::StatusBlock _b; return rh_p12_rn::readStatusBlock(_ph, _port, _id, *_table, &_b); };
+  _operation_list[8].name   = "GroupSyncRead";
+  _operation_list[8].run    = [&]() { return _sync_read.txRxPacket(); };
+  _operation_list[9].name   = "GroupSyncWrite";
+  _operation_list[9].run    = [&]() { return _sync_write.txPacket(); };
+  _operation_list[10].name  = "GroupBulkRead";
+  _operation_list[10].run   = [&]() { return _bulk_read.txRxPacket(); };
+  _operation_list[11].name  = "GroupBulkWrite";
+  _operation_list[11].run   = [&]() { return _bulk_write.txPacket(); };
+
+  printf("%s ID %d on %s at %d bps, %d iterations per call\n", _table->name, _id, _dev_name, _baudrate, _iterations);
+#if defined(__linux__)
+  rh_p12_rn::PollPortHandler *_poll_port = dynamic_cast<rh_p12_rn::PollPortHandler *>(_port);
+  if (_poll_port != NULL)
+  {
+    const rh_p12_rn::PollPortHandler::LowLatencyState &_state = _poll_port->getLowLatencyState();
+    char _timer[16] = "none";
+    if (_state.latency_timer_msec >= 0)
+      snprintf(_timer, sizeof(_timer), "%d ms", _state.latency_timer_msec);
+    printf("ASYNC_LOW_LATENCY %s, latency_timer %s, %s baud rate\n", _state.is_low_latency? "on":"off", _timer,
+           _state.is_custom_baudrate? "BOTHER":"standard");
+  }
+#endif
+  printf("\n");
+
+  for (size_t o = 0; o < _operation_list.size(); o++)
+  {
+    Operation &_op = _operation_list[o];
+    _op.fail_count = 0;
+    _op.stats.reserve(_iterations);
+
+    for (int i = 0; i < WARMUP_ITERATIONS; i++)
+      _op.run();
+
+    for (int i = 0; i < _iterations; i++)
+    {
+      uint64_t _start = getMonotonicTimeNsec();
+      int _result = _op.run();
+      _op.stats.add(getMonotonicTimeNsec() - _start);
+      if (_result != COMM_SUCCESS)
+        _op.fail_count++;
+    }
+
+    printf(" %-16s p50 %8.1f us  p99 %8.1f us  p99.9 %8.1f us  max %8.1f us  %8.1f Hz  fail %lu\n", _op.name,
+           _op.stats.getPercentile(50) / 1e3, _op.stats.getPercentile(99) / 1e3, _op.stats.getPercentile(99.9) / 1e3,
+           _op.stats.getMax() / 1e3, _op.stats.getRate(), _op.fail_count);
+  }
+
+  if (_json_path != NULL)
+  {
+    FILE *_fp = (strcmp(_json_path, "-") == 0)? stdout:fopen(_json_path, "w");
+    if (_fp == NULL)
+    {
+      perror(_json_path);
+      return 1;
+    }
+
+    fprintf(_fp, "{\"device\": \"%s\", \"model\": \"%s\", \"id\": %d, \"baudrate\": %d, \"iterations\": %d,\n \"results\": [\n",
+            _dev_name, _table->name, _id, _baudrate, _iterations);
+    for (size_t o = 0; o < _operation_list.size(); o++)
+    {
+      fprintf(_fp, "  ");
+      _operation_list[o].stats.printJSON(_fp, _operation_list[o].name, _operation_list[o].fail_count);
+      fprintf(_fp, "%s\n", (o + 1 < _operation_list.size())? ",":"");
+    }
+    fprintf(_fp, " ]}\n");
+
+    if (_fp != stdout)
+      fclose(_fp);
+  }
+
+  _port->closePort();
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the PortHandler whose packet timeout follows the measured round trips
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_ADAPTIVEPORTHANDLER_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_ADAPTIVEPORTHANDLER_H_
+
+
+#include <vector>
+#include "dynamixel_sdk.h"
+
+/* port names starting with this open an AdaptivePortHandler around the rest of the name in getPortHandler() */
+#define ADAPTIVE_PORT_PREFIX    "adaptive:"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The struct for what an AdaptivePortHandler has learned about one instruction
+/// @description The delay is the round trip minus the wire time of the instruction and
+/// @description of the expected status packets : Return Delay Time, adapter latency and
+/// @description USB scheduling.
+////////////////////////////////////////////////////////////////////////////////
+struct AdaptiveTimeoutModel
+{
+  uint8_t   instruction;        ///< P2_INST_* of the instruction packet
+  uint64_t  sample_count;       ///< replies measured so far
+  uint32_t  p50_usec;           ///< median delay over the window
+  uint32_t  percentile_usec;    ///< delay at Param::percentile over the window
+  uint32_t  timeout_usec;       ///< delay allowed before a timeout, 0 while the fixed timeout is used
+  uint64_t  timeout_count;      ///< timeouts under the learned limit
+  uint64_t  late_reply_count;   ///< replies slower than the learned limit, which restart the learning
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for a PortHandler that learns its packet timeouts
+/// @description It wraps another PortHandler and passes every call through, while
+/// @description timing each transaction from writePort() until the length given to
+/// @description setPacketTimeout(uint16_t) has been read. Once an instruction has enough
+/// @description samples its timeout becomes the wire time plus a high percentile of the
+/// @description measured delay times a factor plus a margin, so a missing status packet
+/// @description fails in about the time a reply takes instead of the fixed worst case of
+/// @description the wrapped port. After such a timeout the next transaction of the same
+/// @description instruction gets the fixed timeout again; if its reply comes later than
+/// @description the learned limit, the limit was too short : the samples are dropped and
+/// @description the instruction is learned again, so a slower bus costs one false timeout
+/// @description instead of one per packet. Times are integer monotonic nanoseconds.
+/// @description It is not thread safe; use it, including getModel(), from the thread
+/// @description that owns the port.
+////////////////////////////////////////////////////////////////////////////////
+class AdaptivePortHandler : public dynamixel::PortHandler
+{
+ public:
+  struct Param
+  {
+    double    percentile;       ///< 0-100, percentile of the delay window the timeout is built on
+    double    factor;           ///< multiplies the percentile
+    uint32_t  margin_usec;      ///< added on top
+    uint32_t  min_samples;      ///< samples needed before the learned timeout is used
+    uint32_t  window;           ///< number of recent samples kept per instruction
+
+    Param()
+      : percentile(99.0),
+        factor(1.5),
+        margin_usec(1000),
+        min_samples(32),
+        window(256)
+    { }
+  };
+
+ private:
+  struct Model
+  {
+    uint8_t               instruction;
+    std::vector<uint32_t> sample_list;        // ring of delays in us
+    size_t                next;
+    uint64_t              sample_count;
+    uint32_t              p50_usec;
+    uint32_t              percentile_usec;
+    uint32_t              timeout_usec;
+    uint64_t              timeout_count;
+    uint64_t              late_reply_count;
+    bool                  is_probing;         // timed out last time : next one gets the fixed timeout
+  };
+
+  dynamixel::PortHandler *port_;
+  Param                   param_;
+  std::vector<Model>      model_list_;
+
+  int         model_index_;           // model of the instruction in flight, or -1
+  uint64_t    tx_start_nsec_;
+  size_t      tx_length_;
+  uint64_t    wire_nsec_;             // wire time of the instruction and the expected reply
+  uint64_t    deadline_nsec_;         // 0 : the wrapped port decides
+  size_t      rx_expected_;
+  size_t      rx_length_;
+
+  int         findModel     (uint8_t instruction);
+  uint64_t    getByteTimeNsec();
+  void        addSample     (Model &model, uint64_t delay_nsec);
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that wraps a port
+  /// @param port PortHandler instance, owned and deleted by this one
+  ////////////////////////////////////////////////////////////////////////////////
+  AdaptivePortHandler(dynamixel::PortHandler *port);
+  virtual ~AdaptivePortHandler();
+
+  bool    openPort();
+  void    closePort();
+  void    clearPort();
+
+  void    setPortName(const char *port_name);
+  char   *getPortName();
+
+  bool    setBaudRate(const int baudrate);
+  int     getBaudRate();
+
+  int     getBytesAvailable();
+
+  int     readPort(uint8_t *packet, int length);
+  int     writePort(uint8_t *packet, int length);
+
+  void    setPacketTimeout(uint16_t packet_length);
+  void    setPacketTimeout(double msec);
+  bool    isPacketTimeout();
+
+  Param  &param()                             { return param_; }
+  dynamixel::PortHandler *getWrappedPort()    { return port_; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the learned model, one entry per instruction seen
+  ////////////////////////////////////////////////////////////////////////////////
+  std::vector<AdaptiveTimeoutModel> getModel() const;
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that forgets every sample
+  ////////////////////////////////////////////////////////////////////////////////
+  void    resetModel();
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_ADAPTIVEPORTHANDLER_H_ */
@@ -0,0 +1,176 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for finding, raising and lowering the bus baud rate
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_BAUDRATE_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_BAUDRATE_H_
+
+
+#include <stdint.h>
+#include <vector>
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/control_table.h"
+
+#define BAUD_RATE_VALUE_COUNT     8     // Baud Rate register values 0 - 7
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that converts a Baud Rate register value into bps
+/// @return bps, or 0 for an unknown value
+////////////////////////////////////////////////////////////////////////////////
+int   getBaudRateOfValue  (uint8_t baud_rate_value);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that converts bps into a Baud Rate register value
+/// @return 0 - 7, or -1 when the grippers have no such rate
+////////////////////////////////////////////////////////////////////////////////
+int   getBaudRateValue    (int baudrate);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that returns every rate the grippers support, fastest first
+////////////////////////////////////////////////////////////////////////////////
+std::vector<int> getBaudRateList();
+
+struct BaudRateParam
+{
+  uint32_t  test_count;       ///< reads per gripper in the error-rate test
+  double    max_error_rate;   ///< failed reads / reads that still passes the test
+  uint32_t  write_retry;      ///< attempts of each Baud Rate write before giving up
+
+  BaudRateParam();
+};
+
+struct BaudRateReport
+{
+  int       from_baudrate;    ///< port rate before the call
+  int       baudrate;         ///< port and gripper rate after the call
+  uint32_t  tried_count;      ///< rates switched to and tested
+  uint32_t  test_read_count;  ///< reads of the last test
+  uint32_t  test_error_count; ///< failed reads of the last test
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that finds the rate a gripper is listening at
+/// @description One port can only listen at one rate, so the rates are pinged one
+/// @description after another, cheapest guess first : the rate the port is set to,
+/// @description then candidate_list in its order. A wrong rate costs one ping timeout.
+/// @description The port is left at the rate found, or at its rate before the call.
+/// @param ph PacketHandler instance
+/// @param port PortHandler instance
+/// @param id Gripper ID
+/// @param candidate_list Rates to try after the port rate
+/// @param baudrate Rate found
+/// @return COMM_SUCCESS, or COMM_RX_TIMEOUT when no rate answered
+////////////////////////////////////////////////////////////////////////////////
+int findBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                 const std::vector<int> &candidate_list, int *baudrate);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that moves the grippers and the port to another rate
+/// @description Baud Rate is written to every gripper at the port rate, then the port
+/// @description follows and every gripper is pinged at the new rate. If one of them
+/// @description does not answer, the grippers that moved are written back and the
+/// @description port returns to its rate before the call.
+/// @param table Control table of the gripper model
+/// @param id_list Every gripper on the bus
+/// @param baudrate New rate
+/// @return COMM_SUCCESS, COMM_NOT_AVAILABLE when the port does not support the rate,
+/// @return   the gripper has no such rate or a gripper has torque on (Baud Rate is in
+/// @return   the EEPROM area), or the failed communication result
+////////////////////////////////////////////////////////////////////////////////
+int changeBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table,
+                   const std::vector<uint8_t> &id_list, int baudrate,
+                   const BaudRateParam &param = BaudRateParam());
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that counts failed reads at the port rate
+/// @description Present Position is read param.test_count times from each gripper.
+/// @return failed reads
+////////////////////////////////////////////////////////////////////////////////
+uint32_t testBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table,
+                      const std::vector<uint8_t> &id_list, const BaudRateParam &param = BaudRateParam());
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that raises the bus to the fastest rate that passes the test
+/// @description Rates of candidate_list faster than the port rate are tried from the
+/// @description fastest : each is changed to and tested with testBaudRate(), and the
+/// @description first one within param.max_error_rate is kept. A rate that fails the
+/// @description test is left for the one before the call, so the bus never ends up
+/// @description slower than it started.
+/// @param candidate_list Rates to try, e.g. getBaudRateList()
+/// @param report Rates tried and the last test, may be NULL
+/// @return COMM_SUCCESS also when no faster rate passed, or the result of a change
+/// @return   that could not be undone
+////////////////////////////////////////////////////////////////////////////////
+int raiseBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table,
+                  const std::vector<uint8_t> &id_list, const std::vector<int> &candidate_list,
+                  const BaudRateParam &param = BaudRateParam(), BaudRateReport *report = 0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that lowers the bus to the fastest slower rate that passes the test
+/// @description Used when a BaudRateMonitor reports that errors climbed. Rates of
+/// @description candidate_list slower than the port rate are tried from the fastest
+/// @description and the first one that passes is kept.
+/// @return COMM_SUCCESS, COMM_RX_CORRUPT when no slower rate passed, or the result of
+/// @return   a change that failed
+////////////////////////////////////////////////////////////////////////////////
+int lowerBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table,
+                  const std::vector<uint8_t> &id_list, const std::vector<int> &candidate_list,
+                  const BaudRateParam &param = BaudRateParam(), BaudRateReport *report = 0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that watches the error rate of the bus while it runs
+/// @description Feed it the result of every transaction. It trips once more than
+/// @description max_error_rate of the last window transactions failed, and stays
+/// @description tripped until reset().
+////////////////////////////////////////////////////////////////////////////////
+class BaudRateMonitor
+{
+ public:
+  BaudRateMonitor(uint32_t window = 200, double max_error_rate = 0.05);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that feeds one transaction result
+  /// @return true once the monitor has tripped
+  ////////////////////////////////////////////////////////////////////////////////
+  bool      add             (int result);
+
+  void      reset           ();
+
+  bool      isTripped       () const  { return is_tripped_; }
+  uint32_t  getErrorCount   () const  { return error_count_; }   ///< in the window
+
+ private:
+  std::vector<bool> result_list_;   // true for a failure
+  uint32_t  window_;
+  double    max_error_rate_;
+
+  uint32_t  next_;
+  uint32_t  count_;
+  uint32_t  error_count_;
+  bool      is_tripped_;
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_BAUDRATE_H_ */
@@ -0,0 +1,171 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for driving grippers spread over several serial adapters
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_BUSMANAGER_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_BUSMANAGER_H_
+
+
+#include <mutex>
+#include <vector>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/bus_owner.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/gripper_group.h"
+#include "rh_p12_rn/stall_detector.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The struct for the last motion state read from one gripper
+////////////////////////////////////////////////////////////////////////////////
+struct GripperTelemetry
+{
+  size_t      port;           ///< index of the port in the BusManager
+  uint8_t     id;
+  MotionState state;
+  int         result;         ///< communication result of the read that filled state
+  uint64_t    time_usec;      ///< monotonic time of that read, 0 before the first one
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that runs one bus thread per serial adapter
+/// @description Every port gets its own BusOwner, optionally pinned to a CPU, and a
+/// @description GripperGroup of the grippers on it. A command is routed by the index of
+/// @description the port and the ID on it, so the same ID may be used on several
+/// @description adapters. readTelemetry() reads every port at once, one Sync Read each,
+/// @description and merges the results into one table, so the cycle takes as long as
+/// @description the slowest bus rather than the sum of them.
+////////////////////////////////////////////////////////////////////////////////
+class BusManager
+{
+ private:
+  struct Port
+  {
+    dynamixel::PortHandler *port;
+    BusOwner               *owner;
+    GripperGroup           *group;
+    size_t                  first_telemetry;    // index of its first gripper in telemetry_list_
+  };
+
+  dynamixel::PacketHandler     *ph_;
+  const ControlTable           &table_;
+  std::vector<Port>             port_list_;
+  bool                          is_started_;
+
+  std::mutex                    telemetry_mutex_;
+  std::vector<GripperTelemetry> telemetry_list_;
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes a manager without any port
+  /// @param ph PacketHandler instance
+  /// @param table Control table of the gripper model
+  ////////////////////////////////////////////////////////////////////////////////
+  BusManager(dynamixel::PacketHandler *ph, const ControlTable &table);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that stops the bus threads, then closes and deletes the ports
+  ////////////////////////////////////////////////////////////////////////////////
+  ~BusManager();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that adds an opened port, before start()
+  /// @param port PortHandler instance, owned by the manager from now on
+  /// @param cpu CPU for its bus thread, or -1 for no pinning
+  /// @return index of the port
+  ////////////////////////////////////////////////////////////////////////////////
+  size_t  addPort     (dynamixel::PortHandler *port, int cpu = -1);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that adds a gripper on a port, before start()
+  /// @return false
+  /// @return   when the port does not exist or already has the ID
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    addGripper  (size_t port, uint8_t id);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that starts every bus thread
+  ////////////////////////////////////////////////////////////////////////////////
+  void    start();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that finishes the queued transactions and stops every bus thread
+  ////////////////////////////////////////////////////////////////////////////////
+  void    stop();
+
+  size_t  getPortCount() const          { return port_list_.size(); }
+  size_t  getGripperCount() const       { return telemetry_list_.size(); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the bus thread of a port, for the commands routed to it
+  ////////////////////////////////////////////////////////////////////////////////
+  BusOwner     *getBusOwner (size_t port)   { return port_list_[port].owner; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the group of the grippers on a port
+  /// @description Use it only from transactions running on the bus thread of that port.
+  ////////////////////////////////////////////////////////////////////////////////
+  GripperGroup *getGroup    (size_t port)   { return port_list_[port].group; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that runs a transaction on the bus thread of a port and waits for it
+  /// @return the value returned by the transaction, or COMM_PORT_BUSY when stopped
+  ////////////////////////////////////////////////////////////////////////////////
+  int     execute     (size_t port, const BusOwner::Transaction &transaction);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that writes a register of one gripper, routed by port and ID
+  /// @param port Index of the port
+  /// @param id Gripper ID on that port
+  /// @param address Start address of the register
+  /// @param length Length of the register (1, 2 or 4)
+  /// @param value Register value
+  /// @return communication results which come from the PacketHandler write call
+  ////////////////////////////////////////////////////////////////////////////////
+  int     write       (size_t port, uint8_t id, uint16_t address, uint16_t length, uint32_t value);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that reads the motion state of every gripper, all ports at once
+  /// @return COMM_SUCCESS
+  /// @return   when every port answered
+  /// @return or the first failing communication result, in port order
+  ////////////////////////////////////////////////////////////////////////////////
+  int     readTelemetry();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that copies the last motion state of every gripper
+  /// @description Grippers come port by port, in the order they were added.
+  ////////////////////////////////////////////////////////////////////////////////
+  std::vector<GripperTelemetry> getTelemetry();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the number of transactions completed on all ports
+  ////////////////////////////////////////////////////////////////////////////////
+  uint64_t getCompletedCount() const;
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_BUSMANAGER_H_ */
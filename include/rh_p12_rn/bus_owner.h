@@ -0,0 +1,181 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the thread that owns the serial port
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_BUSOWNER_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_BUSOWNER_H_
+
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/mpsc_queue.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that serializes every transaction on one port through a single thread
+/// @description Any thread may hand over a transaction; the bus thread runs them
+/// @description one at a time in submission order, so packets of different
+/// @description threads never interleave on the wire. Requests travel through a
+/// @description lock-free MPSC queue; the bus thread only takes a mutex to sleep
+/// @description when the queue has stayed empty.
+////////////////////////////////////////////////////////////////////////////////
+class BusOwner
+{
+ public:
+  typedef std::function<int(dynamixel::PacketHandler *, dynamixel::PortHandler *)> Transaction;
+  typedef std::function<void(int)> Callback;
+
+ private:
+  struct Request
+  {
+    std::atomic<Request*> next;
+    Transaction           transaction;
+    Callback              callback;
+  };
+
+  dynamixel::PacketHandler *ph_;
+  dynamixel::PortHandler   *port_;
+
+  MpscQueue<Request>        queue_;
+
+  std::thread              *thread_;
+  std::thread::id           thread_id_;
+  int                       cpu_;
+  int                       priority_;
+  bool                      lock_memory_;
+  std::atomic<bool>         is_cpu_pinned_;
+  std::atomic<bool>         is_realtime_;
+  std::atomic<bool>         is_memory_locked_;
+  std::atomic<bool>         is_running_;
+  std::atomic<bool>         is_sleeping_;
+  std::atomic<int>          post_count_;      // post() calls between their is_running_ check and push
+  std::mutex                mutex_;
+  std::condition_variable   cond_;
+
+  std::atomic<uint64_t>     completed_count_;
+
+  void    run();
+  void    wake();
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes the owner of an opened port
+  /// @param ph PacketHandler instance
+  /// @param port PortHandler instance, no longer to be used directly once start() is called
+  ////////////////////////////////////////////////////////////////////////////////
+  BusOwner(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that calls stop()
+  ////////////////////////////////////////////////////////////////////////////////
+  ~BusOwner() { stop(); }
+
+  dynamixel::PacketHandler *getPacketHandler()  { return ph_; }
+  dynamixel::PortHandler   *getPortHandler()    { return port_; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that pins the bus thread to one CPU, taking effect at start() (Linux only)
+  /// @param cpu CPU index, or -1 for no pinning (default)
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setCpuAffinity(int cpu)     { cpu_ = cpu; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns whether the running bus thread got the CPU affinity
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    isCpuPinned() const         { return is_cpu_pinned_.load(); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that requests SCHED_FIFO for the bus thread, taking effect at start() (Linux only)
+  /// @description A ControlLoop whose step waits on execute() runs its transactions at the
+  /// @description priority of the bus thread, so it should be given at least the loop's.
+  /// @param priority 1-99, or 0 to keep the default scheduler (default)
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setRealtimePriority(int priority) { priority_ = priority; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that requests mlockall(MCL_CURRENT | MCL_FUTURE) at start() (Linux only)
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setLockMemory(bool lock)    { lock_memory_ = lock; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The functions that return whether the running bus thread got SCHED_FIFO and mlockall()
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    isRealtime() const          { return is_realtime_.load(); }
+  bool    isMemoryLocked() const      { return is_memory_locked_.load(); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that starts the bus thread
+  ////////////////////////////////////////////////////////////////////////////////
+  void    start();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that finishes the queued transactions and stops the bus thread
+  /// @description Requests arriving after stop() complete with COMM_PORT_BUSY.
+  ////////////////////////////////////////////////////////////////////////////////
+  void    stop();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that queues a transaction and reports its result through a callback
+  /// @description The callback runs on the bus thread and should return quickly.
+  /// @param transaction Work to run with the PacketHandler and PortHandler
+  /// @param callback Called with the value returned by the transaction, may be empty
+  ////////////////////////////////////////////////////////////////////////////////
+  void    post(const Transaction &transaction, const Callback &callback);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that queues a transaction and returns its result as a future
+  ////////////////////////////////////////////////////////////////////////////////
+  std::future<int> submit(const Transaction &transaction);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that runs a transaction on the bus thread and waits for it
+  /// @description Called from the bus thread itself (e.g. inside a transaction) it runs inline.
+  /// @return the value returned by the transaction, or COMM_PORT_BUSY when stopped
+  ////////////////////////////////////////////////////////////////////////////////
+  int     execute(const Transaction &transaction);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the number of transactions completed so far
+  ////////////////////////////////////////////////////////////////////////////////
+  uint64_t getCompletedCount() const  { return completed_count_.load(); }
+
+  /* blocking PacketHandler calls routed through the bus thread */
+  int ping          (uint8_t id, uint8_t *error = 0);
+  int readTxRx      (uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error = 0);
+  int read1ByteTxRx (uint8_t id, uint16_t address, uint8_t *data, uint8_t *error = 0);
+  int read2ByteTxRx (uint8_t id, uint16_t address, uint16_t *data, uint8_t *error = 0);
+  int read4ByteTxRx (uint8_t id, uint16_t address, uint32_t *data, uint8_t *error = 0);
+  int writeTxRx     (uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error = 0);
+  int write1ByteTxRx(uint8_t id, uint16_t address, uint8_t data, uint8_t *error = 0);
+  int write2ByteTxRx(uint8_t id, uint16_t address, uint16_t data, uint8_t *error = 0);
+  int write4ByteTxRx(uint8_t id, uint16_t address, uint32_t data, uint8_t *error = 0);
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_BUSOWNER_H_ */
@@ -0,0 +1,53 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for monotonic time stamps
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_CLOCK_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_CLOCK_H_
+
+
+#include <stdint.h>
+#include <chrono>
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that returns a monotonic time stamp in microseconds
+/// @description Unlike the wall clock, the value never jumps backwards.
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t getMonotonicTimeUsec()
+{
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that returns a monotonic time stamp in nanoseconds
+////////////////////////////////////////////////////////////////////////////////
+inline uint64_t getMonotonicTimeNsec()
+{
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_CLOCK_H_ */
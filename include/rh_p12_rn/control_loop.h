@@ -0,0 +1,143 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the fixed rate control loop
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_CONTROLLOOP_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_CONTROLLOOP_H_
+
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace rh_p12_rn
+{
+
+#define JITTER_HISTOGRAM_SIZE   16    // bucket i : jitter < 2^i us (last bucket : everything above)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The counters kept by ControlLoop
+/// @description Jitter is the wake-up lateness against the absolute deadline.
+////////////////////////////////////////////////////////////////////////////////
+struct ControlLoopStats
+{
+  uint64_t  cycle_count;
+  uint64_t  overrun_count;      ///< cycles whose step ran past the next deadline
+  uint64_t  missed_count;       ///< deadlines skipped to catch up after overruns
+  int64_t   min_jitter_nsec;
+  int64_t   max_jitter_nsec;
+  double    mean_jitter_nsec;
+  uint64_t  max_step_nsec;      ///< longest step() duration
+  uint64_t  jitter_histogram[JITTER_HISTOGRAM_SIZE];
+
+  bool      is_realtime;        ///< SCHED_FIFO was applied
+  bool      is_cpu_pinned;      ///< CPU affinity was applied
+  bool      is_memory_locked;   ///< mlockall() succeeded
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that calls a step function at a fixed period on its own thread
+/// @description Deadlines are absolute (clock_nanosleep with TIMER_ABSTIME on
+/// @description Linux), so the time a step takes does not shift the next cycle.
+/// @description After an overrun the missed deadlines are skipped rather than
+/// @description run back to back. SCHED_FIFO, CPU affinity and mlockall are
+/// @description optional and Linux only; failure to apply them is recorded in
+/// @description the stats and the loop runs anyway.
+////////////////////////////////////////////////////////////////////////////////
+class ControlLoop
+{
+ public:
+  typedef std::function<void()> Step;
+
+ private:
+  uint64_t            period_nsec_;
+  int                 priority_;
+  int                 cpu_;
+  bool                lock_memory_;
+
+  Step                step_;
+  std::thread        *thread_;
+  std::atomic<bool>   is_running_;
+
+  std::mutex          stats_mutex_;
+  ControlLoopStats    stats_;
+  double              jitter_sum_;
+
+  void    run();
+  void    applyThreadSettings();
+  void    record(int64_t jitter_nsec, uint64_t step_nsec, uint64_t missed);
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes a loop
+  /// @param period_usec Cycle period (1000 for 1 kHz)
+  ////////////////////////////////////////////////////////////////////////////////
+  ControlLoop(uint32_t period_usec);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that calls stop()
+  ////////////////////////////////////////////////////////////////////////////////
+  ~ControlLoop() { stop(); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that requests SCHED_FIFO for the loop thread
+  /// @param priority 1-99, or 0 to keep the default scheduler
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setRealtimePriority(int priority) { priority_ = priority; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that pins the loop thread to a CPU
+  /// @param cpu CPU index, or -1 for no pinning
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setCpuAffinity(int cpu)           { cpu_ = cpu; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that requests mlockall(MCL_CURRENT | MCL_FUTURE) at start()
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setLockMemory(bool lock)          { lock_memory_ = lock; }
+
+  void    setPeriod(uint32_t period_usec)   { period_nsec_ = (uint64_t)period_usec * 1000; }
+  uint32_t getPeriod() const                { return (uint32_t)(period_nsec_ / 1000); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that starts calling step every period
+  /// @return false
+  /// @return   when the loop is already running
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    start(const Step &step);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that stops the loop after the current step and joins the thread
+  /// @description It can be called from any thread but the loop thread itself.
+  ////////////////////////////////////////////////////////////////////////////////
+  void    stop();
+
+  bool    isRunning() const                 { return thread_ != NULL; }
+
+  ControlLoopStats getStats();
+  void    resetStats();
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_CONTROLLOOP_H_ */
@@ -0,0 +1,98 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the RH-P12-RN / RH-P12-RN(A) control table layouts
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_CONTROLTABLE_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_CONTROLTABLE_H_
+
+
+#include <stdint.h>
+
+/* ADDRESS (same on both models) */
+#define ADDR_MODEL_NUMBER       0
+#define ADDR_FIRMWARE_VERSION   6
+#define ADDR_ID                 7
+#define ADDR_BAUD_RATE          8
+#define ADDR_RETURN_DELAY_TIME  9
+
+/* DATA LENGTH (same on both models) */
+#define LEN_MODEL_NUMBER        2
+#define LEN_GOAL_PWM            2
+#define LEN_GOAL_CURRENT        2
+#define LEN_GOAL_VELOCITY       4
+#define LEN_GOAL_ACCELERATION   4
+#define LEN_GOAL_POSITION       4
+#define LEN_MOVING              1
+#define LEN_PRESENT_POSITION    4
+#define LEN_PRESENT_VELOCITY    4
+#define LEN_PRESENT_CURRENT     2
+#define LEN_PRESENT_VOLTAGE     2
+#define LEN_PRESENT_TEMPERATURE 1
+
+/* address of a register the model does not have */
+#define ADDR_NONE               0xFFFF
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The control table addresses and value limits of one gripper model
+/// @description rh-p12-rn.cpp and rh-p12-rna.cpp keep their own ADDR_* defines;
+/// @description this struct carries the same numbers for code shared by both.
+////////////////////////////////////////////////////////////////////////////////
+struct ControlTable
+{
+  const char *name;
+  uint16_t    model_number;
+
+  uint16_t  addr_operating_mode;
+  uint16_t  addr_indirect_address;    ///< Indirect Address 1 (2 bytes per slot)
+  uint16_t  addr_indirect_data;       ///< Indirect Data 1
+  uint16_t  indirect_slot_count;
+  uint16_t  addr_torque_enable;
+  uint16_t  addr_goal_pwm;            ///< ADDR_NONE on RH-P12-RN
+  uint16_t  addr_goal_current;
+  uint16_t  addr_goal_velocity;
+  uint16_t  addr_goal_acceleration;   ///< Profile Acceleration on RH-P12-RN(A)
+  uint16_t  addr_goal_position;
+  uint16_t  addr_moving;
+  uint16_t  addr_present_position;
+  uint16_t  addr_present_velocity;
+  uint16_t  addr_present_current;
+  uint16_t  addr_present_voltage;
+  uint16_t  addr_present_temperature;
+
+  int32_t   min_position;
+  int32_t   max_position;
+  int32_t   max_current;
+};
+
+extern const ControlTable CONTROL_TABLE_RH_P12_RN;   ///< RH-P12-RN
+extern const ControlTable CONTROL_TABLE_RH_P12_RNA;  ///< RH-P12-RN(A)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that returns the control table of a Model Number
+/// @return CONTROL_TABLE_RH_P12_RN, CONTROL_TABLE_RH_P12_RNA, or NULL for another model
+////////////////////////////////////////////////////////////////////////////////
+const ControlTable *findControlTable(uint16_t model_number);
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_CONTROLTABLE_H_ */
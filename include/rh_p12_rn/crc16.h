@@ -0,0 +1,70 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the Protocol 2.0 CRC and its faster implementations
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_CRC16_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_CRC16_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC_CLMUL_MIN_SIZE      64    // shorter data goes through slicing-by-8 on the PCLMULQDQ path
+
+namespace rh_p12_rn
+{
+
+enum CRCImplementation
+{
+  CRC_BYTEWISE,       ///< one 256-entry table lookup per byte, as the SDK does
+  CRC_SLICING_BY_8,   ///< eight 256-entry tables, eight bytes per step
+  CRC_CLMUL           ///< 128-bit folding with PCLMULQDQ (x86-64), slicing-by-8 for the rest
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that updates a Protocol 2.0 CRC (CRC-16/BUYPASS)
+/// @description It runs the fastest implementation the CPU has, chosen on the first
+/// @description call; every implementation gives the CRC of the SDK's updateCRC.
+/// @param crc CRC of the preceding bytes (0 to start)
+/// @param data Bytes to add
+/// @param size Number of bytes
+/// @return updated CRC
+////////////////////////////////////////////////////////////////////////////////
+uint16_t updateCRC(uint16_t crc, const uint8_t *data, size_t size);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that updates a CRC with one implementation, for tests and benchmarks
+/// @return updated CRC, or that of CRC_SLICING_BY_8 when the implementation is not available
+////////////////////////////////////////////////////////////////////////////////
+uint16_t updateCRC(CRCImplementation implementation, uint16_t crc, const uint8_t *data, size_t size);
+
+bool              isCRCImplementationAvailable(CRCImplementation implementation);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that returns the implementation updateCRC() runs
+////////////////////////////////////////////////////////////////////////////////
+CRCImplementation getCRCImplementation();
+
+const char       *getCRCImplementationName(CRCImplementation implementation);
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_CRC16_H_ */
@@ -0,0 +1,89 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for finding every gripper on every serial port
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_DISCOVERY_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_DISCOVERY_H_
+
+
+#include <string>
+#include <vector>
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/control_table.h"
+
+#define DISCOVERY_MAX_ID          252     // highest ID a gripper may have
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The struct for one device that answered a broadcast ping
+////////////////////////////////////////////////////////////////////////////////
+struct DiscoveredGripper
+{
+  std::string         port_name;
+  int                 baudrate;
+  uint8_t             id;
+  uint16_t            model_number;
+  uint8_t             firmware_version;
+  const ControlTable *table;      ///< NULL for a device that is not an RH-P12-RN / RH-P12-RN(A)
+};
+
+struct DiscoveryParam
+{
+  std::vector<int>  baudrate_list;  ///< rates pinged on every port, getBaudRateList() by default
+  uint8_t           max_id;         ///< highest ID expected; a lower one shortens the wait at each rate
+
+  DiscoveryParam();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that lists the serial ports grippers may be on
+/// @return /dev/ttyUSB* and /dev/ttyACM* on Linux, COM1 - COM32 on Windows
+////////////////////////////////////////////////////////////////////////////////
+std::vector<std::string> listSerialPorts();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that collects every status packet answering one broadcast ping
+/// @description Unlike PacketHandler::broadcastPing() the Model Number and Firmware
+/// @description Version of each device are kept, and the wait ends after the replies of
+/// @description max_id + 1 devices could have arrived, each delayed by up to 3 ms.
+/// @param port PortHandler instance, open at the rate to ping at
+/// @param max_id Highest ID expected
+/// @param gripper_list Devices that answered, in ID order; port_name and baudrate are taken from port
+/// @return COMM_SUCCESS also when nothing answered, or COMM_TX_FAIL
+////////////////////////////////////////////////////////////////////////////////
+int broadcastPing(dynamixel::PortHandler *port, uint8_t max_id, std::vector<DiscoveredGripper> *gripper_list);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that broadcast pings every port at every rate
+/// @description Each port gets its own thread, which opens it, pings at each rate of
+/// @description param.baudrate_list and closes it again, so the time taken is that of
+/// @description the slowest port rather than the sum. A port that does not open is skipped.
+/// @param port_name_list Port names, e.g. listSerialPorts(); anything getPortHandler() takes
+/// @return Devices found, in the order of port_name_list, then rate, then ID
+////////////////////////////////////////////////////////////////////////////////
+std::vector<DiscoveredGripper> discoverGrippers(const std::vector<std::string> &port_name_list,
+                                                const DiscoveryParam &param = DiscoveryParam());
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_DISCOVERY_H_ */
@@ -0,0 +1,76 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for a Bulk Read group with flat, preallocated storage
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_FLATBULKREAD_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_FLATBULKREAD_H_
+
+
+#include <stdint.h>
+#include "rh_p12_rn/flat_group_read.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for a drop-in replacement of dynamixel::GroupBulkRead
+/// @description GroupBulkRead keeps three std::maps keyed by ID (address, length and
+/// @description a heap buffer), and every rxPacket() reads each ID through
+/// @description PacketHandler::readRx(), which allocates a packet buffer. Here every ID
+/// @description owns a slot with its own span, found through a 253-entry index; the
+/// @description data of all slots, whatever their lengths, is packed in one cache-aligned
+/// @description arena, and the instruction packet and the receive buffer are built when
+/// @description the parameters change, so txPacket() and rxPacket() never touch the heap
+/// @description (see FlatGroupRead). The calls are those of GroupBulkRead, Protocol 2.0 only.
+////////////////////////////////////////////////////////////////////////////////
+class FlatBulkRead : public FlatGroupRead
+{
+ private:
+  void    makeParam ();
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes an empty group, as GroupBulkRead does
+  /// @param port PortHandler instance
+  /// @param ph PacketHandler instance, used for its protocol version only
+  ////////////////////////////////////////////////////////////////////////////////
+  FlatBulkRead(dynamixel::PortHandler *port, dynamixel::PacketHandler *ph);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that adds an ID and the span read from it
+  /// @return false
+  /// @return   when the ID is already in the group or out of range
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    addParam    (uint8_t id, uint16_t start_address, uint16_t data_length);
+  void    removeParam (uint8_t id);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that changes the span read from an ID of the group
+  /// @return false when the ID is not in the group, or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    changeParam (uint8_t id, uint16_t start_address, uint16_t data_length);
+  void    clearParam  ();
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_FLATBULKREAD_H_ */
@@ -0,0 +1,159 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the storage and receive path shared by the flat group reads
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_FLATGROUPREAD_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_FLATGROUPREAD_H_
+
+
+#include <stdint.h>
+#include <vector>
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/protocol2.h"
+#include "rh_p12_rn/register_view.h"
+
+#define FLAT_READ_ID_SLOTS      253     // IDs 0 - 252
+#define FLAT_READ_NO_SLOT       0xFF    // ID not in the group
+#define FLAT_READ_ALIGNMENT     64      // cache line the data arena starts on
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The base class of FlatSyncRead and FlatBulkRead
+/// @description Every ID of the group owns a slot : the span it is asked for and where
+/// @description its data lies in one cache-aligned arena. An ID finds its slot through a
+/// @description 253-entry index. The instruction packet and the receive buffer are built
+/// @description when the slots change, so txPacket() and rxPacket() never touch the heap.
+/// @description The status packets are parsed as they arrive, in any order, where they
+/// @description lie in the receive buffer, and the slot points at their data there; only
+/// @description a packet with byte stuffing is copied, unstuffed, into the arena. An ID
+/// @description that did not answer leaves the others available.
+/// @description It uses the PortHandler directly : call it from the thread that owns
+/// @description the port, e.g. inside BusOwner::execute().
+////////////////////////////////////////////////////////////////////////////////
+class FlatGroupRead
+{
+ protected:
+  struct Slot
+  {
+    uint8_t         id;
+    uint16_t        address;
+    uint16_t        length;
+    uint32_t        offset;   // in the arena
+    const uint8_t  *data;     // where the last rxPacket() left it : the receive buffer or the arena
+  };
+
+  dynamixel::PortHandler   *port_;
+  dynamixel::PacketHandler *ph_;
+
+  std::vector<Slot>     slot_list_;         // in the order of the instruction packet
+  uint8_t               slot_of_id_[FLAT_READ_ID_SLOTS];
+
+  std::vector<uint8_t>  arena_storage_;     // slot data, FLAT_READ_ALIGNMENT aligned in the storage
+  uint8_t              *arena_;
+  std::vector<uint8_t>  error_list_;
+  std::vector<uint8_t>  is_available_list_;
+
+  std::vector<uint8_t>  tx_packet_;
+  std::vector<uint8_t>  rx_buffer_;
+  uint8_t               unstuffed_[P2_MAX_PACKET_LENGTH];
+  uint16_t              wait_length_;       // bytes of all status packets
+
+  uint64_t              crc_error_count_;
+
+  FlatGroupRead(dynamixel::PortHandler *port, dynamixel::PacketHandler *ph);
+
+  const Slot *findSlot  (uint8_t id) const;
+  bool    addSlot       (uint8_t id, uint16_t address, uint16_t length);
+  bool    removeSlot    (uint8_t id);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that rebuilds the index, the arena, the buffers and the instruction packet
+  /// @param instruction P2_INST_SYNC_READ or P2_INST_BULK_READ
+  /// @param param Parameters of the instruction packet
+  ////////////////////////////////////////////////////////////////////////////////
+  void    makeBuffers   (uint8_t instruction, const std::vector<uint8_t> &param);
+
+  bool    takeStatus    (const uint8_t *packet, size_t length);
+  void    keepData      ();
+
+ public:
+  dynamixel::PortHandler   *getPortHandler()   { return port_; }
+  dynamixel::PacketHandler *getPacketHandler() { return ph_; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that sends the instruction packet
+  /// @return COMM_NOT_AVAILABLE when the group is empty or the protocol is not 2.0,
+  /// @return COMM_PORT_BUSY, COMM_TX_FAIL or COMM_SUCCESS
+  ////////////////////////////////////////////////////////////////////////////////
+  int     txPacket    ();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that receives the status packets of every ID
+  /// @return COMM_SUCCESS once every ID has answered, or COMM_RX_TIMEOUT
+  /// @return   (COMM_RX_CORRUPT when bytes came but no complete packet) with the IDs
+  /// @return   that did answer available
+  ////////////////////////////////////////////////////////////////////////////////
+  int     rxPacket    ();
+
+  int     txRxPacket  ();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that checks that the last rxPacket() received a register of an ID
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    isAvailable (uint8_t id, uint16_t address, uint16_t data_length) const;
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns a register of an ID received by the last rxPacket()
+  /// @param data_length 1, 2 or 4
+  /// @return the register value, or 0 when isAvailable() is false
+  ////////////////////////////////////////////////////////////////////////////////
+  uint32_t getData    (uint8_t id, uint16_t address, uint16_t data_length) const;
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the span of an ID received by the last rxPacket()
+  /// @return a view on the data where it was received, valid until the next rxPacket(),
+  /// @return   or an empty view when the ID did not answer
+  ////////////////////////////////////////////////////////////////////////////////
+  RegisterView getView(uint8_t id) const;
+
+  /* typed accessors, 0 when the register was not received */
+  uint8_t   getUint8  (uint8_t id, uint16_t address) const  { return (uint8_t)getData(id, address, 1); }
+  int16_t   getInt16  (uint8_t id, uint16_t address) const  { return (int16_t)getData(id, address, 2); }
+  uint16_t  getUint16 (uint8_t id, uint16_t address) const  { return (uint16_t)getData(id, address, 2); }
+  int32_t   getInt32  (uint8_t id, uint16_t address) const  { return (int32_t)getData(id, address, 4); }
+  uint32_t  getUint32 (uint8_t id, uint16_t address) const  { return getData(id, address, 4); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the error byte of the status packet of an ID
+  /// @return false
+  /// @return   when the ID did not answer the last rxPacket()
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    getError    (uint8_t id, uint8_t *error) const;
+
+  uint64_t getCRCErrorCount() const { return crc_error_count_; }
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_FLATGROUPREAD_H_ */
@@ -0,0 +1,164 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for a Protocol 2.0 PacketHandler that does not allocate per call
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_FLATPACKETHANDLER_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_FLATPACKETHANDLER_H_
+
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/protocol2.h"
+
+#define FLAT_PH_MAX_PORTS       16      // ports with their own buffers
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for a drop-in replacement of dynamixel::Protocol2PacketHandler
+/// @description Every call of Protocol2PacketHandler allocates its instruction and
+/// @description status packets on the heap (readTxRx, writeTxRx, syncReadTx,
+/// @description bulkReadTx ...). Here every port gets one set of buffers, allocated
+/// @description when the port is first used (or by addPort()), and every call after
+/// @description that builds and receives its packets in them, so a control loop does
+/// @description not touch the heap. The packets on the wire, the timeouts and the
+/// @description results are those of Protocol2PacketHandler.
+/// @description Buffers are kept by PortHandler address : removePort() before a port is
+/// @description closed and deleted hands its buffers to the next port, and at most
+/// @description FLAT_PH_MAX_PORTS ports hold buffers at once.
+/// @description A port must not be used from two threads at once, as with the SDK;
+/// @description different ports may be used from different threads.
+////////////////////////////////////////////////////////////////////////////////
+class FlatPacketHandler : public dynamixel::PacketHandler
+{
+ private:
+  struct PortBuffer
+  {
+    std::atomic<dynamixel::PortHandler *> port;   // NULL : free for the next port
+    uint8_t   tx[P2_MAX_PACKET_LENGTH];
+    uint8_t   rx[P2_MAX_PACKET_LENGTH];       // as received, byte stuffing included
+    uint8_t   status[P2_MAX_PACKET_LENGTH];   // the last status packet, unstuffed
+    uint8_t   param[P2_MAX_PACKET_LENGTH];    // parameters of the packet being built
+  };
+
+  std::atomic<PortBuffer *> buffer_list_[FLAT_PH_MAX_PORTS];
+  std::mutex                add_mutex_;
+  bool                      is_full_reported_;
+
+  PortBuffer *getBuffer (dynamixel::PortHandler *port);
+
+  int     transmit    (dynamixel::PortHandler *port, PortBuffer *buffer, uint8_t id, uint8_t instruction,
+                       const uint8_t *param, size_t param_length);
+  int     receive     (dynamixel::PortHandler *port, PortBuffer *buffer);
+  int     transact    (dynamixel::PortHandler *port, PortBuffer *buffer, uint8_t id, uint8_t instruction,
+                       const uint8_t *param, size_t param_length, uint8_t *error);
+  int     receiveFrom (dynamixel::PortHandler *port, PortBuffer *buffer, uint8_t id);
+
+ public:
+  FlatPacketHandler();
+  virtual ~FlatPacketHandler();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the instance shared by the examples
+  ////////////////////////////////////////////////////////////////////////////////
+  static FlatPacketHandler *getInstance();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that allocates the buffers of a port ahead of its first call
+  /// @description Calling it when the port is opened reports a full list there rather
+  /// @description than as COMM_NOT_AVAILABLE from a later call.
+  /// @return false when FLAT_PH_MAX_PORTS ports have buffers already, or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    addPort     (dynamixel::PortHandler *port);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that frees the buffers of a port for another port
+  /// @description To be called before the port is closed and deleted, with no call on it
+  /// @description running; another PortHandler later allocated at the same address
+  /// @description would otherwise get its buffers.
+  ////////////////////////////////////////////////////////////////////////////////
+  void    removePort  (dynamixel::PortHandler *port);
+
+  /* dynamixel::PacketHandler */
+  float   getProtocolVersion() { return 2.0; }
+
+  const char *getTxRxResult     (int result);
+  void        printTxRxResult   (int result);
+  const char *getRxPacketError  (uint8_t error);
+  void        printRxPacketError(uint8_t error);
+
+  int txPacket        (dynamixel::PortHandler *port, uint8_t *txpacket);
+  int rxPacket        (dynamixel::PortHandler *port, uint8_t *rxpacket);
+  int txRxPacket      (dynamixel::PortHandler *port, uint8_t *txpacket, uint8_t *rxpacket, uint8_t *error = 0);
+
+  int ping            (dynamixel::PortHandler *port, uint8_t id, uint8_t *error = 0);
+  int ping            (dynamixel::PortHandler *port, uint8_t id, uint16_t *model_number, uint8_t *error = 0);
+  int broadcastPing   (dynamixel::PortHandler *port, std::vector<uint8_t> &id_list);
+
+  int action          (dynamixel::PortHandler *port, uint8_t id);
+  int reboot          (dynamixel::PortHandler *port, uint8_t id, uint8_t *error = 0);
+  int factoryReset    (dynamixel::PortHandler *port, uint8_t id, uint8_t option = 0, uint8_t *error = 0);
+
+  int readTx          (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length);
+  int readRx          (dynamixel::PortHandler *port, uint8_t id, uint16_t length, uint8_t *data, uint8_t *error = 0);
+  int readTxRx        (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error = 0);
+
+  int read1ByteTx     (dynamixel::PortHandler *port, uint8_t id, uint16_t address);
+  int read1ByteRx     (dynamixel::PortHandler *port, uint8_t id, uint8_t *data, uint8_t *error = 0);
+  int read1ByteTxRx   (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint8_t *data, uint8_t *error = 0);
+
+  int read2ByteTx     (dynamixel::PortHandler *port, uint8_t id, uint16_t address);
+  int read2ByteRx     (dynamixel::PortHandler *port, uint8_t id, uint16_t *data, uint8_t *error = 0);
+  int read2ByteTxRx   (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t *data, uint8_t *error = 0);
+
+  int read4ByteTx     (dynamixel::PortHandler *port, uint8_t id, uint16_t address);
+  int read4ByteRx     (dynamixel::PortHandler *port, uint8_t id, uint32_t *data, uint8_t *error = 0);
+  int read4ByteTxRx   (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint32_t *data, uint8_t *error = 0);
+
+  int writeTxOnly     (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data);
+  int writeTxRx       (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error = 0);
+
+  int write1ByteTxOnly(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint8_t data);
+  int write1ByteTxRx  (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint8_t data, uint8_t *error = 0);
+
+  int write2ByteTxOnly(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t data);
+  int write2ByteTxRx  (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t data, uint8_t *error = 0);
+
+  int write4ByteTxOnly(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint32_t data);
+  int write4ByteTxRx  (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint32_t data, uint8_t *error = 0);
+
+  int regWriteTxOnly  (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data);
+  int regWriteTxRx    (dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error = 0);
+
+  int syncReadTx      (dynamixel::PortHandler *port, uint16_t start_address, uint16_t data_length, uint8_t *param, uint16_t param_length);
+  int syncWriteTxOnly (dynamixel::PortHandler *port, uint16_t start_address, uint16_t data_length, uint8_t *param, uint16_t param_length);
+
+  int bulkReadTx      (dynamixel::PortHandler *port, uint8_t *param, uint16_t param_length);
+  int bulkWriteTxOnly (dynamixel::PortHandler *port, uint8_t *param, uint16_t param_length);
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_FLATPACKETHANDLER_H_ */
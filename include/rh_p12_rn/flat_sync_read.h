@@ -0,0 +1,68 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for a Sync Read group with flat, preallocated storage
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_FLATSYNCREAD_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_FLATSYNCREAD_H_
+
+
+#include <stdint.h>
+#include "rh_p12_rn/flat_group_read.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for a drop-in replacement of dynamixel::GroupSyncRead
+/// @description GroupSyncRead keeps a heap buffer per ID in a std::map, and every
+/// @description rxPacket() goes through PacketHandler::readRx(), which allocates a
+/// @description packet buffer per ID. Here an ID finds its slot through a 253-entry
+/// @description index, the data of all slots lies in one cache-aligned arena, and the
+/// @description instruction packet and the receive buffer are built when the ID list
+/// @description changes, so txPacket() and rxPacket() never touch the heap (see
+/// @description FlatGroupRead). The calls are those of GroupSyncRead.
+////////////////////////////////////////////////////////////////////////////////
+class FlatSyncRead : public FlatGroupRead
+{
+ private:
+  uint16_t  start_address_;
+  uint16_t  data_length_;
+
+  void    makeParam ();
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes an empty group, as GroupSyncRead does
+  /// @param port PortHandler instance
+  /// @param ph PacketHandler instance, used for its protocol version only
+  /// @param start_address Start address of the span read from every ID
+  /// @param data_length Length of the span
+  ////////////////////////////////////////////////////////////////////////////////
+  FlatSyncRead(dynamixel::PortHandler *port, dynamixel::PacketHandler *ph, uint16_t start_address, uint16_t data_length);
+
+  bool    addParam    (uint8_t id);
+  void    removeParam (uint8_t id);
+  void    clearParam  ();
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_FLATSYNCREAD_H_ */
@@ -0,0 +1,181 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for driving several grippers on one bus with group instructions
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_GRIPPERGROUP_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_GRIPPERGROUP_H_
+
+
+#include <vector>
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/flat_sync_read.h"
+#include "rh_p12_rn/indirect_map.h"
+#include "rh_p12_rn/register_view.h"
+#include "rh_p12_rn/stall_detector.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that reads and commands a list of grippers of one model
+/// @description Moving, Present Position and Present Current of every gripper come
+/// @description back from one FlatSyncRead, and the goal positions and goal currents
+/// @description set in a cycle go out in one GroupSyncWrite each, so adding a gripper
+/// @description adds bytes to the packets instead of round trips.
+/// @description It uses the PortHandler directly : call it from the thread that owns
+/// @description the port, e.g. inside BusOwner::execute().
+////////////////////////////////////////////////////////////////////////////////
+class GripperGroup
+{
+ private:
+  struct Goal
+  {
+    int32_t   position;
+    int16_t   current;
+    bool      has_position;
+    bool      has_current;
+
+    Goal() : position(0), current(0), has_position(false), has_current(false) { }
+  };
+
+  dynamixel::PacketHandler *ph_;
+  dynamixel::PortHandler   *port_;
+  const ControlTable       &table_;
+
+  std::vector<uint8_t>      id_list_;
+  std::vector<MotionState>  state_list_;
+  std::vector<Goal>         goal_list_;         // goals set since the last write
+
+  const IndirectMap        *indirect_map_;
+  FlatSyncRead             *motion_read_;       // built on first use
+  MotionLayout              motion_layout_;     // where the registers are in the read span
+
+  dynamixel::GroupSyncWrite position_write_;
+  dynamixel::GroupSyncWrite current_write_;
+
+  void    makeMotionRead();
+  void    clearGoals();
+  void    cancelStagedGoals(size_t count);
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes an empty group
+  /// @param ph PacketHandler instance
+  /// @param port PortHandler instance
+  /// @param table Control table of the gripper model
+  ////////////////////////////////////////////////////////////////////////////////
+  GripperGroup(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table);
+  ~GripperGroup();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that adds a gripper
+  /// @return false
+  /// @return   when the ID is already in the group
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    addGripper  (uint8_t id);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that reads the motion registers from the indirect data window
+  /// @description The map must be programmed the same way on every gripper of the group.
+  /// @param map Indirect map holding Moving, Present Position and Present Current, or NULL to read them directly
+  /// @return false
+  /// @return   when one of the registers is not mapped
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    setIndirectMap(const IndirectMap *map);
+
+  size_t  getGripperCount() const         { return id_list_.size(); }
+  uint8_t getID(size_t index) const       { return id_list_[index]; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that reads Moving, Present Position and Present Current of every gripper
+  /// @return communication results which come from FlatSyncRead::txRxPacket()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     readMotionState();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that sends the read of readMotionState() without waiting for the status packets
+  /// @return communication results which come from FlatSyncRead::txPacket()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     readMotionStateTx();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that receives the status packets of readMotionStateTx()
+  /// @return communication results which come from FlatSyncRead::rxPacket()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     readMotionStateRx();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the state of one gripper received by the last read
+  /// @param index Index of the gripper in the group
+  ////////////////////////////////////////////////////////////////////////////////
+  const MotionState &getMotionState(size_t index) const { return state_list_[index]; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that sets the goal position sent by the next writeGoals() or writeGoalsOnAction()
+  /// @param index Index of the gripper in the group
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setGoalPosition(size_t index, int32_t position);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that sets the goal current sent by the next writeGoals() or writeGoalsOnAction()
+  /// @param index Index of the gripper in the group
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setGoalCurrent (size_t index, int16_t current);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that sends the goals set since the last call, one GroupSyncWrite per register
+  /// @return communication results which come from GroupSyncWrite::txPacket()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     writeGoals();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that stages the goals set since the last call and starts them together
+  /// @description Each gripper keeps its goal with a Reg Write instruction, and one broadcast
+  /// @description Action then applies all of them in the same bus slot, whatever the number
+  /// @description of grippers and registers. A gripper keeps only one registered write : when
+  /// @description both goals are set, the goal current is written at once (the current limit of
+  /// @description current-based position control) and the goal position waits for the Action.
+  /// @description No Action is sent when a Reg Write fails, so no gripper starts alone. The
+  /// @description grippers staged before the failure (and the failing one) then get their
+  /// @description present Goal Position or Goal Current registered instead, so a later Action,
+  /// @description broadcast or not, leaves them where they were. A gripper that cannot be
+  /// @description read for this keeps the goal it has registered.
+  /// @return COMM_RX_CORRUPT
+  /// @return   when a gripper answers a goal with an error
+  /// @return or communication results which come from PacketHandler::regWriteTxRx() or PacketHandler::action()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     writeGoalsOnAction();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that writes the same value to every gripper in one GroupSyncWrite
+  /// @param address Start address of the register
+  /// @param length Length of the register (1, 2 or 4)
+  /// @param value Register value
+  /// @return communication results which come from GroupSyncWrite::txPacket()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     writeAll    (uint16_t address, uint16_t length, uint32_t value);
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_GRIPPERGROUP_H_ */
@@ -0,0 +1,178 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for mirroring scattered registers into the indirect data window
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_INDIRECTMAP_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_INDIRECTMAP_H_
+
+
+#include <vector>
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/stall_detector.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that maps registers into the indirect address table
+/// @description Every byte of a mapped register gets one Indirect Address slot,
+/// @description so the registers appear back to back in the Indirect Data
+/// @description window and one readTxRx returns all of them.
+/// @description The indirect address table is in the EEPROM area: program()
+/// @description only writes it when it differs, and that needs torque off.
+////////////////////////////////////////////////////////////////////////////////
+class IndirectMap
+{
+ private:
+  struct Entry
+  {
+    uint16_t  address;
+    uint16_t  length;
+    uint16_t  offset;   // offset in the indirect data window
+  };
+
+  const ControlTable   &table_;
+  uint16_t              first_slot_;
+
+  std::vector<Entry>    entry_list_;
+  std::vector<uint8_t>  data_;
+  uint16_t              data_length_;
+
+  bool                  is_programmed_;
+  bool                  last_result_;
+
+  const Entry *findEntry(uint16_t address, uint16_t length) const;
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes an empty map
+  /// @param table Control table of the gripper model
+  /// @param first_slot Index of the first indirect slot to use (0 for Indirect Address 1)
+  ////////////////////////////////////////////////////////////////////////////////
+  IndirectMap(const ControlTable &table, uint16_t first_slot = 0);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that appends a register to the map
+  /// @param address Address of the register
+  /// @param length Length of the register
+  /// @return false
+  /// @return   when the register is mapped already
+  /// @return   when the indirect slots are exhausted
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    addParam    (uint16_t address, uint16_t length);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that clears the map
+  ////////////////////////////////////////////////////////////////////////////////
+  void    clearParam  ();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that writes the map into the indirect address table of the gripper
+  /// @description The current table is read back first and left untouched when it already matches.
+  /// @return communication results which come from PacketHandler::readTxRx() or PacketHandler::writeTxRx()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     program     (dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id, uint8_t *error = 0);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that sends the read of the indirect data window
+  /// @return COMM_NOT_AVAILABLE
+  /// @return   when program() has not succeeded
+  /// @return or communication results which come from PacketHandler::readTx()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     txPacket    (dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that receives the status packet of txPacket()
+  /// @return COMM_NOT_AVAILABLE
+  /// @return   when program() has not succeeded
+  /// @return or communication results which come from PacketHandler::readRx()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     rxPacket    (dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id, uint8_t *error = 0);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that reads the whole indirect data window
+  /// @return COMM_NOT_AVAILABLE
+  /// @return   when program() has not succeeded
+  /// @return or communication results which come from PacketHandler::readTxRx()
+  ////////////////////////////////////////////////////////////////////////////////
+  int     txRxPacket  (dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id, uint8_t *error = 0);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that checks whether a mapped register was received by txRxPacket()
+  /// @param address Original address of the register
+  /// @param length Length of the register
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    isAvailable (uint16_t address, uint16_t length) const;
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns a register received by txRxPacket()
+  /// @param address Original address of the register
+  /// @param length Length of the register
+  /// @return data value, or 0 when it is not available
+  ////////////////////////////////////////////////////////////////////////////////
+  uint32_t getData    (uint16_t address, uint16_t length) const;
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns where a mapped register appears in the indirect data window
+  /// @description Group reads of the window (GroupSyncRead) find the register there.
+  /// @param address Original address of the register
+  /// @param length Length of the register
+  /// @return address in the indirect data window, or ADDR_NONE when it is not mapped
+  ////////////////////////////////////////////////////////////////////////////////
+  uint16_t getMappedAddress(uint16_t address, uint16_t length) const;
+
+  const ControlTable &getControlTable() const { return table_; }
+
+  bool      isProgrammed()    const { return is_programmed_; }
+  uint16_t  getDataAddress()  const { return table_.addr_indirect_data + first_slot_; }
+  uint16_t  getDataLength()   const { return data_length_; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that reads Moving, Present Position and Present Current through an indirect map
+/// @description The map must contain the three registers.
+/// @return COMM_NOT_AVAILABLE
+/// @return   when one of the registers is not mapped
+/// @return or communication results which come from IndirectMap::txRxPacket()
+////////////////////////////////////////////////////////////////////////////////
+int readMotionState(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                    IndirectMap &map, MotionState *state, uint8_t *error = 0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that sends the read of readMotionState() through an indirect map
+/// @return communication results which come from IndirectMap::txPacket()
+////////////////////////////////////////////////////////////////////////////////
+int readMotionStateTx(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                      IndirectMap &map);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that receives the status packet of readMotionStateTx() through an indirect map
+/// @return COMM_NOT_AVAILABLE
+/// @return   when one of the registers is not mapped
+/// @return or communication results which come from IndirectMap::rxPacket()
+////////////////////////////////////////////////////////////////////////////////
+int readMotionStateRx(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                      IndirectMap &map, MotionState *state, uint8_t *error = 0);
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_INDIRECTMAP_H_ */
@@ -0,0 +1,72 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for switching the operating mode without fixed delays
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_MODESWITCH_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_MODESWITCH_H_
+
+
+#include <stdint.h>
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/control_table.h"
+
+#define MODE_SWITCH_TIMEOUT_USEC  200000    // longest a switch may take before it gives up
+
+namespace rh_p12_rn
+{
+
+const int32_t KEEP_GOAL_CURRENT = INT32_MIN;  ///< switchOperatingMode() restores Goal Current as it was
+
+struct ModeSwitchStats
+{
+  uint32_t  write_count;    ///< write instructions, retries included
+  uint32_t  poll_count;     ///< read-backs until each step was confirmed
+  uint64_t  elapsed_usec;   ///< from the goal snapshot to the restored goals
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that changes the Operating Mode as fast as the gripper allows
+/// @description Torque off, Operating Mode and torque on are each written and read back
+/// @description until the gripper reports the new value, so every step ends as soon as
+/// @description the gripper is ready instead of after a fixed 20 ms. The goal registers
+/// @description the firmware may reset (Goal PWM, Goal Current, Goal Velocity and
+/// @description Acceleration) are read in one packet before and written back in one
+/// @description packet after. Goal Position is left alone : torque on sets it to the
+/// @description present position.
+/// @param ph PacketHandler instance
+/// @param port PortHandler instance
+/// @param id Gripper ID
+/// @param table Control table of the gripper model
+/// @param mode New Operating Mode
+/// @param torque_on Torque Enable after the switch
+/// @param goal_current Goal Current to restore, or KEEP_GOAL_CURRENT
+/// @param stats Step counts and duration, may be NULL
+/// @param timeout_usec Time the whole switch may take
+/// @return communication results which come from PacketHandler, or COMM_RX_TIMEOUT
+/// @return   when a step was not confirmed in time
+////////////////////////////////////////////////////////////////////////////////
+int switchOperatingMode(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                        const ControlTable &table, uint8_t mode, bool torque_on,
+                        int32_t goal_current = KEEP_GOAL_CURRENT, ModeSwitchStats *stats = 0,
+                        uint32_t timeout_usec = MODE_SWITCH_TIMEOUT_USEC);
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_MODESWITCH_H_ */
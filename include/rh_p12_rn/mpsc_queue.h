@@ -0,0 +1,109 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the lock-free multi-producer single-consumer queue
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_MPSCQUEUE_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_MPSCQUEUE_H_
+
+
+#include <stddef.h>
+#include <atomic>
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The intrusive MPSC queue (D. Vyukov)
+/// @description Node must be default constructible and have a member
+/// @description std::atomic<Node*> next. push() is wait-free and may be called
+/// @description from any thread; pop() and isEmpty() belong to one consumer thread.
+/// @description The queue never owns or allocates nodes.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Node>
+class MpscQueue
+{
+ private:
+  std::atomic<Node*>  head_;    // last pushed, producers side
+  Node               *tail_;    // next to pop, consumer side
+  Node                stub_;
+
+  MpscQueue(const MpscQueue &);
+  MpscQueue &operator=(const MpscQueue &);
+
+ public:
+  MpscQueue()
+    : head_(&stub_),
+      tail_(&stub_)
+  {
+    stub_.next.store(NULL, std::memory_order_relaxed);
+  }
+
+  void push(Node *node)
+  {
+    node->next.store(NULL, std::memory_order_relaxed);
+    Node *_prev = head_.exchange(node, std::memory_order_acq_rel);
+    // seq_cst pairs with the consumer going to sleep (see BusOwner)
+    _prev->next.store(node, std::memory_order_seq_cst);
+  }
+
+  Node *pop()
+  {
+    Node *_tail = tail_;
+    Node *_next = _tail->next.load(std::memory_order_acquire);
+
+    if (_tail == &stub_)
+    {
+      if (_next == NULL)
+        return NULL;
+      tail_ = _next;
+      _tail = _next;
+      _next = _next->next.load(std::memory_order_acquire);
+    }
+
+    if (_next != NULL)
+    {
+      tail_ = _next;
+      return _tail;
+    }
+
+    // a producer has swapped head_ but not linked its node yet
+    if (_tail != head_.load(std::memory_order_acquire))
+      return NULL;
+
+    push(&stub_);
+
+    _next = _tail->next.load(std::memory_order_acquire);
+    if (_next != NULL)
+    {
+      tail_ = _next;
+      return _tail;
+    }
+    return NULL;
+  }
+
+  bool isEmpty() const
+  {
+    return tail_ == &stub_ && stub_.next.load(std::memory_order_seq_cst) == NULL;
+  }
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_MPSCQUEUE_H_ */
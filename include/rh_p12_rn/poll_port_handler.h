@@ -0,0 +1,136 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the Linux PortHandler that sleeps in poll() while a reply is on its way
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_POLLPORTHANDLER_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_POLLPORTHANDLER_H_
+
+#if defined(__linux__)
+
+#include <stdint.h>
+#include "dynamixel_sdk.h"
+
+/* port names starting with this open a PollPortHandler for the rest of the name in getPortHandler() */
+#define POLL_PORT_PREFIX        "poll:"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for a serial port whose reads wait for data in the kernel
+/// @description PacketHandler::rxPacket() calls readPort() and isPacketTimeout() in a loop
+/// @description until the status packet is complete. With PortHandlerLinux each turn
+/// @description returns at once, so the loop keeps a core busy for the whole round trip.
+/// @description Here readPort() sleeps in ppoll() while a packet timeout is running and
+/// @description nothing has arrived, and wakes on the first byte or at the deadline, which
+/// @description is kept in integer monotonic nanoseconds. The timeout budget and the port
+/// @description settings are the ones of PortHandlerLinux, so PacketHandler sees the same
+/// @description behaviour, except that the 2 x latency timer margin uses the adapter's own
+/// @description latency_timer when it is known. Outside a packet timeout readPort() does not wait.
+/// @description
+/// @description Opening the port also cuts the latency the USB-serial adapter adds to
+/// @description every reply, which at 2 Mbps is far longer than the wire time : the tty
+/// @description gets ASYNC_LOW_LATENCY and a usb-serial latency_timer (16 ms by default on
+/// @description FTDI adapters) is lowered to 1 ms when sysfs lets us write it. Both are put
+/// @description back by closePort(). The rate goes through termios2, so non-standard rates
+/// @description such as 4.5 Mbps are set with BOTHER. Settings that could not be applied
+/// @description are printed and show in getLowLatencyState().
+////////////////////////////////////////////////////////////////////////////////
+class PollPortHandler : public dynamixel::PortHandler
+{
+ public:
+  struct LowLatencyState
+  {
+    bool  is_low_latency;         ///< ASYNC_LOW_LATENCY is set on the tty
+    int   latency_timer_msec;     ///< usb-serial latency timer, -1 when the adapter has none
+    bool  is_custom_baudrate;     ///< the rate is not a standard one and went through BOTHER
+  };
+
+ private:
+  int       socket_fd_;
+  int       baudrate_;
+  char      port_name_[100];
+
+  uint64_t  byte_time_nsec_;
+  uint64_t  deadline_nsec_;         // 0 : no packet timeout running
+
+  bool            is_low_latency_enabled_;
+  LowLatencyState state_;
+  bool            was_low_latency_;       // ASYNC_LOW_LATENCY before we set it
+  int             saved_latency_timer_;   // latency_timer before we lowered it, or -1
+
+  bool      setupPort();
+  void      applyLowLatency();
+  void      restoreLowLatency();
+  bool      getLatencyTimerPath(char *path, size_t size);
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes a closed port
+  /// @param port_name Device name, e.g. /dev/ttyUSB0
+  ////////////////////////////////////////////////////////////////////////////////
+  PollPortHandler(const char *port_name);
+  virtual ~PollPortHandler() { closePort(); }
+
+  bool    openPort();
+  void    closePort();
+  void    clearPort();
+
+  void    setPortName(const char *port_name);
+  char   *getPortName();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that (re)opens the port at a baud rate
+  /// @return false
+  /// @return   when the device cannot be opened or does not take the rate
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    setBaudRate(const int baudrate);
+  int     getBaudRate();
+
+  int     getBytesAvailable();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that reads what has arrived, waiting for the first byte while a packet timeout runs
+  /// @return number of bytes read, 0 when none came before the deadline
+  ////////////////////////////////////////////////////////////////////////////////
+  int     readPort(uint8_t *packet, int length);
+  int     writePort(uint8_t *packet, int length);
+
+  void    setPacketTimeout(uint16_t packet_length);
+  void    setPacketTimeout(double msec);
+  bool    isPacketTimeout();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that turns the low latency settings on (default) or off for the next open
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setLowLatency(bool enable)                    { is_low_latency_enabled_ = enable; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the settings the open port actually has
+  ////////////////////////////////////////////////////////////////////////////////
+  const LowLatencyState &getLowLatencyState() const     { return state_; }
+};
+
+}
+
+#endif /* __linux__ */
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_POLLPORTHANDLER_H_ */
@@ -0,0 +1,46 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for opening a PortHandler by port name
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_PORTHANDLERFACTORY_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_PORTHANDLERFACTORY_H_
+
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/control_table.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that opens the PortHandler a port name asks for
+/// @description sim[:<id>[,<id>...]][:rn|:rna][:fast] gives a SimPortHandler (see
+/// @description getSimPortHandler()), adaptive:<name> wraps the port of <name> in an
+/// @description AdaptivePortHandler, and poll:<device> opens a PollPortHandler (Linux).
+/// @description Any other name goes to dynamixel::PortHandler::getPortHandler().
+/// @param port_name Port name
+/// @param table Control table of the simulated grippers by default
+////////////////////////////////////////////////////////////////////////////////
+dynamixel::PortHandler *getPortHandler(const char *port_name, const ControlTable &table);
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_PORTHANDLERFACTORY_H_ */
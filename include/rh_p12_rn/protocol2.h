@@ -0,0 +1,153 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for building and parsing Protocol 2.0 packets without the SDK
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_PROTOCOL2_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_PROTOCOL2_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "rh_p12_rn/crc16.h"
+
+/* PACKET LAYOUT */
+#define P2_HEADER0              0
+#define P2_HEADER1              1
+#define P2_HEADER2              2
+#define P2_RESERVED             3
+#define P2_ID                   4
+#define P2_LENGTH_L             5
+#define P2_LENGTH_H             6
+#define P2_INSTRUCTION          7
+#define P2_ERROR                8
+#define P2_INSTRUCTION_PARAM    8
+#define P2_STATUS_PARAM         9
+
+#define P2_HEADER_LENGTH        7     // header, reserved, id, length
+#define P2_MIN_PACKET_LENGTH    10    // instruction packet without parameters
+#define P2_MAX_PACKET_LENGTH    4096
+
+#define P2_BROADCAST_ID         0xFE
+
+/* INSTRUCTION */
+#define P2_INST_PING            0x01
+#define P2_INST_READ            0x02
+#define P2_INST_WRITE           0x03
+#define P2_INST_REG_WRITE       0x04
+#define P2_INST_ACTION          0x05
+#define P2_INST_FACTORY_RESET   0x06
+#define P2_INST_REBOOT          0x08
+#define P2_INST_STATUS          0x55
+#define P2_INST_SYNC_READ       0x82
+#define P2_INST_SYNC_WRITE      0x83
+#define P2_INST_BULK_READ       0x92
+#define P2_INST_BULK_WRITE      0x93
+
+/* FACTORY RESET OPTION */
+#define P2_RESET_ALL            0xFF
+#define P2_RESET_EXCEPT_ID      0x01
+#define P2_RESET_EXCEPT_ID_BAUD 0x02
+
+/* STATUS ERROR */
+#define P2_ERRNUM_RESULT_FAIL   1
+#define P2_ERRNUM_INSTRUCTION   2
+#define P2_ERRNUM_CRC           3
+#define P2_ERRNUM_DATA_RANGE    4
+#define P2_ERRNUM_DATA_LENGTH   5
+#define P2_ERRNUM_DATA_LIMIT    6
+#define P2_ERRNUM_ACCESS        7
+#define P2_ERRBIT_ALERT         0x80
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that builds an instruction or status packet
+/// @description Byte stuffing is applied to the payload, then the length and the CRC are filled in.
+/// @param id Packet ID
+/// @param instruction Instruction (P2_INST_STATUS for a status packet)
+/// @param payload Error byte and parameters of a status packet, or parameters of an instruction packet
+/// @param payload_length Length of the payload
+/// @param packet Buffer of at least P2_MAX_PACKET_LENGTH bytes
+/// @return length of the packet, or 0 when it does not fit
+////////////////////////////////////////////////////////////////////////////////
+size_t buildPacket(uint8_t id, uint8_t instruction, const uint8_t *payload, size_t payload_length, uint8_t *packet);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that finds the first complete packet in received bytes
+/// @description Garbage in front of a header and packets whose CRC does not match are
+/// @description skipped. The packet is left where it is, byte stuffing included.
+/// @param data Received bytes
+/// @param length Number of bytes
+/// @param start Offset of the packet, or of the first byte that may still begin one
+/// @param   when no packet is complete yet
+/// @param crc_error_count Incremented for every packet skipped for its CRC, may be NULL
+/// @return length of the packet, or 0 when no packet is complete yet
+////////////////////////////////////////////////////////////////////////////////
+size_t findPacket(const uint8_t *data, size_t length, size_t *start, uint64_t *crc_error_count = 0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that copies a packet found by findPacket() without its byte stuffing
+/// @param packet Packet as received
+/// @param packet_length Length of the packet as received
+/// @param out Buffer of at least packet_length bytes
+/// @return length of the copy, whose length field is updated
+////////////////////////////////////////////////////////////////////////////////
+size_t unstuffPacket(const uint8_t *packet, size_t packet_length, uint8_t *out);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that splits a byte stream into Protocol 2.0 packets
+/// @description Bytes are appended as they arrive; pop() returns each complete packet
+/// @description with its CRC checked and its byte stuffing removed. Garbage in front
+/// @description of a header is skipped, and so is a packet whose CRC does not match.
+////////////////////////////////////////////////////////////////////////////////
+class PacketStream
+{
+ private:
+  std::vector<uint8_t>  buffer_;
+  uint64_t              crc_error_count_;
+
+ public:
+  PacketStream();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that appends received bytes
+  ////////////////////////////////////////////////////////////////////////////////
+  void    append  (const uint8_t *data, size_t length);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that takes the next complete packet
+  /// @param packet Packet from the header through the CRC, with the stuffing removed and the length field updated
+  /// @return false
+  /// @return   when no complete packet is buffered
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    pop     (std::vector<uint8_t> *packet);
+
+  void    clear   ()  { buffer_.clear(); }
+
+  size_t    getBufferedLength() const { return buffer_.size(); }
+  uint64_t  getCRCErrorCount()  const { return crc_error_count_; }
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_PROTOCOL2_H_ */
@@ -0,0 +1,185 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for typed, bounds-checked views over received register data
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_REGISTERVIEW_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_REGISTERVIEW_H_
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/protocol2.h"
+#include "rh_p12_rn/stall_detector.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that assembles a little endian register value
+////////////////////////////////////////////////////////////////////////////////
+inline uint32_t getLittleEndian(const uint8_t *data, uint16_t length)
+{
+  switch (length)
+  {
+    case 1:   return data[0];
+    case 2:   return (uint32_t)data[0] | ((uint32_t)data[1] << 8);
+    case 4:   return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    default:  return 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for a read-only window on a span of received registers
+/// @description It points at the bytes where they were received (the parameters
+/// @description of a status packet, or the slot of a FlatGroupRead) and decodes a
+/// @description register in place, checking that it lies in the span. It is two
+/// @description pointers wide : pass it by value. It is valid until the buffer it
+/// @description points into is received into again.
+////////////////////////////////////////////////////////////////////////////////
+class RegisterView
+{
+ private:
+  const uint8_t  *data_;
+  uint16_t        start_address_;
+  uint16_t        length_;
+
+ public:
+  RegisterView() : data_(NULL), start_address_(0), length_(0) { }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @param data First byte of the span
+  /// @param start_address Address of the first byte
+  /// @param length Length of the span
+  ////////////////////////////////////////////////////////////////////////////////
+  RegisterView(const uint8_t *data, uint16_t start_address, uint16_t length)
+    : data_(data), start_address_(start_address), length_(length) { }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that makes a view on the parameters of a status packet
+  /// @param packet Status packet found by findPacket(), byte stuffing removed by unstuffPacket()
+  /// @param length Length of the packet
+  /// @param start_address Address the read started at
+  /// @return the view, or an empty one when the packet is not a status packet
+  ////////////////////////////////////////////////////////////////////////////////
+  static RegisterView ofStatusPacket(const uint8_t *packet, size_t length, uint16_t start_address)
+  {
+    if (length < P2_STATUS_PARAM + 2 || packet[P2_INSTRUCTION] != P2_INST_STATUS)
+      return RegisterView();
+    return RegisterView(packet + P2_STATUS_PARAM, start_address, (uint16_t)(length - P2_STATUS_PARAM - 2));
+  }
+
+  bool            isEmpty()         const { return data_ == NULL; }
+  const uint8_t  *getData()         const { return data_; }
+  uint16_t        getStartAddress() const { return start_address_; }
+  uint16_t        getLength()       const { return length_; }
+
+  bool contains(uint16_t address, uint16_t length) const
+  {
+    return data_ != NULL && address >= start_address_ &&
+           (uint32_t)(address - start_address_) + length <= length_;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns a register in the span
+  /// @param length 1, 2 or 4
+  /// @return the register value, or 0 when it is not in the span
+  ////////////////////////////////////////////////////////////////////////////////
+  uint32_t get(uint16_t address, uint16_t length) const
+  {
+    if (contains(address, length) == false)
+      return 0;
+    return getLittleEndian(data_ + (address - start_address_), length);
+  }
+
+  /* typed accessors, 0 when the register is not in the span */
+  uint8_t   getUint8  (uint16_t address) const  { return (uint8_t)get(address, 1); }
+  int16_t   getInt16  (uint16_t address) const  { return (int16_t)get(address, 2); }
+  uint16_t  getUint16 (uint16_t address) const  { return (uint16_t)get(address, 2); }
+  int32_t   getInt32  (uint16_t address) const  { return (int32_t)get(address, 4); }
+  uint32_t  getUint32 (uint16_t address) const  { return get(address, 4); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Where Moving, Present Position and Present Current are read from
+/// @description The control table addresses, or the addresses they are mirrored
+/// @description to in the indirect data window (see IndirectMap::getMappedAddress()).
+////////////////////////////////////////////////////////////////////////////////
+struct MotionLayout
+{
+  uint16_t  addr_moving;
+  uint16_t  addr_present_position;
+  uint16_t  addr_present_current;
+
+  MotionLayout() : addr_moving(ADDR_NONE), addr_present_position(ADDR_NONE), addr_present_current(ADDR_NONE) { }
+  explicit MotionLayout(const ControlTable &table)
+    : addr_moving(table.addr_moving),
+      addr_present_position(table.addr_present_position),
+      addr_present_current(table.addr_present_current) { }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for the motion registers of one gripper in a received span
+/// @description Every getter is checked against the span on its own; isValid()
+/// @description checks the three registers at once.
+////////////////////////////////////////////////////////////////////////////////
+class MotionView
+{
+ private:
+  RegisterView        view_;
+  const MotionLayout *layout_;
+
+ public:
+  MotionView(const RegisterView &view, const MotionLayout &layout) : view_(view), layout_(&layout) { }
+
+  bool isValid() const
+  {
+    return view_.contains(layout_->addr_moving, LEN_MOVING) &&
+           view_.contains(layout_->addr_present_position, LEN_PRESENT_POSITION) &&
+           view_.contains(layout_->addr_present_current, LEN_PRESENT_CURRENT);
+  }
+
+  uint8_t   getMoving()           const { return view_.getUint8(layout_->addr_moving); }
+  int32_t   getPresentPosition()  const { return view_.getInt32(layout_->addr_present_position); }
+  int16_t   getPresentCurrent()   const { return view_.getInt16(layout_->addr_present_current); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that decodes the three registers
+  /// @return false, leaving the state as it was, when one is not in the span
+  ////////////////////////////////////////////////////////////////////////////////
+  bool getMotionState(MotionState *state) const
+  {
+    if (isValid() == false)
+      return false;
+
+    // checked above, read without checking again
+    const uint8_t  *_data   = view_.getData();
+    uint16_t        _start  = view_.getStartAddress();
+    state->moving           = _data[layout_->addr_moving - _start];
+    state->present_position = (int32_t)getLittleEndian(_data + (layout_->addr_present_position - _start), LEN_PRESENT_POSITION);
+    state->present_current  = (int16_t)getLittleEndian(_data + (layout_->addr_present_current - _start), LEN_PRESENT_CURRENT);
+    return true;
+  }
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_REGISTERVIEW_H_ */
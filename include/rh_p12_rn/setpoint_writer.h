@@ -0,0 +1,167 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for coalescing goal register edits into rate-bounded writes
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_SETPOINTWRITER_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_SETPOINTWRITER_H_
+
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "rh_p12_rn/bus_owner.h"
+#include "rh_p12_rn/shadow_table.h"
+
+namespace rh_p12_rn
+{
+
+struct SetpointWriterStats
+{
+  uint64_t  set_count;        ///< calls to set()
+  uint64_t  packet_count;     ///< write instructions sent
+  uint64_t  register_count;   ///< registers carried by them
+  uint64_t  fail_count;       ///< write instructions that failed
+  uint64_t  elided_count;     ///< calls to set() dropped by the shadow table
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that keeps the latest value per goal register and writes it in the background
+/// @description set() only records the value : a writer thread sends the dirty registers at
+/// @description most once per interval, so a held key costs one write per interval instead
+/// @description of one per keypress, and the caller never waits on the port.
+/// @description Dirty registers joined by registers of known value go out as one contiguous
+/// @description writeTxRx; a register the writer has no value for, or a shared register that
+/// @description is not dirty, splits the write.
+////////////////////////////////////////////////////////////////////////////////
+class SetpointWriter
+{
+ private:
+  struct Register
+  {
+    uint16_t  address;
+    uint16_t  length;
+    int32_t   value;
+    bool      is_shared;
+    bool      is_known;
+    bool      is_dirty;
+  };
+
+  BusOwner               *bus_;
+  std::vector<uint8_t>    id_list_;
+  uint32_t                interval_usec_;
+  ShadowTable            *shadow_;
+
+  std::vector<Register>   register_list_;     // sorted by address
+  std::mutex              mutex_;
+  std::condition_variable cond_;
+  std::thread            *thread_;
+  bool                    is_running_;
+  uint64_t                set_sequence_;
+  uint64_t                written_sequence_;
+  uint64_t                last_write_usec_;
+  SetpointWriterStats     stats_;
+
+  Register *findRegister(uint16_t address);
+  bool      isDirty() const;
+  void      run();
+  void      writeRegisters(std::vector<Register> &register_list);
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes a writer for one gripper
+  /// @param bus Owner of the port the gripper is on
+  /// @param id Gripper ID
+  /// @param interval_usec Shortest time between two writes, 0 to write as soon as a value changes
+  ////////////////////////////////////////////////////////////////////////////////
+  SetpointWriter(BusOwner *bus, uint8_t id, uint32_t interval_usec);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes a writer for several grippers given the same values
+  /// @description Each write goes to all of them in one GroupSyncWrite.
+  /// @param bus Owner of the port the grippers are on
+  /// @param id_list Gripper IDs
+  /// @param interval_usec Shortest time between two writes, 0 to write as soon as a value changes
+  ////////////////////////////////////////////////////////////////////////////////
+  SetpointWriter(BusOwner *bus, const std::vector<uint8_t> &id_list, uint32_t interval_usec);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that calls stop()
+  ////////////////////////////////////////////////////////////////////////////////
+  ~SetpointWriter() { stop(); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that adds a register the writer may be given values for
+  /// @description Registers are added before start().
+  /// @param address Start address of the register
+  /// @param length Length of the register (1, 2 or 4)
+  /// @param is_shared true when something else writes the register too : its value is then
+  /// @param is_shared only sent while it is dirty and never carried along to join a write
+  /// @return false
+  /// @return   when it overlaps a register added before
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    addRegister (uint16_t address, uint16_t length, bool is_shared = false);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that keeps a shadow table in step with the writes
+  /// @description set() then drops a value the gripper already holds, and every write
+  /// @description is confirmed to, or on failure dropped from, the shadow table.
+  /// @param shadow Shadow table, or NULL
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setShadowTable(ShadowTable *shadow) { shadow_ = shadow; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that starts the writer thread
+  ////////////////////////////////////////////////////////////////////////////////
+  void    start       ();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that writes what is still dirty and stops the writer thread
+  ////////////////////////////////////////////////////////////////////////////////
+  void    stop        ();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that records a new goal value, replacing one not written yet
+  /// @description A value the shadow table reports as already held is dropped.
+  /// @return false
+  /// @return   when the register was not added
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    set         (uint16_t address, int32_t value);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that records a value the gripper already holds, without writing it
+  /// @description A register that is dirty keeps its pending value.
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    seed        (uint16_t address, int32_t value);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that waits until every value set so far has been written
+  /// @description Call it before writing the same registers some other way.
+  ////////////////////////////////////////////////////////////////////////////////
+  void    flush       ();
+
+  SetpointWriterStats getStats();
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_SETPOINTWRITER_H_ */
@@ -0,0 +1,151 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for keeping a host-side copy of the registers the host owns
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_SHADOWTABLE_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_SHADOWTABLE_H_
+
+
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+
+namespace rh_p12_rn
+{
+
+struct ShadowTableStats
+{
+  uint64_t  read_hit_count;     ///< reads answered from the copy
+  uint64_t  read_miss_count;    ///< reads that had to go to the gripper
+  uint64_t  write_count;        ///< writes that changed a value
+  uint64_t  write_elided_count; ///< writes dropped because the gripper already holds the value
+  uint64_t  invalidate_count;   ///< registers dropped by invalidate()
+  uint64_t  saved_bytes;        ///< register bytes that did not cross the bus
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that keeps a copy of registers only the host writes
+/// @description A register value is known after the host has written it or read it back.
+/// @description A known value answers reads until it grows older than the register's
+/// @description max age or an event it is bound to (torque, mode change, reboot) drops it,
+/// @description and a write of the value already held is reported as redundant.
+/// @description A value written but not confirmed yet is dirty : it answers reads and is
+/// @description kept over values read back, since the gripper does not hold it yet.
+////////////////////////////////////////////////////////////////////////////////
+class ShadowTable
+{
+ public:
+  static const uint64_t NO_MAX_AGE = 0;   ///< Value stays known until an event drops it
+
+  enum Event
+  {
+    EVENT_TORQUE  = 0x01,   ///< Torque Enable was written
+    EVENT_MODE    = 0x02,   ///< Operating Mode was written
+    EVENT_REBOOT  = 0x04,   ///< the gripper rebooted or lost power
+    EVENT_ALL     = 0xFF
+  };
+
+  struct Policy
+  {
+    uint64_t  max_age_usec;     ///< time a value read back or confirmed stays known, or NO_MAX_AGE
+    uint8_t   invalidate_on;    ///< Event bits that drop the value
+  };
+
+ private:
+  struct Register
+  {
+    uint16_t  address;
+    uint16_t  length;
+    Policy    policy;
+    int32_t   value;
+    bool      is_known;
+    bool      is_dirty;
+    uint64_t  update_usec;
+  };
+
+  std::vector<Register>   register_list_;     // sorted by address
+  std::mutex              mutex_;
+  ShadowTableStats        stats_;
+
+  Register *findRegister(uint16_t address);
+
+ public:
+  ShadowTable();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that adds a register to the copy
+  /// @description Registers are added before the copy is shared between threads.
+  /// @param address Start address of the register
+  /// @param length Length of the register (1, 2 or 4)
+  /// @param policy When a known value stops answering reads
+  /// @return false
+  /// @return   when it overlaps a register added before
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    addRegister (uint16_t address, uint16_t length, const Policy &policy);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that answers a read from the copy
+  /// @param address Start address of the register
+  /// @param value Sign-extended register value
+  /// @return false
+  /// @return   when the value is not known, or too old : read it from the gripper and update()
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    read        (uint16_t address, int32_t *value);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that records a value about to be written
+  /// @description The value becomes dirty until markWritten() confirms it.
+  /// @return false
+  /// @return   when the register already holds the value : skip the write
+  /// @return or true
+  ////////////////////////////////////////////////////////////////////////////////
+  bool    write       (uint16_t address, int32_t value);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that confirms a successful write
+  /// @description A dirty register stays dirty when a newer value was recorded meanwhile.
+  ////////////////////////////////////////////////////////////////////////////////
+  void    markWritten (uint16_t address, int32_t value);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that records a value read from the gripper
+  /// @description A dirty register keeps the value the host wrote.
+  ////////////////////////////////////////////////////////////////////////////////
+  void    update      (uint16_t address, int32_t value);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that drops one register, after a failed write or a write made some other way
+  ////////////////////////////////////////////////////////////////////////////////
+  void    invalidate  (uint16_t address);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that drops every register bound to one of the events
+  /// @param event Event bits
+  ////////////////////////////////////////////////////////////////////////////////
+  void    invalidateOn(uint8_t event);
+
+  ShadowTableStats getStats();
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_SHADOWTABLE_H_ */
@@ -0,0 +1,245 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the simulated RH-P12-RN / RH-P12-RN(A) grippers
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_SIMGRIPPER_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_SIMGRIPPER_H_
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "rh_p12_rn/control_table.h"
+
+#define SIM_CONTROL_TABLE_SIZE  1024
+#define SIM_NO_OBJECT           INT32_MIN
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for one simulated gripper
+/// @description The control table is held in memory with the addresses of the model,
+/// @description including the indirect address table and the indirect data window.
+/// @description The finger position follows a first-order response with a speed limit
+/// @description (Current-based Position Control, mode 5) or moves at a speed proportional
+/// @description to Goal Current (Current Control, mode 0). An object placed with setObject()
+/// @description stops the fingers while closing, and Present Current then rises to Goal Current.
+/// @description Present Velocity is reported in pulse/s.
+/// @description The model only advances when update() is called.
+////////////////////////////////////////////////////////////////////////////////
+class SimGripper
+{
+ public:
+  struct Param
+  {
+    double  time_constant_sec;    ///< first-order time constant of position control
+    double  max_speed;            ///< pulse/s, full stroke speed
+    double  current_per_speed;    ///< Present Current per pulse/s while moving freely
+    int32_t moving_threshold;     ///< pulse, Moving stays 1 while the position error is larger
+
+    Param()
+      : time_constant_sec(0.05),
+        max_speed(2300.0),
+        current_per_speed(0.1),
+        moving_threshold(2)
+    { }
+  };
+
+ private:
+  const ControlTable &table_;
+  Param       param_;
+
+  uint8_t     memory_[SIM_CONTROL_TABLE_SIZE];
+  double      position_;
+  double      velocity_;
+  int32_t     present_current_;
+  int32_t     object_position_;
+  uint64_t    last_update_nsec_;
+  uint64_t    goal_change_nsec_;
+
+  std::vector<uint8_t>  registered_data_;
+  uint16_t              registered_address_;
+  bool                  is_registered_;
+
+  uint16_t  resolveAddress  (uint16_t address) const;
+  bool      isWritable      (uint16_t address) const;
+
+  int32_t   getValue        (uint16_t address, uint16_t length) const;
+  void      setValue        (uint16_t address, uint16_t length, int32_t value);
+  void      updatePresent   ();
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes a gripper with the factory defaults
+  /// @param table Control table of the gripper model
+  /// @param id Gripper ID
+  ////////////////////////////////////////////////////////////////////////////////
+  SimGripper(const ControlTable &table, uint8_t id);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that reboots the gripper like a Reboot instruction
+  /// @description The EEPROM area (ID, Baud Rate, Operating Mode, Indirect Address ...)
+  /// @description is kept and the RAM area from Torque Enable on is cleared. The gripper
+  /// @description stays where it is, with Goal Position set to it.
+  ////////////////////////////////////////////////////////////////////////////////
+  void      reboot          ();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that restores the factory defaults like a Factory Reset instruction
+  /// @param option P2_RESET_ALL (ID back to 1), P2_RESET_EXCEPT_ID or P2_RESET_EXCEPT_ID_BAUD
+  /// @return 0
+  /// @return   when the defaults were restored
+  /// @return or P2_ERRNUM_DATA_RANGE for an unknown option, nothing is changed
+  ////////////////////////////////////////////////////////////////////////////////
+  uint8_t   factoryReset    (uint8_t option);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that advances the dynamics up to now
+  /// @param now_nsec Monotonic time in ns
+  ////////////////////////////////////////////////////////////////////////////////
+  void      update          (uint64_t now_nsec);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that reads the control table like a Read instruction
+  /// @return 0
+  /// @return   when the data was read
+  /// @return or P2_ERRNUM_* of the status packet
+  ////////////////////////////////////////////////////////////////////////////////
+  uint8_t   read            (uint16_t address, uint16_t length, uint8_t *data) const;
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that writes the control table like a Write instruction
+  /// @description Nothing is written when one of the bytes is refused.
+  /// @return 0
+  /// @return   when the data was written
+  /// @return or P2_ERRNUM_* of the status packet
+  ////////////////////////////////////////////////////////////////////////////////
+  uint8_t   write           (uint16_t address, uint16_t length, const uint8_t *data);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that keeps a write for the next Action instruction
+  /// @return 0
+  /// @return   when the data was registered
+  /// @return or P2_ERRNUM_* of the status packet
+  ////////////////////////////////////////////////////////////////////////////////
+  uint8_t   regWrite        (uint16_t address, uint16_t length, const uint8_t *data);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that applies the write kept by regWrite()
+  ////////////////////////////////////////////////////////////////////////////////
+  void      action          ();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that places an object between the fingers
+  /// @param position Position at which the closing fingers touch it, or SIM_NO_OBJECT
+  ////////////////////////////////////////////////////////////////////////////////
+  void      setObject       (int32_t position)  { object_position_ = position; }
+
+  Param    &param           ()  { return param_; }
+
+  const ControlTable &getControlTable() const { return table_; }
+
+  uint8_t   getID           () const  { return memory_[ADDR_ID]; }
+  int       getBaudRate     () const;
+  uint32_t  getReturnDelayTime() const { return memory_[ADDR_RETURN_DELAY_TIME] * 2; }  ///< us
+  bool      isRegistered    () const  { return is_registered_; }
+  double    getPosition     () const  { return position_; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns when Goal Position or Goal Current last changed
+  /// @description The time is the one of the instruction that changed it (Write, Sync Write,
+  /// @description Action ...), so comparing it across grippers gives their start-time skew.
+  /// @return Monotonic time in ns, or 0 if they have not changed since reboot()
+  ////////////////////////////////////////////////////////////////////////////////
+  uint64_t  getGoalChangeTime() const { return goal_change_nsec_; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that converts a Baud Rate register value into bps
+  /// @return bps, or 0 for an unknown value
+  ////////////////////////////////////////////////////////////////////////////////
+  static int  getBaudRate   (uint8_t baud_rate_value);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for simulated grippers sharing one bus
+/// @description process() answers one instruction packet the way the grippers on a
+/// @description Protocol 2.0 bus would: each addressed gripper whose baud rate matches
+/// @description the port appends its status packet, in the order the instruction asks.
+/// @description It is not thread safe; use it from the thread that owns the port.
+////////////////////////////////////////////////////////////////////////////////
+class SimBus
+{
+ public:
+  struct Reply
+  {
+    size_t    offset;             ///< offset of the status packet in the reply data
+    size_t    length;
+    uint32_t  return_delay_usec;  ///< Return Delay Time of the gripper that sends it
+  };
+
+ private:
+  std::vector<SimGripper *> gripper_list_;
+  std::vector<uint8_t>      payload_;
+  uint64_t                  packet_count_;
+
+  void  addStatus (SimGripper *gripper, uint8_t error, const uint8_t *param, size_t param_length,
+                   std::vector<uint8_t> *data, std::vector<Reply> *reply_list);
+
+ public:
+  SimBus();
+  ~SimBus();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that connects a new gripper to the bus
+  /// @return the gripper, owned by the bus
+  ////////////////////////////////////////////////////////////////////////////////
+  SimGripper *addGripper  (const ControlTable &table, uint8_t id);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that finds a gripper by ID
+  /// @return the gripper, or NULL
+  ////////////////////////////////////////////////////////////////////////////////
+  SimGripper *getGripper  (uint8_t id) const;
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that answers an instruction packet
+  /// @param packet Instruction packet with its byte stuffing removed (see PacketStream)
+  /// @param length Length of the packet
+  /// @param baudrate Baud rate the packet was sent at
+  /// @param now_nsec Monotonic time in ns, for the dynamics
+  /// @param data Status packets, appended
+  /// @param reply_list One entry per status packet, appended
+  ////////////////////////////////////////////////////////////////////////////////
+  void  process           (const uint8_t *packet, size_t length, int baudrate, uint64_t now_nsec,
+                           std::vector<uint8_t> *data, std::vector<Reply> *reply_list);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that advances the dynamics of every gripper up to now
+  ////////////////////////////////////////////////////////////////////////////////
+  void  update            (uint64_t now_nsec);
+
+  size_t    getGripperCount() const { return gripper_list_.size(); }
+  uint64_t  getPacketCount()  const { return packet_count_; }
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_SIMGRIPPER_H_ */
@@ -0,0 +1,142 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for the PortHandler talking to simulated grippers
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_SIMPORTHANDLER_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_SIMPORTHANDLER_H_
+
+
+#include <vector>
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/protocol2.h"
+#include "rh_p12_rn/sim_gripper.h"
+
+/* port names starting with this open a SimPortHandler in getSimPortHandler() and getPortHandler() */
+#define SIM_PORT_PREFIX         "sim"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class for a port whose bus is a SimBus instead of a serial device
+/// @description Instruction packets given to writePort() are answered by the simulated
+/// @description grippers, and the status packets become readable byte by byte at the
+/// @description time they would arrive over the wire : 10 bits per byte at the port baud
+/// @description rate, after the Return Delay Time of each gripper plus a fixed adapter
+/// @description latency. With the wire timing turned off every reply is readable at once
+/// @description and a missing reply times out immediately.
+////////////////////////////////////////////////////////////////////////////////
+class SimPortHandler : public dynamixel::PortHandler
+{
+ private:
+  struct Segment
+  {
+    size_t    offset;         // offset of the status packet in rx_data_
+    size_t    length;
+    uint64_t  start_nsec;     // arrival of its first byte
+  };
+
+  SimBus      bus_;
+  char        port_name_[100];
+  int         baudrate_;
+
+  bool        is_timing_enabled_;
+  uint32_t    latency_usec_;
+  uint64_t    byte_time_nsec_;
+  uint64_t    bus_free_nsec_;
+
+  double      packet_start_time_;
+  double      packet_timeout_;
+  double      tx_time_per_byte_;
+
+  PacketStream                tx_stream_;
+  std::vector<uint8_t>        tx_packet_;
+  std::vector<uint8_t>        rx_data_;
+  std::vector<Segment>        rx_segment_list_;
+  std::vector<SimBus::Reply>  reply_list_;
+  size_t                      rx_read_;
+
+  size_t  getArrivedLength(uint64_t now_nsec) const;
+  double  getCurrentTime();
+  double  getTimeSinceStart();
+
+ public:
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that initializes a port with no gripper on its bus
+  /// @param port_name Port name, only reported by getPortName()
+  ////////////////////////////////////////////////////////////////////////////////
+  SimPortHandler(const char *port_name = SIM_PORT_PREFIX);
+  virtual ~SimPortHandler() { closePort(); }
+
+  bool    openPort();
+  void    closePort();
+  void    clearPort();
+
+  void    setPortName(const char *port_name);
+  char   *getPortName();
+
+  bool    setBaudRate(const int baudrate);
+  int     getBaudRate();
+
+  int     getBytesAvailable();
+
+  int     readPort(uint8_t *packet, int length);
+  int     writePort(uint8_t *packet, int length);
+
+  void    setPacketTimeout(uint16_t packet_length);
+  void    setPacketTimeout(double msec);
+  bool    isPacketTimeout();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that returns the simulated bus
+  /// @description Grippers may be added or changed only while no transaction is running on the port.
+  ////////////////////////////////////////////////////////////////////////////////
+  SimBus &getBus()  { return bus_; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that turns the wire timing on (default) or off
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setWireTiming(bool enable)    { is_timing_enabled_ = enable; }
+  bool    isWireTiming() const          { return is_timing_enabled_; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that sets the fixed adapter latency added in front of every reply
+  /// @param usec Latency in us (0 by default)
+  ////////////////////////////////////////////////////////////////////////////////
+  void    setLatency(uint32_t usec)     { latency_usec_ = usec; }
+  uint32_t getLatency() const           { return latency_usec_; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that opens a SimPortHandler from a port name
+/// @description A port name of the form sim[:<id>[,<id>...]][:rn|:rna][:fast] gives a
+/// @description SimPortHandler with a gripper at each ID (1 when none is given), of the
+/// @description model of the table unless rn or rna says otherwise; fast turns the wire
+/// @description timing off. getPortHandler() opens it among the other port variants.
+/// @param port_name Port name
+/// @param table Control table of the simulated grippers by default
+/// @return the port, or NULL when the name does not start with SIM_PORT_PREFIX
+////////////////////////////////////////////////////////////////////////////////
+SimPortHandler *getSimPortHandler(const char *port_name, const ControlTable &table);
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_SIMPORTHANDLER_H_ */
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for overlapping host work with a transaction in flight
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_SPLITPHASE_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_SPLITPHASE_H_
+
+
+#include <functional>
+#include "dynamixel_sdk.h"
+
+namespace rh_p12_rn
+{
+
+struct SplitPhaseStats
+{
+  uint64_t  count;
+  uint64_t  fail_count;
+  uint64_t  work_nsec;        ///< host work done while status packets were on their way
+  uint64_t  wait_nsec;        ///< time left waiting for status packets after the work
+  uint64_t  max_wait_nsec;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that runs host work between the two halves of a transaction
+/// @description The bus is half duplex, so only one transaction is ever in flight; what
+/// @description can overlap is the host side. run() sends the instruction packet (e.g.
+/// @description readMotionStateTx()), runs the work while the gripper answers, then receives
+/// @description the status packet (e.g. readMotionStateRx()). A loop that works on the
+/// @description previous sample this way costs max(round trip, work) per cycle instead of
+/// @description round trip + work.
+/// @description The phases use the BusOwner::Transaction signature; call run() from a
+/// @description transaction so nothing else reaches the port between the halves.
+////////////////////////////////////////////////////////////////////////////////
+class SplitPhaseEngine
+{
+ public:
+  typedef std::function<int(dynamixel::PacketHandler *, dynamixel::PortHandler *)> Phase;
+  typedef std::function<void()> Work;
+
+ private:
+  SplitPhaseStats stats_;
+
+ public:
+  SplitPhaseEngine();
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that runs one split-phase transaction
+  /// @description The work runs even when the tx phase fails; the rx phase does not.
+  /// @param ph PacketHandler instance
+  /// @param port PortHandler instance
+  /// @param tx Sends the instruction packet
+  /// @param work Host work to overlap, may be empty
+  /// @param rx Receives the status packet
+  /// @return communication results which come from the tx or rx phase
+  ////////////////////////////////////////////////////////////////////////////////
+  int     run         (dynamixel::PacketHandler *ph, dynamixel::PortHandler *port,
+                       const Phase &tx, const Work &work, const Phase &rx);
+
+  SplitPhaseStats getStats() const  { return stats_; }
+  void            resetStats();
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_SPLITPHASE_H_ */
@@ -0,0 +1,139 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for detecting the end of a gripper motion
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_STALLDETECTOR_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_STALLDETECTOR_H_
+
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/control_table.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The motion registers sampled on every control cycle
+////////////////////////////////////////////////////////////////////////////////
+struct MotionState
+{
+  uint8_t   moving;
+  int32_t   present_position;
+  int16_t   present_current;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that reads Moving, Present Position and Present Current in one transaction
+/// @description The three registers lie in one short span on both models
+/// @description (610-622 on RH-P12-RN, 570-583 on RH-P12-RN(A)), so a single
+/// @description readTxRx replaces three round trips.
+/// @param ph PacketHandler instance
+/// @param port PortHandler instance
+/// @param id Gripper ID
+/// @param table Control table of the gripper model
+/// @param state Decoded registers
+/// @param error Device error
+/// @return communication results which come from PacketHandler::readTxRx()
+////////////////////////////////////////////////////////////////////////////////
+int readMotionState(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                    const ControlTable &table, MotionState *state, uint8_t *error = 0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that sends the read of readMotionState() without waiting for the status packet
+/// @return communication results which come from PacketHandler::readTx()
+////////////////////////////////////////////////////////////////////////////////
+int readMotionStateTx(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                      const ControlTable &table);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that receives the status packet of readMotionStateTx()
+/// @return communication results which come from PacketHandler::readRx()
+////////////////////////////////////////////////////////////////////////////////
+int readMotionStateRx(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                      const ControlTable &table, MotionState *state, uint8_t *error = 0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The class that decides when a gripper motion has ended
+/// @description A motion ends either by arriving at the goal position or by
+/// @description stalling on an object. Feed it one MotionState per cycle and
+/// @description it reports the end on the first cycle the condition holds,
+/// @description instead of waiting for a fixed number of idle samples.
+////////////////////////////////////////////////////////////////////////////////
+class StallDetector
+{
+ public:
+  static const int32_t NO_GOAL_POSITION = INT32_MIN; ///< Goal used in current control mode
+
+  enum Event
+  {
+    EVENT_NONE,
+    EVENT_ARRIVED,
+    EVENT_STALLED
+  };
+
+  struct Param
+  {
+    int32_t   position_tolerance;   ///< |present - goal| that counts as arrived
+    int32_t   stall_position_delta; ///< position change that still counts as standing still
+    int32_t   stall_current;        ///< |present current| that confirms a stall (0: not checked)
+    uint32_t  settle_time_usec;     ///< time in tolerance before an arrival is reported while Moving is still set
+    uint32_t  stall_time_usec;      ///< standing still time before a stall is reported
+    uint32_t  idle_time_usec;       ///< standing still time after which the motion ends regardless of current
+    uint32_t  start_grace_usec;     ///< time after reset() in which no stall is reported
+
+    Param();
+  };
+
+  StallDetector();
+
+  Param  &param()             { return param_; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that starts watching a new motion
+  /// @param goal_position Commanded goal position, or NO_GOAL_POSITION
+  /// @param now_usec Time stamp from getMonotonicTimeUsec()
+  ////////////////////////////////////////////////////////////////////////////////
+  void    reset(int32_t goal_position, uint64_t now_usec);
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// @brief The function that feeds one sample
+  /// @param state Sample read by readMotionState()
+  /// @param now_usec Time stamp from getMonotonicTimeUsec()
+  /// @return EVENT_ARRIVED or EVENT_STALLED once the motion has ended, or EVENT_NONE
+  ////////////////////////////////////////////////////////////////////////////////
+  Event   update(const MotionState &state, uint64_t now_usec);
+
+ private:
+  Param     param_;
+
+  int32_t   goal_position_;
+  uint64_t  start_time_;
+
+  bool      is_in_tolerance_;
+  uint64_t  in_tolerance_time_;
+
+  bool      has_anchor_;
+  int32_t   anchor_position_;
+  uint64_t  anchor_time_;
+};
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_STALLDETECTOR_H_ */
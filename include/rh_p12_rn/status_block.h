@@ -0,0 +1,89 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+////////////////////////////////////////////////////////////////////////////////
+/// @file The file for reading the goal and present registers in one packet
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RH_P12_RN_INCLUDE_RH_P12_RN_STATUSBLOCK_H_
+#define RH_P12_RN_INCLUDE_RH_P12_RN_STATUSBLOCK_H_
+
+
+#include "dynamixel_sdk.h"
+#include "rh_p12_rn/control_table.h"
+
+namespace rh_p12_rn
+{
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The goal and present registers used by the examples
+/// @description Registers the model does not have (goal_pwm on RH-P12-RN) read as 0.
+////////////////////////////////////////////////////////////////////////////////
+struct StatusBlock
+{
+  int16_t   goal_pwm;
+  int16_t   goal_current;
+  int32_t   goal_velocity;
+  int32_t   goal_acceleration;
+  int32_t   goal_position;
+  uint8_t   moving;
+  int32_t   present_position;
+  int32_t   present_velocity;
+  int16_t   present_current;
+  uint16_t  present_voltage;
+  uint8_t   present_temperature;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that returns the address span covering every StatusBlock register
+/// @description 596-625 (30 bytes) on RH-P12-RN, 548-594 (47 bytes) on RH-P12-RN(A)
+/// @param table Control table of the gripper model
+/// @param start_address First address of the span
+/// @param data_length Length of the span
+////////////////////////////////////////////////////////////////////////////////
+void getStatusBlockRange(const ControlTable &table, uint16_t *start_address, uint16_t *data_length);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that decodes a StatusBlock from raw control table bytes
+/// @param table Control table of the gripper model
+/// @param data Bytes read from start_address
+/// @param start_address Address of data[0]
+/// @param data_length Length of data
+/// @param block Decoded registers
+/// @return false
+/// @return   when data does not cover the whole status block
+/// @return or true
+////////////////////////////////////////////////////////////////////////////////
+bool decodeStatusBlock(const ControlTable &table, const uint8_t *data, uint16_t start_address, uint16_t data_length,
+                       StatusBlock *block);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief The function that reads the whole status block with one readTxRx
+/// @param ph PacketHandler instance
+/// @param port PortHandler instance
+/// @param id Gripper ID
+/// @param table Control table of the gripper model
+/// @param block Decoded registers
+/// @param error Device error
+/// @return communication results which come from PacketHandler::readTxRx()
+////////////////////////////////////////////////////////////////////////////////
+int readStatusBlock(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                    const ControlTable &table, StatusBlock *block, uint8_t *error = 0);
+
+}
+
+
+#endif /* RH_P12_RN_INCLUDE_RH_P12_RN_STATUSBLOCK_H_ */
@@ -24,9 +24,27 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "dynamixel_sdk.h"
+#include "rh_p12_rn/baud_rate.h"
+#include "rh_p12_rn/bus_owner.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_loop.h"
+#include "rh_p12_rn/discovery.h"
+#include "rh_p12_rn/flat_packet_handler.h"
+#include "rh_p12_rn/gripper_group.h"
+#include "rh_p12_rn/indirect_map.h"
+#include "rh_p12_rn/mode_switch.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "rh_p12_rn/setpoint_writer.h"
+#include "rh_p12_rn/shadow_table.h"
+#include "rh_p12_rn/split_phase.h"
+#include "rh_p12_rn/status_block.h"
+#include "rh_p12_rn/stall_detector.h"
 
 using namespace std;
 
@@ -58,6 +76,9 @@ using namespace std;
 #define ADDR_GOAL_VELOCITY      552
 #define ADDR_GOAL_POSITION      564
 #define ADDR_MOVING             570
+#define ADDR_PRESENT_CURRENT    574
+#define ADDR_PRESENT_POSITION   580
+#define ADDR_PRESENT_TEMPERATURE 594
 
 /* VALUE LIMIT */
 #define MIN_POSITION            0
@@ -73,10 +94,16 @@ using namespace std;
 #define MAX_CURRENT             1984
 
 
-#define PROTOCOL_VERSION        2.0
+#define REPEAT_PERIOD_USEC      2000    // auto repeat control loop : 500 Hz
+#define REPEAT_RT_PRIORITY      80      // SCHED_FIFO priority of the repeat loop and the bus thread, used when permitted
+#define SETPOINT_INTERVAL_USEC  20000   // parameter edits reach the gripper at most every 20 ms
 
-#define GRIPPER_ID              1
+#define CONTROL_TABLE           rh_p12_rn::CONTROL_TABLE_RH_P12_RNA
+
+#define GRIPPER_ID              1       // when no ID list is given
+#define DISCOVER_NAME           "discover"  // device name that looks for the grippers first
 #define BAUDRATE                2000000
+#define MAX_BAUDRATE            4500000 // startup raises the bus up to this rate (BAUDRATE keeps it as found)
 
 #if defined(__linux__)
 #define DEVICE_NAME             "/dev/ttyUSB0"
@@ -109,8 +136,6 @@ CONTROL g_curr_control    = CTRL_NONE;
 bool g_flag_goal_position = false;
 bool g_flag_auto_repeat   = false;
 
-bool g_flag_repeat_thread = false;
-
 int g_goal_position       = 740;
 int g_goal_velocity       = 2970;
 int g_goal_pwm            = 2009;
@@ -119,7 +144,104 @@ int g_goal_current        = 350;
 dynamixel::PacketHandler  *g_packet_handler = NULL;
 dynamixel::PortHandler    *g_port_handler   = NULL;
 
-thread *g_repeat_thread     = NULL;
+rh_p12_rn::BusOwner       *g_bus            = NULL;   // the only thread that talks to g_port_handler
+
+rh_p12_rn::ControlLoop    *g_repeat_loop    = NULL;
+
+rh_p12_rn::SetpointWriter *g_setpoint_writer = NULL;   // UpDownValue edits, written in the background
+rh_p12_rn::ShadowTable    *g_shadow_table   = NULL;   // goal registers only this process writes
+
+rh_p12_rn::IndirectMap *g_indirect_map = NULL;   // hot registers in the indirect data window
+
+std::vector<uint8_t>     g_gripper_id_list;        // every gripper on the bus, given the same commands
+rh_p12_rn::GripperGroup *g_grippers     = NULL;    // group reads and writes of g_gripper_id_list, on the bus thread
+rh_p12_rn::BaudRateMonitor g_baud_monitor;        // repeat loop errors, on the bus thread
+
+// finds the rate the grippers listen at, then raises the bus as far as MAX_BAUDRATE passes the error-rate test
+void setupBaudRate()
+{
+  int _start = g_port_handler->getBaudRate();
+  std::vector<int> _probe_list(1, 57600);   // factory default
+  std::vector<int> _rate_list = rh_p12_rn::getBaudRateList();
+  _probe_list.insert(_probe_list.end(), _rate_list.begin(), _rate_list.end());
+
+  int _baudrate = 0;
+  if (rh_p12_rn::findBaudRate(g_packet_handler, g_port_handler, g_gripper_id_list[0], _probe_list, &_baudrate) != COMM_SUCCESS)
+    return;   // reported by the ping after the bus starts
+
+  std::vector<int> _candidate_list;
+  for (size_t i = 0; i < _rate_list.size(); i++)
+  {
+    if (_rate_list[i] <= MAX_BAUDRATE)
+      _candidate_list.push_back(_rate_list[i]);
+  }
+
+  rh_p12_rn::BaudRateReport _report;
+  rh_p12_rn::raiseBaudRate(g_packet_handler, g_port_handler, CONTROL_TABLE, g_gripper_id_list, _candidate_list,
+                           rh_p12_rn::BaudRateParam(), &_report);
+  if (_report.baudrate != _baudrate)
+    printf("Raised the baudrate from %d (%u of %u test reads failed).\n", _baudrate, _report.test_error_count, _report.test_read_count);
+  else if (_baudrate != _start)
+    printf("Found the gripper at %d bps.\n", _baudrate);
+}
+
+// broadcast pings every port at every rate, lists what answered and picks the port and rate
+// with the most grippers of this model; "discover:<port>" looks on that port only
+bool discoverBus(const char *name, std::string *port_name, int *baudrate)
+{
+  std::vector<std::string> _port_name_list;
+  if (name[strlen(DISCOVER_NAME)] == ':')
+    _port_name_list.push_back(name + strlen(DISCOVER_NAME) + 1);
+  else
+    _port_name_list = rh_p12_rn::listSerialPorts();
+
+  printf("Discovering grippers on %d port(s)...\n", (int)_port_name_list.size());
+  uint64_t _start = rh_p12_rn::getMonotonicTimeUsec();
+  std::vector<rh_p12_rn::DiscoveredGripper> _gripper_list = rh_p12_rn::discoverGrippers(_port_name_list);
+
+  printf(" %-20s %9s %4s %6s  %s\n", "Port", "Baudrate", "ID", "Model", "");
+  size_t _best = 0, _best_count = 0;
+  for (size_t i = 0; i < _gripper_list.size(); i++)
+  {
+    const rh_p12_rn::DiscoveredGripper &_gripper = _gripper_list[i];
+    printf(" %-20s %9d %4d %6d  %s\n", _gripper.port_name.c_str(), _gripper.baudrate, _gripper.id,
+           _gripper.model_number, (_gripper.table != NULL)? _gripper.table->name : "-");
+
+    // the list is grouped by port and rate, so the first of a group counts its members
+    if (i > 0 && _gripper.port_name == _gripper_list[i - 1].port_name && _gripper.baudrate == _gripper_list[i - 1].baudrate)
+      continue;
+    size_t _count = 0;
+    for (size_t n = i; n < _gripper_list.size() && _gripper_list[n].port_name == _gripper.port_name &&
+                       _gripper_list[n].baudrate == _gripper.baudrate; n++)
+    {
+      if (_gripper_list[n].table == &CONTROL_TABLE)
+        _count++;
+    }
+    if (_count > _best_count)
+    {
+      _best       = i;
+      _best_count = _count;
+    }
+  }
+  printf("%d device(s) found in %.1f s\n\n", (int)_gripper_list.size(),
+         (rh_p12_rn::getMonotonicTimeUsec() - _start) / 1000000.0);
+
+  if (_best_count == 0)
+    return false;
+
+  *port_name  = _gripper_list[_best].port_name;
+  *baudrate   = _gripper_list[_best].baudrate;
+  if (g_gripper_id_list.empty())
+  {
+    for (size_t i = _best; i < _gripper_list.size() && _gripper_list[i].port_name == *port_name &&
+                           _gripper_list[i].baudrate == *baudrate; i++)
+    {
+      if (_gripper_list[i].table == &CONTROL_TABLE)
+        g_gripper_id_list.push_back(_gripper_list[i].id);
+    }
+  }
+  return true;
+}
 
 int getch()
 {
@@ -138,49 +260,136 @@ int getch()
 #endif
 }
 
-void repeatThreadFunc(int val)
+// auto repeat state, owned by the loop thread while it runs
+int                         g_repeat_direction    = 1;
+bool                        g_repeat_need_command = true;
+bool                        g_repeat_has_state    = false;
+std::vector<rh_p12_rn::StallDetector> g_repeat_detector_list;   // one per gripper
+std::vector<bool>           g_repeat_ended_list;                 // motion ended since the last command
+rh_p12_rn::SplitPhaseEngine g_repeat_engine;
+
+// sends the goal of the current direction to every gripper in one sync write, on the bus thread
+void sendRepeatCommand()
 {
-  const int _max_stop_count = 7;
+  uint64_t _now = rh_p12_rn::getMonotonicTimeUsec();
 
-  int       _direction      = 1;
-  int       _stop_cnt       = 0;
+  for (size_t i = 0; i < g_grippers->getGripperCount(); i++)
+  {
+    if (g_curr_mode == MODE_POSITION_CTRL)
+    {
+      int _goal = (g_repeat_direction < 0)? MIN_POSITION:MAX_POSITION;
+      g_grippers->setGoalPosition(i, _goal);
+      g_repeat_detector_list[i].reset(_goal, _now);
+    }
+    else  // MODE_CURRENT_CTRL
+    {
+      g_grippers->setGoalCurrent(i, g_goal_current * g_repeat_direction);
+      g_repeat_detector_list[i].reset(rh_p12_rn::StallDetector::NO_GOAL_POSITION, _now);
+    }
+    g_repeat_detector_list[i].param().stall_current = abs((short)g_goal_current) * 8 / 10;
+    g_repeat_ended_list[i] = false;
+  }
+  g_grippers->writeGoals();
 
-  uint8_t   _is_moving      = 0;
+  if (g_curr_mode == MODE_CURRENT_CTRL)
+    g_shadow_table->invalidate(ADDR_GOAL_CURRENT);
+  g_repeat_need_command = false;
+  g_repeat_has_state    = false;  // the last sample predates the new goal
+}
 
-  while (g_flag_repeat_thread)
+// one auto repeat cycle, called by g_repeat_loop every REPEAT_PERIOD_USEC
+void repeatStep()
+{
+  g_bus->execute([](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port) -> int
   {
-    if (g_packet_handler->read1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_MOVING, &_is_moving) == COMM_SUCCESS)
-    {
-      if (_is_moving == 1)
+    // the detectors work on the previous sample while this one is on the wire
+    int _result = g_repeat_engine.run(ph, port,
+      [](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port) -> int
       {
-        _stop_cnt = 0;
-      }
-      else if (++_stop_cnt > _max_stop_count)
+        return g_grippers->readMotionStateTx();
+      },
+      []()
       {
-        if (g_curr_mode == MODE_POSITION_CTRL)
+        if (g_repeat_has_state == false)
+          return;
+
+        // reverse as soon as every gripper has arrived or stalled on an object
+        uint64_t  _now          = rh_p12_rn::getMonotonicTimeUsec();
+        bool      _is_all_ended = true;
+        for (size_t i = 0; i < g_grippers->getGripperCount(); i++)
         {
-          g_packet_handler->write4ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_POSITION, 
-                                           (_direction < 0)? MIN_POSITION:MAX_POSITION);
+          if (g_repeat_ended_list[i] == false &&
+              g_repeat_detector_list[i].update(g_grippers->getMotionState(i), _now) != rh_p12_rn::StallDetector::EVENT_NONE)
+            g_repeat_ended_list[i] = true;
+          _is_all_ended = _is_all_ended && g_repeat_ended_list[i];
         }
-        else  // MODE_CURRENT_CTRL
+
+        if (_is_all_ended)
         {
-          g_packet_handler->write2ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_CURRENT,
-                                           g_goal_current * _direction);
+          g_repeat_direction = (-1) * (g_repeat_direction);
+          g_repeat_need_command = true;
         }
-        
-        _direction = (-1) * (_direction);
-        _stop_cnt = 0;
-      }
-    }
+      },
+      [](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port) -> int
+      {
+        return g_grippers->readMotionStateRx();
+      });
+    g_repeat_has_state = (_result == COMM_SUCCESS);
+    g_baud_monitor.add(_result);
+
+    if (g_repeat_need_command)
+      sendRepeatCommand();
+    return _result;
+  });
+}
 
-#if defined(__linux__)
-    usleep(100*1000);
-#elif defined(_WIN32) || defined(_WIN64)
-    Sleep(100);
-#endif
+void startRepeat()
+{
+  g_repeat_direction    = 1;
+  g_repeat_need_command = true;
+  g_repeat_has_state    = false;
+  g_repeat_loop->start(&repeatStep);
+}
+
+void stopRepeat()
+{
+  g_repeat_loop->stop();
+}
+
+// writes one value to every gripper in one sync write
+int writeAllGrippers(uint16_t address, uint16_t length, uint32_t value)
+{
+  return g_bus->execute([&](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                        { return g_grippers->writeAll(address, length, value); });
+}
+
+// writes outside the setpoint writer, keeping the shadow table in step
+void writeTorqueEnable(uint8_t enable)
+{
+  writeAllGrippers(ADDR_TORQUE_ENABLE, 1, enable);
+  g_shadow_table->invalidateOn(rh_p12_rn::ShadowTable::EVENT_TORQUE);
+
+  // when errors climbed, the bus steps down to a slower rate; Baud Rate is only writable with torque off
+  if (enable == 0)
+  {
+    g_bus->execute([](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+    {
+      if (g_baud_monitor.isTripped() == false)
+        return COMM_SUCCESS;
+      g_baud_monitor.reset();
+      return rh_p12_rn::lowerBaudRate(ph, port, CONTROL_TABLE, g_gripper_id_list, rh_p12_rn::getBaudRateList());
+    });
   }
 }
 
+void writeGoalCurrent(int current)
+{
+  if (writeAllGrippers(ADDR_GOAL_CURRENT, LEN_GOAL_CURRENT, current) == COMM_SUCCESS)
+    g_shadow_table->markWritten(ADDR_GOAL_CURRENT, current);
+  else
+    g_shadow_table->invalidate(ADDR_GOAL_CURRENT);
+}
+
 void gotoCursor(int row, int col)
 {
 #if defined(__linux__)
@@ -193,17 +402,41 @@ void gotoCursor(int row, int col)
 
 void drawPage(void)
 {
-  uint16_t  _data16;
-  uint32_t  _data32;
-
-  //if (gPacketHandler->read4ByteTxRx(gPortHandler, GRIPPER_ID, GOAL_POSITION_ADDR, &data32) == COMM_SUCCESS)
-  //  g_goal_position = data32;
-  if (g_packet_handler->read4ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_VELOCITY, &_data32) == COMM_SUCCESS)
-    g_goal_velocity = _data32;
-  if (g_packet_handler->read2ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_PWM, &_data16) == COMM_SUCCESS)
-    g_goal_pwm = _data16;
-  if (g_curr_mode != MODE_CURRENT_CTRL && g_packet_handler->read2ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_CURRENT, &_data16) == COMM_SUCCESS)
-    g_goal_current = _data16;
+  int32_t _velocity, _pwm, _current;
+
+  // these goals only change when this process writes them : the shadow table answers
+  // unless a mode or torque change has dropped them
+  if (g_shadow_table->read(ADDR_GOAL_VELOCITY, &_velocity) &&
+      g_shadow_table->read(ADDR_GOAL_PWM, &_pwm) &&
+      (g_curr_mode == MODE_CURRENT_CTRL || g_shadow_table->read(ADDR_GOAL_CURRENT, &_current)))
+  {
+    g_goal_velocity     = _velocity;
+    g_goal_pwm          = _pwm;
+    if (g_curr_mode != MODE_CURRENT_CTRL)
+      g_goal_current    = _current;
+  }
+  else
+  {
+    rh_p12_rn::StatusBlock _status;
+
+    // the page shows what the gripper holds, so pending edits go out first
+    g_setpoint_writer->flush();
+
+    // goal velocity, PWM and current come back in one packet,
+    // read from the first gripper : the others are given the same values
+    if (g_bus->execute([&](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                       { return rh_p12_rn::readStatusBlock(ph, port, g_gripper_id_list[0], CONTROL_TABLE, &_status); }) == COMM_SUCCESS)
+    {
+      g_shadow_table->update(ADDR_GOAL_VELOCITY, _status.goal_velocity);
+      g_shadow_table->update(ADDR_GOAL_PWM, _status.goal_pwm);
+      g_shadow_table->update(ADDR_GOAL_CURRENT, _status.goal_current);
+
+      g_goal_velocity     = _status.goal_velocity;
+      g_goal_pwm          = _status.goal_pwm;
+      if (g_curr_mode != MODE_CURRENT_CTRL)
+        g_goal_current    = _status.goal_current;
+    }
+  }
 
   //        0         1         2         3         4         5         6         7  
   //        012345678901234567890123456789012345678901234567890123456789012345678901
@@ -332,52 +565,37 @@ void moveCursorRight()
 
 void checkValue()
 {
+  // pending parameter edits go out before any command below
+  g_setpoint_writer->flush();
+
   if (g_curr_row == ROW_MODE_POSITION)
   {
     if (g_curr_mode != MODE_POSITION_CTRL)
     {
-      // auto repeat thread stop
-      if (g_curr_control == CTRL_REPEAT)
-      {
-        g_flag_repeat_thread = false;
-        g_repeat_thread->join();
-      }
-
-      // torque off
-      if (g_is_torque_on == true)
-        g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 0);
-
-#if defined(__linux__)
-      usleep(20 * 1000);
-#elif defined(_WIN32) || defined(_WIN64)
-      Sleep(20);
-#endif
-
-      // set mode to current based position control mode
-      g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_OPERATING_MODE, MODE_POSITION_CTRL);
-
-#if defined(__linux__)
-      usleep(20 * 1000);
-#elif defined(_WIN32) || defined(_WIN64)
-      Sleep(20);
-#endif
-
-      // torque on
-      if (g_is_torque_on == true)
-        g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 1);
-
-      // set goal current
+      // goal current is positive in position control
       if ((short)g_goal_current < 0)
         g_goal_current = (-1) * g_goal_current;
-      g_packet_handler->write2ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_CURRENT, g_goal_current);
 
-      if (g_curr_control == CTRL_REPEAT)
+      // set mode to current based position control mode on the bus thread, between two
+      // repeat steps : the repeat loop keeps running and sends its next command in the new mode
+      int _result = g_bus->execute([](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
       {
-        g_flag_repeat_thread = true;
-        g_repeat_thread = new thread(&repeatThreadFunc, 1);
-      }
-
-      g_curr_mode = MODE_POSITION_CTRL;
+        int _result = COMM_SUCCESS;
+        for (size_t i = 0; i < g_gripper_id_list.size(); i++)
+        {
+          int _gripper_result = rh_p12_rn::switchOperatingMode(ph, port, g_gripper_id_list[i], CONTROL_TABLE, MODE_POSITION_CTRL,
+                                                               g_is_torque_on, g_goal_current);
+          if (_result == COMM_SUCCESS)
+            _result = _gripper_result;
+        }
+        g_curr_mode           = MODE_POSITION_CTRL;
+        g_repeat_need_command = true;
+        g_repeat_has_state    = false;
+        return _result;
+      });
+      g_shadow_table->invalidateOn(rh_p12_rn::ShadowTable::EVENT_TORQUE | rh_p12_rn::ShadowTable::EVENT_MODE);
+      if (_result == COMM_SUCCESS)
+        g_shadow_table->markWritten(ADDR_GOAL_CURRENT, g_goal_current);
 
       gotoCursor(0, 0);
 #if defined(__linux__)
@@ -397,43 +615,24 @@ void checkValue()
   {
     if (g_curr_mode != MODE_CURRENT_CTRL)
     {
-      // auto repeat thread stop
-      if (g_curr_control == CTRL_REPEAT)
-      {
-        g_flag_repeat_thread = false;
-        g_repeat_thread->join();
-      }
-
-      // torque off
-      if (g_is_torque_on == true)
-        g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 0);
-
-#if defined(__linux__)
-      usleep(20 * 1000);
-#elif defined(_WIN32) || defined(_WIN64)
-      Sleep(20);
-#endif
-
-      // set mode to current control mode
-      g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_OPERATING_MODE, MODE_CURRENT_CTRL);
-
-#if defined(__linux__)
-      usleep(20 * 1000);
-#elif defined(_WIN32) || defined(_WIN64)
-      Sleep(20);
-#endif
-
-      // torque on
-      if (g_is_torque_on == true)
-        g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 1);
-
-      if (g_curr_control == CTRL_REPEAT)
+      // set mode to current control mode on the bus thread, between two
+      // repeat steps : the repeat loop keeps running and sends its next command in the new mode
+      g_bus->execute([](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
       {
-        g_flag_repeat_thread = true;
-        g_repeat_thread = new thread(&repeatThreadFunc, 1);
-      }
-
-      g_curr_mode = MODE_CURRENT_CTRL;
+        int _result = COMM_SUCCESS;
+        for (size_t i = 0; i < g_gripper_id_list.size(); i++)
+        {
+          int _gripper_result = rh_p12_rn::switchOperatingMode(ph, port, g_gripper_id_list[i], CONTROL_TABLE, MODE_CURRENT_CTRL,
+                                                               g_is_torque_on, rh_p12_rn::KEEP_GOAL_CURRENT);
+          if (_result == COMM_SUCCESS)
+            _result = _gripper_result;
+        }
+        g_curr_mode           = MODE_CURRENT_CTRL;
+        g_repeat_need_command = true;
+        g_repeat_has_state    = false;
+        return _result;
+      });
+      g_shadow_table->invalidateOn(rh_p12_rn::ShadowTable::EVENT_TORQUE | rh_p12_rn::ShadowTable::EVENT_MODE);
 
       gotoCursor(0, 0);
 #if defined(__linux__)
@@ -455,13 +654,13 @@ void checkValue()
     {
       printf(" ");
       g_is_torque_on = false;
-      g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 0);
+      writeTorqueEnable(0);
     }
     else
     {
       printf("V");
       g_is_torque_on = true;
-      g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 1);
+      writeTorqueEnable(1);
     }
   }
   else if (g_curr_row == ROW_CTRL_REPEAT)
@@ -471,8 +670,7 @@ void checkValue()
       printf(" ");
       g_curr_control = CTRL_NONE;
 
-      g_flag_repeat_thread = false;
-      g_repeat_thread->join();
+      stopRepeat();
     }
     else
     {
@@ -494,19 +692,17 @@ void checkValue()
         gotoCursor(ROW_TORQUE_ON_OFF, COL_CHECK);
         printf("V");
         g_is_torque_on = true;
-        g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 1);
+        writeTorqueEnable(1);
       }
 
-      g_flag_repeat_thread = true;
-      g_repeat_thread = new thread(&repeatThreadFunc, 1);
+      startRepeat();
     }
   }
   else if (g_curr_row == ROW_CTRL_CLOSE)
   {
     if (g_curr_control == CTRL_REPEAT)
     {
-      g_flag_repeat_thread = false;
-      g_repeat_thread->join();
+      stopRepeat();
     }
 
     if (g_curr_control == CTRL_CLOSE)
@@ -534,13 +730,13 @@ void checkValue()
         gotoCursor(ROW_TORQUE_ON_OFF, g_curr_col);
         printf("V");
         g_is_torque_on = true;
-        g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 1);
+        writeTorqueEnable(1);
       }
 
       if (g_curr_mode == MODE_POSITION_CTRL)
-        g_packet_handler->write4ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_POSITION, MAX_POSITION);
+        writeAllGrippers(ADDR_GOAL_POSITION, LEN_GOAL_POSITION, MAX_POSITION);
       else
-        g_packet_handler->write2ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_CURRENT, (g_goal_current < 0)? -g_goal_current:g_goal_current);
+        writeGoalCurrent((g_goal_current < 0)? -g_goal_current:g_goal_current);
 
       gotoCursor(g_curr_row, g_curr_col);
 #if defined(__linux__)
@@ -556,8 +752,7 @@ void checkValue()
   {
     if (g_curr_control == CTRL_REPEAT)
     {
-      g_flag_repeat_thread = false;
-      g_repeat_thread->join();
+      stopRepeat();
     }
 
     if (g_curr_control == CTRL_OPEN)
@@ -585,13 +780,13 @@ void checkValue()
         gotoCursor(ROW_TORQUE_ON_OFF, g_curr_col);
         printf("V");
         g_is_torque_on = true;
-        g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 1);
+        writeTorqueEnable(1);
       }
 
       if (g_curr_mode == MODE_POSITION_CTRL)
-        g_packet_handler->write4ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_POSITION, MIN_POSITION);
+        writeAllGrippers(ADDR_GOAL_POSITION, LEN_GOAL_POSITION, MIN_POSITION);
       else
-        g_packet_handler->write2ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_CURRENT, (g_goal_current < 0)? g_goal_current:-g_goal_current);
+        writeGoalCurrent((g_goal_current < 0)? g_goal_current:-g_goal_current);
 
       gotoCursor(g_curr_row, g_curr_col);
 #if defined(__linux__)
@@ -605,7 +800,7 @@ void checkValue()
   }
   else if (g_curr_row == ROW_CTRL_GOAL_POSITION)
   {
-    g_flag_repeat_thread = false;
+    stopRepeat();
 
     if (g_curr_control == CTRL_POSITION)
     {
@@ -633,10 +828,10 @@ void checkValue()
         gotoCursor(ROW_TORQUE_ON_OFF, g_curr_col);
         printf("V");
         g_is_torque_on = true;
-        g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 1);
+        writeTorqueEnable(1);
       }
 
-      g_packet_handler->write4ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_POSITION, g_goal_position);
+      writeAllGrippers(ADDR_GOAL_POSITION, LEN_GOAL_POSITION, g_goal_position);
       g_flag_goal_position = true;
     }
   }
@@ -655,7 +850,7 @@ void UpDownValue(int val)
       g_goal_position = MAX_POSITION;
 
     if (g_flag_goal_position == true)
-      g_packet_handler->write4ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_POSITION, g_goal_position);
+      g_setpoint_writer->set(ADDR_GOAL_POSITION, g_goal_position);
     printf("%4d", g_goal_position);
   }
   else if (g_curr_row == ROW_GOAL_VELOCITY)
@@ -666,7 +861,7 @@ void UpDownValue(int val)
     else if (g_goal_velocity > MAX_VELOCITY)
       g_goal_velocity = MAX_VELOCITY;
 
-    g_packet_handler->write4ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_VELOCITY, g_goal_velocity);
+    g_setpoint_writer->set(ADDR_GOAL_VELOCITY, g_goal_velocity);
     printf("%4d", g_goal_velocity);
   }
   else if (g_curr_row == ROW_GOAL_PWM)
@@ -677,7 +872,7 @@ void UpDownValue(int val)
     else if (g_goal_pwm > MAX_PWM)
       g_goal_pwm = MAX_PWM;
     
-    g_packet_handler->write2ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_PWM, g_goal_pwm);
+    g_setpoint_writer->set(ADDR_GOAL_PWM, g_goal_pwm);
     printf("%4d", g_goal_pwm);
   }
   else if (g_curr_row == ROW_GOAL_CURRENT)
@@ -699,7 +894,7 @@ void UpDownValue(int val)
         g_goal_current = MAX_CURRENT;
     }
 
-    g_packet_handler->write2ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_CURRENT, g_goal_current);
+    g_setpoint_writer->set(ADDR_GOAL_CURRENT, g_goal_current);
     printf("%4d", (short)g_goal_current);
   }
 
@@ -708,14 +903,25 @@ void UpDownValue(int val)
 
 void Terminate()
 {
-  g_packet_handler->write1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_TORQUE_ENABLE, 0);
+  g_setpoint_writer->stop();
+  stopRepeat();
+
+  writeAllGrippers(ADDR_TORQUE_ENABLE, 1, 0);
+  g_bus->stop();
+  rh_p12_rn::FlatPacketHandler::getInstance()->removePort(g_port_handler);
+  g_port_handler->closePort();
+
+  rh_p12_rn::ShadowTableStats _stats = g_shadow_table->getStats();
+  printf("\nShadow table : %llu reads served, %llu writes dropped, %llu bytes kept off the bus\n",
+         (unsigned long long)_stats.read_hit_count, (unsigned long long)_stats.write_elided_count,
+         (unsigned long long)_stats.saved_bytes);
 }
 
 
 int main(int argc, char* argv[])
 {
-  // Initialize Packethandler2 instance
-  g_packet_handler = dynamixel::PacketHandler::getPacketHandler(PROTOCOL_VERSION);
+  // Initialize the Protocol 2.0 packet handler, which builds its packets in per-port buffers
+  g_packet_handler = rh_p12_rn::FlatPacketHandler::getInstance();
 
 #if defined(__linux__)
   system("clear");
@@ -730,17 +936,50 @@ int main(int argc, char* argv[])
 
   char *devName = (char*)DEVICE_NAME;
 
-  if (argc == 2)
+  if (argc >= 2)
     devName = argv[1];
 
-  g_port_handler = dynamixel::PortHandler::getPortHandler(devName);
+  // "1,2,3" drives several grippers on one bus
+  if (argc >= 3)
+  {
+    for (char *_p = argv[2]; *_p != '\0'; )
+    {
+      char *_end;
+      long  _id = strtol(_p, &_end, 10);
+      if (_end == _p)
+        break;
+      if (_id >= 0 && _id < 253)
+        g_gripper_id_list.push_back((uint8_t)_id);
+      _p = (*_end == ',')? _end + 1 : _end;
+    }
+  }
+
+  int         _baudrate = BAUDRATE;
+  std::string _discovered_port;
+  if (strncmp(devName, DISCOVER_NAME, strlen(DISCOVER_NAME)) == 0)
+  {
+    if (discoverBus(devName, &_discovered_port, &_baudrate) == false)
+    {
+      printf("No %s found.\n", CONTROL_TABLE.name);
+      printf("Press any key to terminate...\n");
+      getch();
+      return 0;
+    }
+    devName = (char*)_discovered_port.c_str();
+  }
+  if (g_gripper_id_list.empty())
+    g_gripper_id_list.push_back(GRIPPER_ID);
+
+  // "sim", "sim:<id>" ... run against simulated grippers
+  g_port_handler = rh_p12_rn::getPortHandler(devName, CONTROL_TABLE);
 
   if (g_port_handler->openPort())
   {
     printf("Succeeded to open port.\n");
 
-    if (g_port_handler->setBaudRate(BAUDRATE))
+    if (g_port_handler->setBaudRate(_baudrate))
     {
+      setupBaudRate();
       printf("Succeeded to change the baudrate.\n");
       printf(" - Device Name : %s\n", devName);
       printf(" - Baudrate    : %d\n\n", g_port_handler->getBaudRate());
@@ -761,14 +1000,87 @@ int main(int argc, char* argv[])
     return 0;
   }
 
-  if (g_packet_handler->ping(g_port_handler, GRIPPER_ID) != COMM_SUCCESS)
+  // the port's packet buffers, allocated before the first transaction
+  if (rh_p12_rn::FlatPacketHandler::getInstance()->addPort(g_port_handler) == false)
   {
-    printf("Failed to connect the gripper (ID:%d).\n", GRIPPER_ID);
+    printf("Failed to allocate the packet buffers of the port.\n");
     printf("Press any key to terminate...\n");
     getch();
     return 0;
   }
 
+  // from here on every transaction goes through the bus thread
+  g_bus = new rh_p12_rn::BusOwner(g_packet_handler, g_port_handler);
+  // the repeat step waits on the bus thread, so the bus thread runs at the loop's priority
+  g_bus->setRealtimePriority(REPEAT_RT_PRIORITY);
+  g_bus->start();
+
+  g_repeat_loop = new rh_p12_rn::ControlLoop(REPEAT_PERIOD_USEC);
+  g_repeat_loop->setRealtimePriority(REPEAT_RT_PRIORITY);
+
+  for (size_t i = 0; i < g_gripper_id_list.size(); i++)
+  {
+    if (g_bus->ping(g_gripper_id_list[i]) != COMM_SUCCESS)
+    {
+      g_bus->stop();
+      printf("Failed to connect the gripper (ID:%d).\n", g_gripper_id_list[i]);
+      printf("Press any key to terminate...\n");
+      getch();
+      return 0;
+    }
+  }
+
+  g_grippers = new rh_p12_rn::GripperGroup(g_packet_handler, g_port_handler, CONTROL_TABLE);
+  for (size_t i = 0; i < g_gripper_id_list.size(); i++)
+    g_grippers->addGripper(g_gripper_id_list[i]);
+  g_repeat_detector_list.resize(g_gripper_id_list.size());
+  g_repeat_ended_list.assign(g_gripper_id_list.size(), false);
+
+  // goal current is also reversed by the repeat loop, and dropped on torque and mode changes
+  rh_p12_rn::ShadowTable::Policy _host_owned = { rh_p12_rn::ShadowTable::NO_MAX_AGE, rh_p12_rn::ShadowTable::EVENT_REBOOT };
+  rh_p12_rn::ShadowTable::Policy _mode_bound = { rh_p12_rn::ShadowTable::NO_MAX_AGE, rh_p12_rn::ShadowTable::EVENT_ALL };
+  g_shadow_table = new rh_p12_rn::ShadowTable();
+  g_shadow_table->addRegister(ADDR_GOAL_VELOCITY, LEN_GOAL_VELOCITY, _host_owned);
+  g_shadow_table->addRegister(ADDR_GOAL_PWM, LEN_GOAL_PWM, _host_owned);
+  g_shadow_table->addRegister(ADDR_GOAL_CURRENT, LEN_GOAL_CURRENT, _mode_bound);
+
+  g_setpoint_writer = new rh_p12_rn::SetpointWriter(g_bus, g_gripper_id_list, SETPOINT_INTERVAL_USEC);
+  g_setpoint_writer->setShadowTable(g_shadow_table);
+  g_setpoint_writer->addRegister(ADDR_GOAL_PWM, LEN_GOAL_PWM);
+  g_setpoint_writer->addRegister(ADDR_GOAL_CURRENT, LEN_GOAL_CURRENT, true);     // also written by open/close/repeat
+  g_setpoint_writer->addRegister(ADDR_GOAL_VELOCITY, LEN_GOAL_VELOCITY);
+  g_setpoint_writer->addRegister(ADDR_GOAL_POSITION, LEN_GOAL_POSITION, true);   // also written by open/close/repeat
+  g_setpoint_writer->start();
+
+  // mirror the hot registers into one contiguous indirect data window
+  g_indirect_map = new rh_p12_rn::IndirectMap(CONTROL_TABLE);
+  g_indirect_map->addParam(ADDR_MOVING, LEN_MOVING);
+  g_indirect_map->addParam(ADDR_GOAL_POSITION, LEN_GOAL_POSITION);
+  g_indirect_map->addParam(ADDR_GOAL_CURRENT, LEN_GOAL_CURRENT);
+  g_indirect_map->addParam(ADDR_PRESENT_POSITION, LEN_PRESENT_POSITION);
+  g_indirect_map->addParam(ADDR_PRESENT_CURRENT, LEN_PRESENT_CURRENT);
+  g_indirect_map->addParam(ADDR_PRESENT_TEMPERATURE, LEN_PRESENT_TEMPERATURE);
+
+  int _map_result = COMM_SUCCESS;
+  for (size_t i = 0; i < g_gripper_id_list.size() && _map_result == COMM_SUCCESS; i++)
+  {
+    _map_result = g_bus->execute([&](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                                 { return g_indirect_map->program(ph, port, g_gripper_id_list[i]); });
+  }
+
+  if (_map_result == COMM_SUCCESS)
+  {
+    g_grippers->setIndirectMap(g_indirect_map);
+    printf("Succeeded to map the hot registers to indirect data (%d bytes).\n", g_indirect_map->getDataLength());
+  }
+  else
+  {
+    // the indirect address table can only be changed with torque off
+    printf("Failed to map the indirect address. Registers are read directly.\n");
+    delete g_indirect_map;
+    g_indirect_map = NULL;
+  }
+
   printf("Press any key to continue...\n");
   getch();
 #if defined(__linux__)
@@ -778,11 +1090,11 @@ int main(int argc, char* argv[])
 #endif
 
   uint8_t _mode;
-  g_packet_handler->read1ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_OPERATING_MODE, &_mode);
+  g_bus->read1ByteTxRx(g_gripper_id_list[0], ADDR_OPERATING_MODE, &_mode);
   g_curr_mode = (MODE)_mode;
 
   if (g_curr_mode == MODE_POSITION_CTRL)
-    g_packet_handler->write2ByteTxRx(g_port_handler, GRIPPER_ID, ADDR_GOAL_CURRENT, g_goal_current);
+    writeGoalCurrent(g_goal_current);
   
   drawPage();
 
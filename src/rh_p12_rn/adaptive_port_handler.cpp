@@ -0,0 +1,258 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <algorithm>
+
+#include "rh_p12_rn/adaptive_port_handler.h"
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/protocol2.h"
+
+// samples between two percentile updates once the model is in use
+#define MODEL_UPDATE_INTERVAL   16
+
+namespace rh_p12_rn
+{
+
+AdaptivePortHandler::AdaptivePortHandler(dynamixel::PortHandler *port)
+  : port_(port),
+    model_index_(-1),
+    tx_start_nsec_(0),
+    tx_length_(0),
+    wire_nsec_(0),
+    deadline_nsec_(0),
+    rx_expected_(0),
+    rx_length_(0)
+{
+  is_using_ = false;
+}
+
+AdaptivePortHandler::~AdaptivePortHandler()
+{
+  delete port_;
+}
+
+bool AdaptivePortHandler::openPort()
+{
+  return port_->openPort();
+}
+
+void AdaptivePortHandler::closePort()
+{
+  port_->closePort();
+}
+
+void AdaptivePortHandler::clearPort()
+{
+  port_->clearPort();
+}
+
+void AdaptivePortHandler::setPortName(const char *port_name)
+{
+  port_->setPortName(port_name);
+}
+
+char *AdaptivePortHandler::getPortName()
+{
+  return port_->getPortName();
+}
+
+bool AdaptivePortHandler::setBaudRate(const int baudrate)
+{
+  return port_->setBaudRate(baudrate);
+}
+
+int AdaptivePortHandler::getBaudRate()
+{
+  return port_->getBaudRate();
+}
+
+int AdaptivePortHandler::getBytesAvailable()
+{
+  return port_->getBytesAvailable();
+}
+
+int AdaptivePortHandler::readPort(uint8_t *packet, int length)
+{
+  int _length = port_->readPort(packet, length);
+  if (_length <= 0 || rx_expected_ == 0)
+    return _length;
+
+  // the whole expected reply is in : one round trip measured
+  rx_length_ += _length;
+  if (rx_length_ >= rx_expected_ && model_index_ >= 0)
+  {
+    Model    &_model   = model_list_[model_index_];
+    uint64_t  _elapsed = getMonotonicTimeNsec() - tx_start_nsec_;
+    uint64_t  _delay   = (_elapsed > wire_nsec_)? _elapsed - wire_nsec_:0;
+
+    if (_model.is_probing && _delay > _model.timeout_usec * 1000ULL)
+    {
+      // the learned limit would have cut this reply off : learn the instruction again
+      _model.late_reply_count++;
+      _model.sample_list.clear();
+      _model.next         = 0;
+      _model.timeout_usec = 0;
+    }
+    _model.is_probing = false;
+    addSample(_model, _delay);
+    rx_expected_    = 0;
+    deadline_nsec_  = 0;
+  }
+  return _length;
+}
+
+int AdaptivePortHandler::writePort(uint8_t *packet, int length)
+{
+  uint8_t _instruction = 0;
+  if (length > P2_INSTRUCTION && packet[P2_HEADER0] == 0xFF && packet[P2_HEADER1] == 0xFF &&
+      packet[P2_HEADER2] == 0xFD && packet[P2_RESERVED] == 0x00)
+    _instruction = packet[P2_INSTRUCTION];
+
+  model_index_    = findModel(_instruction);
+  tx_start_nsec_  = getMonotonicTimeNsec();
+  tx_length_      = (length > 0)? length:0;
+  deadline_nsec_  = 0;
+  rx_expected_    = 0;
+  rx_length_      = 0;
+  return port_->writePort(packet, length);
+}
+
+void AdaptivePortHandler::setPacketTimeout(uint16_t packet_length)
+{
+  port_->setPacketTimeout(packet_length);
+
+  rx_expected_    = packet_length;
+  rx_length_      = 0;
+  wire_nsec_      = getByteTimeNsec() * (tx_length_ + packet_length);
+  deadline_nsec_  = 0;
+  if (model_index_ >= 0 && model_list_[model_index_].timeout_usec > 0 && model_list_[model_index_].is_probing == false)
+    deadline_nsec_ = tx_start_nsec_ + wire_nsec_ + model_list_[model_index_].timeout_usec * 1000ULL;
+}
+
+void AdaptivePortHandler::setPacketTimeout(double msec)
+{
+  // e.g. broadcast ping : the caller knows better, nothing is measured
+  port_->setPacketTimeout(msec);
+  rx_expected_    = 0;
+  deadline_nsec_  = 0;
+}
+
+bool AdaptivePortHandler::isPacketTimeout()
+{
+  if (port_->isPacketTimeout())
+  {
+    rx_expected_    = 0;
+    deadline_nsec_  = 0;
+    return true;
+  }
+
+  if (deadline_nsec_ == 0 || getMonotonicTimeNsec() <= deadline_nsec_)
+    return false;
+
+  model_list_[model_index_].timeout_count++;
+  model_list_[model_index_].is_probing = true;
+  rx_expected_    = 0;
+  deadline_nsec_  = 0;
+  return true;
+}
+
+int AdaptivePortHandler::findModel(uint8_t instruction)
+{
+  for (size_t i = 0; i < model_list_.size(); i++)
+  {
+    if (model_list_[i].instruction == instruction)
+      return (int)i;
+  }
+
+  Model _model;
+  _model.instruction      = instruction;
+  _model.next             = 0;
+  _model.sample_count     = 0;
+  _model.p50_usec         = 0;
+  _model.percentile_usec  = 0;
+  _model.timeout_usec     = 0;
+  _model.timeout_count    = 0;
+  _model.late_reply_count = 0;
+  _model.is_probing       = false;
+  _model.sample_list.reserve(param_.window);
+  model_list_.push_back(_model);
+  return (int)model_list_.size() - 1;
+}
+
+uint64_t AdaptivePortHandler::getByteTimeNsec()
+{
+  int _baudrate = port_->getBaudRate();
+
+  // 10 bits per byte : start, 8 data, stop
+  return (_baudrate > 0)? 10000000000ULL / _baudrate : 0;
+}
+
+void AdaptivePortHandler::addSample(Model &model, uint64_t delay_nsec)
+{
+  uint32_t _delay_usec = (uint32_t)std::min<uint64_t>(delay_nsec / 1000, UINT32_MAX);
+
+  if (model.sample_list.size() < param_.window)
+    model.sample_list.push_back(_delay_usec);
+  else if (param_.window > 0)
+    model.sample_list[model.next] = _delay_usec;
+  if (param_.window > 0)
+    model.next = (model.next + 1) % param_.window;
+  model.sample_count++;
+
+  if (model.sample_list.empty() || model.sample_list.size() < param_.min_samples ||
+      (model.timeout_usec > 0 && model.sample_count % MODEL_UPDATE_INTERVAL != 0))
+    return;
+
+  std::vector<uint32_t> _sorted(model.sample_list);
+  size_t _p50_index         = (_sorted.size() - 1) / 2;
+  size_t _percentile_index  = (size_t)(param_.percentile / 100.0 * (_sorted.size() - 1) + 0.5);
+  std::nth_element(_sorted.begin(), _sorted.begin() + _percentile_index, _sorted.end());
+  model.percentile_usec = _sorted[_percentile_index];
+  std::nth_element(_sorted.begin(), _sorted.begin() + _p50_index, _sorted.begin() + _percentile_index);
+  model.p50_usec        = _sorted[_p50_index];
+  model.timeout_usec    = (uint32_t)(model.percentile_usec * param_.factor) + param_.margin_usec;
+}
+
+std::vector<AdaptiveTimeoutModel> AdaptivePortHandler::getModel() const
+{
+  std::vector<AdaptiveTimeoutModel> _list;
+
+  for (size_t i = 0; i < model_list_.size(); i++)
+  {
+    const Model &_model = model_list_[i];
+    AdaptiveTimeoutModel _entry;
+    _entry.instruction      = _model.instruction;
+    _entry.sample_count     = _model.sample_count;
+    _entry.p50_usec         = _model.p50_usec;
+    _entry.percentile_usec  = _model.percentile_usec;
+    _entry.timeout_usec     = _model.timeout_usec;
+    _entry.timeout_count    = _model.timeout_count;
+    _entry.late_reply_count = _model.late_reply_count;
+    _list.push_back(_entry);
+  }
+  return _list;
+}
+
+void AdaptivePortHandler::resetModel()
+{
+  model_list_.clear();
+  model_index_    = -1;
+  deadline_nsec_  = 0;
+  rx_expected_    = 0;
+}
+
+}
@@ -0,0 +1,333 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include "rh_p12_rn/baud_rate.h"
+#include "rh_p12_rn/protocol2.h"
+
+namespace rh_p12_rn
+{
+
+static const int BAUD_RATE_OF_VALUE[BAUD_RATE_VALUE_COUNT] =
+  { 9600, 57600, 115200, 1000000, 2000000, 3000000, 4000000, 4500000 };
+
+int getBaudRateOfValue(uint8_t baud_rate_value)
+{
+  if (baud_rate_value >= BAUD_RATE_VALUE_COUNT)
+    return 0;
+  return BAUD_RATE_OF_VALUE[baud_rate_value];
+}
+
+int getBaudRateValue(int baudrate)
+{
+  for (int i = 0; i < BAUD_RATE_VALUE_COUNT; i++)
+  {
+    if (BAUD_RATE_OF_VALUE[i] == baudrate)
+      return i;
+  }
+  return -1;
+}
+
+std::vector<int> getBaudRateList()
+{
+  return std::vector<int>(std::reverse_iterator<const int *>(BAUD_RATE_OF_VALUE + BAUD_RATE_VALUE_COUNT),
+                          std::reverse_iterator<const int *>(BAUD_RATE_OF_VALUE));
+}
+
+BaudRateParam::BaudRateParam()
+  : test_count(100),
+    max_error_rate(0.01),
+    write_retry(3)
+{
+}
+
+int findBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                 const std::vector<int> &candidate_list, int *baudrate)
+{
+  int _start = port->getBaudRate();
+
+  std::vector<int> _list(1, _start);
+  for (size_t i = 0; i < candidate_list.size(); i++)
+  {
+    if (std::find(_list.begin(), _list.end(), candidate_list[i]) == _list.end())
+      _list.push_back(candidate_list[i]);
+  }
+
+  for (size_t i = 0; i < _list.size(); i++)
+  {
+    if (_list[i] != port->getBaudRate() && port->setBaudRate(_list[i]) == false)
+      continue;
+
+    uint16_t _model_number = 0;
+    if (ph->ping(port, id, &_model_number) == COMM_SUCCESS)
+    {
+      *baudrate = _list[i];
+      return COMM_SUCCESS;
+    }
+  }
+
+  port->setBaudRate(_start);
+  return COMM_RX_TIMEOUT;
+}
+
+// repeats a transaction that failed to communicate; a device error is not repeated
+static int retry(uint32_t count, const std::function<int(uint8_t *)> &transaction)
+{
+  int _result = COMM_TX_FAIL;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint8_t _error = 0;
+    _result = transaction(&_error);
+    if (_result == COMM_SUCCESS)
+      return ((_error & ~P2_ERRBIT_ALERT) == 0)? COMM_SUCCESS : COMM_RX_CORRUPT;
+  }
+  return _result;
+}
+
+// writes the Baud Rate of grippers already listening at the port rate back to value
+static void restoreBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port,
+                            const std::vector<uint8_t> &id_list, uint8_t value, const BaudRateParam &param)
+{
+  for (size_t i = 0; i < id_list.size(); i++)
+  {
+    retry(param.write_retry, [&](uint8_t *error)
+      { return ph->write1ByteTxRx(port, id_list[i], ADDR_BAUD_RATE, value, error); });
+  }
+}
+
+int changeBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table,
+                   const std::vector<uint8_t> &id_list, int baudrate, const BaudRateParam &param)
+{
+  int _from       = port->getBaudRate();
+  int _value      = getBaudRateValue(baudrate);
+  int _from_value = getBaudRateValue(_from);
+  if (_value < 0 || _from_value < 0)
+    return COMM_NOT_AVAILABLE;
+  if (baudrate == _from)
+    return COMM_SUCCESS;
+
+  // the adapter may not reach the rate with its clock
+  bool _is_supported = port->setBaudRate(baudrate);
+  port->setBaudRate(_from);
+  if (_is_supported == false)
+    return COMM_NOT_AVAILABLE;
+
+  // Baud Rate is in the EEPROM area, which is locked while torque is on
+  for (size_t i = 0; i < id_list.size(); i++)
+  {
+    uint8_t _torque = 0;
+    int _result = retry(param.write_retry, [&](uint8_t *error)
+      { return ph->read1ByteTxRx(port, id_list[i], table.addr_torque_enable, &_torque, error); });
+    if (_result != COMM_SUCCESS)
+      return _result;
+    if (_torque != 0)
+      return COMM_NOT_AVAILABLE;
+  }
+
+  // a gripper whose status packet was lost may have moved as well, so it counts as moved
+  std::vector<uint8_t> _moved_list;
+  int _result = COMM_SUCCESS;
+  for (size_t i = 0; i < id_list.size() && _result == COMM_SUCCESS; i++)
+  {
+    _moved_list.push_back(id_list[i]);
+    for (uint32_t n = 0; n < param.write_retry; n++)
+    {
+      uint8_t _error = 0;
+      _result = ph->write1ByteTxRx(port, id_list[i], ADDR_BAUD_RATE, (uint8_t)_value, &_error);
+      if (_result == COMM_SUCCESS)
+      {
+        if ((_error & ~P2_ERRBIT_ALERT) != 0)
+          _result = COMM_RX_CORRUPT;
+        break;
+      }
+
+      // written again only while it still answers at the old rate; otherwise the ping
+      // at the new rate tells whether the write took effect
+      uint16_t _model_number = 0;
+      if (ph->ping(port, id_list[i], &_model_number) != COMM_SUCCESS)
+      {
+        _result = COMM_SUCCESS;
+        break;
+      }
+    }
+  }
+
+  port->setBaudRate(baudrate);
+  for (size_t i = 0; i < id_list.size() && _result == COMM_SUCCESS; i++)
+  {
+    uint16_t _model_number = 0;
+    _result = retry(param.write_retry, [&](uint8_t *error)
+      { return ph->ping(port, id_list[i], &_model_number, error); });
+  }
+
+  if (_result != COMM_SUCCESS)
+  {
+    restoreBaudRate(ph, port, _moved_list, (uint8_t)_from_value, param);
+    port->setBaudRate(_from);
+  }
+  return _result;
+}
+
+uint32_t testBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table,
+                      const std::vector<uint8_t> &id_list, const BaudRateParam &param)
+{
+  uint32_t _error_count = 0;
+  for (uint32_t n = 0; n < param.test_count; n++)
+  {
+    for (size_t i = 0; i < id_list.size(); i++)
+    {
+      uint32_t _position = 0;
+      if (ph->read4ByteTxRx(port, id_list[i], table.addr_present_position, &_position) != COMM_SUCCESS)
+        _error_count++;
+    }
+  }
+  return _error_count;
+}
+
+// changes to baudrate and runs the error-rate test there
+static int tryBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table,
+                       const std::vector<uint8_t> &id_list, int baudrate, const BaudRateParam &param,
+                       BaudRateReport *report, bool *is_passed)
+{
+  *is_passed = false;
+
+  int _result = changeBaudRate(ph, port, table, id_list, baudrate, param);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  report->tried_count++;
+  report->baudrate          = baudrate;
+  report->test_read_count   = param.test_count * (uint32_t)id_list.size();
+  report->test_error_count  = testBaudRate(ph, port, table, id_list, param);
+  *is_passed = (report->test_error_count <= param.max_error_rate * report->test_read_count);
+  return COMM_SUCCESS;
+}
+
+static void initReport(dynamixel::PortHandler *port, BaudRateReport *report)
+{
+  memset(report, 0, sizeof(BaudRateReport));
+  report->from_baudrate = port->getBaudRate();
+  report->baudrate      = report->from_baudrate;
+}
+
+int raiseBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table,
+                  const std::vector<uint8_t> &id_list, const std::vector<int> &candidate_list,
+                  const BaudRateParam &param, BaudRateReport *report)
+{
+  BaudRateReport _report;
+  if (report == 0)
+    report = &_report;
+  initReport(port, report);
+
+  int _from = report->from_baudrate;
+  std::vector<int> _list = candidate_list;
+  std::sort(_list.begin(), _list.end(), std::greater<int>());
+
+  for (size_t i = 0; i < _list.size() && _list[i] > _from; i++)
+  {
+    bool _is_passed = false;
+    int _result = tryBaudRate(ph, port, table, id_list, _list[i], param, report, &_is_passed);
+    if (_result != COMM_SUCCESS)
+      continue;   // torque on, a rate the adapter lacks or no answer : changeBaudRate() stayed at _from
+    if (_is_passed)
+      return COMM_SUCCESS;
+
+    // the rate just failed the test, so the way back may take more than one attempt
+    for (uint32_t n = 0; n < param.write_retry; n++)
+    {
+      _result = changeBaudRate(ph, port, table, id_list, _from, param);
+      if (_result == COMM_SUCCESS || _result == COMM_NOT_AVAILABLE)
+        break;
+    }
+    report->baudrate = port->getBaudRate();
+    if (_result != COMM_SUCCESS)
+      return _result;
+  }
+  return COMM_SUCCESS;
+}
+
+int lowerBaudRate(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table,
+                  const std::vector<uint8_t> &id_list, const std::vector<int> &candidate_list,
+                  const BaudRateParam &param, BaudRateReport *report)
+{
+  BaudRateReport _report;
+  if (report == 0)
+    report = &_report;
+  initReport(port, report);
+
+  std::vector<int> _list = candidate_list;
+  std::sort(_list.begin(), _list.end(), std::greater<int>());
+
+  int _result = COMM_RX_CORRUPT;
+  for (size_t i = 0; i < _list.size(); i++)
+  {
+    if (_list[i] >= port->getBaudRate())
+      continue;
+
+    bool _is_passed = false;
+    _result = tryBaudRate(ph, port, table, id_list, _list[i], param, report, &_is_passed);
+    if (_result == COMM_SUCCESS && _is_passed)
+      return COMM_SUCCESS;
+    if (_result == COMM_SUCCESS)
+      _result = COMM_RX_CORRUPT;
+  }
+  return _result;
+}
+
+BaudRateMonitor::BaudRateMonitor(uint32_t window, double max_error_rate)
+  : result_list_(window, false),
+    window_(window),
+    max_error_rate_(max_error_rate),
+    next_(0),
+    count_(0),
+    error_count_(0),
+    is_tripped_(false)
+{
+}
+
+bool BaudRateMonitor::add(int result)
+{
+  bool _is_error = (result != COMM_SUCCESS);
+
+  if (count_ == window_ && result_list_[next_])
+    error_count_--;
+  if (_is_error)
+    error_count_++;
+  result_list_[next_] = _is_error;
+
+  next_ = (next_ + 1) % window_;
+  if (count_ < window_)
+    count_++;
+
+  // a full window before judging, so one early timeout does not trip it
+  if (count_ == window_ && error_count_ > max_error_rate_ * window_)
+    is_tripped_ = true;
+  return is_tripped_;
+}
+
+void BaudRateMonitor::reset()
+{
+  std::fill(result_list_.begin(), result_list_.end(), false);
+  next_         = 0;
+  count_        = 0;
+  error_count_  = 0;
+  is_tripped_   = false;
+}
+
+}
@@ -0,0 +1,174 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <future>
+
+#include "rh_p12_rn/bus_manager.h"
+#include "rh_p12_rn/clock.h"
+
+namespace rh_p12_rn
+{
+
+BusManager::BusManager(dynamixel::PacketHandler *ph, const ControlTable &table)
+  : ph_(ph),
+    table_(table),
+    is_started_(false)
+{ }
+
+BusManager::~BusManager()
+{
+  stop();
+  for (size_t i = 0; i < port_list_.size(); i++)
+  {
+    delete port_list_[i].group;
+    delete port_list_[i].owner;
+    port_list_[i].port->closePort();
+    delete port_list_[i].port;
+  }
+}
+
+size_t BusManager::addPort(dynamixel::PortHandler *port, int cpu)
+{
+  Port _port;
+  _port.port            = port;
+  _port.owner           = new BusOwner(ph_, port);
+  _port.group           = new GripperGroup(ph_, port, table_);
+  _port.first_telemetry = telemetry_list_.size();
+  _port.owner->setCpuAffinity(cpu);
+
+  port_list_.push_back(_port);
+  return port_list_.size() - 1;
+}
+
+bool BusManager::addGripper(size_t port, uint8_t id)
+{
+  if (port >= port_list_.size() || port_list_[port].group->addGripper(id) == false)
+    return false;
+
+  GripperTelemetry _telemetry;
+  _telemetry.port       = port;
+  _telemetry.id         = id;
+  _telemetry.state      = MotionState();
+  _telemetry.result     = COMM_NOT_AVAILABLE;
+  _telemetry.time_usec  = 0;
+
+  // keep the table port by port : the grippers of the later ports move up by one
+  size_t _index = port_list_[port].first_telemetry + port_list_[port].group->getGripperCount() - 1;
+  telemetry_list_.insert(telemetry_list_.begin() + _index, _telemetry);
+  for (size_t i = port + 1; i < port_list_.size(); i++)
+    port_list_[i].first_telemetry++;
+  return true;
+}
+
+void BusManager::start()
+{
+  for (size_t i = 0; i < port_list_.size(); i++)
+    port_list_[i].owner->start();
+  is_started_ = true;
+}
+
+void BusManager::stop()
+{
+  if (is_started_ == false)
+    return;
+
+  for (size_t i = 0; i < port_list_.size(); i++)
+    port_list_[i].owner->stop();
+  is_started_ = false;
+}
+
+int BusManager::execute(size_t port, const BusOwner::Transaction &transaction)
+{
+  if (port >= port_list_.size())
+    return COMM_NOT_AVAILABLE;
+
+  return port_list_[port].owner->execute(transaction);
+}
+
+int BusManager::write(size_t port, uint8_t id, uint16_t address, uint16_t length, uint32_t value)
+{
+  if (port >= port_list_.size())
+    return COMM_NOT_AVAILABLE;
+
+  BusOwner *_owner = port_list_[port].owner;
+  switch (length)
+  {
+    case 1:   return _owner->write1ByteTxRx(id, address, (uint8_t)value);
+    case 2:   return _owner->write2ByteTxRx(id, address, (uint16_t)value);
+    case 4:   return _owner->write4ByteTxRx(id, address, value);
+    default:  return COMM_NOT_AVAILABLE;
+  }
+}
+
+int BusManager::readTelemetry()
+{
+  std::vector<std::future<int> > _future_list;
+  _future_list.reserve(port_list_.size());
+
+  // every bus thread reads its own port, in parallel
+  for (size_t i = 0; i < port_list_.size(); i++)
+  {
+    const Port &_port = port_list_[i];
+    if (_port.group->getGripperCount() == 0)
+      continue;
+
+    _future_list.push_back(_port.owner->submit(
+        [this, _port](dynamixel::PacketHandler *, dynamixel::PortHandler *)
+        {
+          int       _result = _port.group->readMotionState();
+          uint64_t  _now    = getMonotonicTimeUsec();
+
+          std::lock_guard<std::mutex> _lock(telemetry_mutex_);
+          for (size_t g = 0; g < _port.group->getGripperCount(); g++)
+          {
+            GripperTelemetry &_telemetry = telemetry_list_[_port.first_telemetry + g];
+            _telemetry.result = _result;
+            if (_result == COMM_SUCCESS)
+            {
+              _telemetry.state      = _port.group->getMotionState(g);
+              _telemetry.time_usec  = _now;
+            }
+          }
+          return _result;
+        }));
+  }
+
+  int _result = COMM_SUCCESS;
+  for (size_t i = 0; i < _future_list.size(); i++)
+  {
+    int _port_result = _future_list[i].get();
+    if (_result == COMM_SUCCESS)
+      _result = _port_result;
+  }
+  return _result;
+}
+
+std::vector<GripperTelemetry> BusManager::getTelemetry()
+{
+  std::lock_guard<std::mutex> _lock(telemetry_mutex_);
+  return telemetry_list_;
+}
+
+uint64_t BusManager::getCompletedCount() const
+{
+  uint64_t _count = 0;
+  for (size_t i = 0; i < port_list_.size(); i++)
+    _count += port_list_[i].owner->getCompletedCount();
+  return _count;
+}
+
+}
@@ -0,0 +1,244 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#endif
+
+#include <memory>
+
+#include "rh_p12_rn/bus_owner.h"
+
+namespace rh_p12_rn
+{
+
+// polls of an empty queue before the bus thread goes to sleep
+static const int SPIN_COUNT = 256;
+
+BusOwner::BusOwner(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+  : ph_(ph),
+    port_(port),
+    thread_(NULL),
+    cpu_(-1),
+    priority_(0),
+    lock_memory_(false),
+    is_cpu_pinned_(false),
+    is_realtime_(false),
+    is_memory_locked_(false),
+    is_running_(false),
+    is_sleeping_(false),
+    post_count_(0),
+    completed_count_(0)
+{ }
+
+void BusOwner::start()
+{
+  if (thread_ != NULL)
+    return;
+
+#if defined(__linux__)
+  if (lock_memory_)
+    is_memory_locked_ = (mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+#endif
+
+  is_running_ = true;
+  thread_     = new std::thread(&BusOwner::run, this);
+  thread_id_  = thread_->get_id();
+}
+
+void BusOwner::stop()
+{
+  if (thread_ == NULL)
+    return;
+
+  is_running_ = false;
+
+  // a post() that saw is_running_ before it was cleared finishes its push first,
+  // so no request can be linked after the drain below
+  while (post_count_.load() != 0)
+    std::this_thread::yield();
+
+  wake();
+  thread_->join();
+  delete thread_;
+  thread_ = NULL;
+
+  // late arrivals : fail them instead of leaking them
+  Request *_request;
+  while ((_request = queue_.pop()) != NULL)
+  {
+    if (_request->callback)
+      _request->callback(COMM_PORT_BUSY);
+    delete _request;
+  }
+}
+
+void BusOwner::wake()
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+  cond_.notify_one();
+}
+
+void BusOwner::run()
+{
+#if defined(__linux__)
+  if (priority_ > 0)
+  {
+    struct sched_param _param;
+    memset(&_param, 0, sizeof(_param));
+    _param.sched_priority = priority_;
+    is_realtime_ = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &_param) == 0);
+  }
+
+  if (cpu_ >= 0)
+  {
+    cpu_set_t _set;
+    CPU_ZERO(&_set);
+    CPU_SET(cpu_, &_set);
+    is_cpu_pinned_ = (pthread_setaffinity_np(pthread_self(), sizeof(_set), &_set) == 0);
+  }
+#endif
+
+  while (true)
+  {
+    Request *_request = queue_.pop();
+    if (_request != NULL)
+    {
+      int _result = _request->transaction(ph_, port_);
+      if (_request->callback)
+        _request->callback(_result);
+      delete _request;
+      completed_count_++;
+      continue;
+    }
+
+    if (is_running_ == false)
+      break;
+
+    bool _is_empty = true;
+    for (int i = 0; i < SPIN_COUNT && _is_empty; i++)
+    {
+      std::this_thread::yield();
+      _is_empty = queue_.isEmpty();
+    }
+    if (_is_empty == false)
+      continue;
+
+    // sleep : a producer that sees is_sleeping_ after linking its request wakes us
+    std::unique_lock<std::mutex> _lock(mutex_);
+    is_sleeping_.store(true, std::memory_order_seq_cst);
+    if (queue_.isEmpty() && is_running_)
+      cond_.wait_for(_lock, std::chrono::milliseconds(10));
+    is_sleeping_.store(false, std::memory_order_relaxed);
+  }
+}
+
+void BusOwner::post(const Transaction &transaction, const Callback &callback)
+{
+  post_count_.fetch_add(1);
+  if (is_running_ == false)
+  {
+    post_count_.fetch_sub(1);
+    if (callback)
+      callback(COMM_PORT_BUSY);
+    return;
+  }
+
+  Request *_request     = new Request;
+  _request->transaction = transaction;
+  _request->callback    = callback;
+  queue_.push(_request);
+
+  if (is_sleeping_.load(std::memory_order_seq_cst))
+    wake();
+  post_count_.fetch_sub(1);
+}
+
+std::future<int> BusOwner::submit(const Transaction &transaction)
+{
+  std::shared_ptr<std::promise<int> > _promise(new std::promise<int>());
+  std::future<int> _future = _promise->get_future();
+
+  post(transaction, [_promise](int result) { _promise->set_value(result); });
+  return _future;
+}
+
+int BusOwner::execute(const Transaction &transaction)
+{
+  if (thread_ != NULL && std::this_thread::get_id() == thread_id_)
+    return transaction(ph_, port_);
+
+  return submit(transaction).get();
+}
+
+int BusOwner::ping(uint8_t id, uint8_t *error)
+{
+  return execute([=](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                 { return ph->ping(port, id, error); });
+}
+
+int BusOwner::readTxRx(uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error)
+{
+  return execute([=](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                 { return ph->readTxRx(port, id, address, length, data, error); });
+}
+
+int BusOwner::read1ByteTxRx(uint8_t id, uint16_t address, uint8_t *data, uint8_t *error)
+{
+  return execute([=](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                 { return ph->read1ByteTxRx(port, id, address, data, error); });
+}
+
+int BusOwner::read2ByteTxRx(uint8_t id, uint16_t address, uint16_t *data, uint8_t *error)
+{
+  return execute([=](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                 { return ph->read2ByteTxRx(port, id, address, data, error); });
+}
+
+int BusOwner::read4ByteTxRx(uint8_t id, uint16_t address, uint32_t *data, uint8_t *error)
+{
+  return execute([=](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                 { return ph->read4ByteTxRx(port, id, address, data, error); });
+}
+
+int BusOwner::writeTxRx(uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error)
+{
+  return execute([=](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                 { return ph->writeTxRx(port, id, address, length, data, error); });
+}
+
+int BusOwner::write1ByteTxRx(uint8_t id, uint16_t address, uint8_t data, uint8_t *error)
+{
+  return execute([=](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                 { return ph->write1ByteTxRx(port, id, address, data, error); });
+}
+
+int BusOwner::write2ByteTxRx(uint8_t id, uint16_t address, uint16_t data, uint8_t *error)
+{
+  return execute([=](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                 { return ph->write2ByteTxRx(port, id, address, data, error); });
+}
+
+int BusOwner::write4ByteTxRx(uint8_t id, uint16_t address, uint32_t data, uint8_t *error)
+{
+  return execute([=](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+                 { return ph->write4ByteTxRx(port, id, address, data, error); });
+}
+
+}
@@ -0,0 +1,227 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#endif
+
+#include <string.h>
+#include <chrono>
+
+#include "rh_p12_rn/control_loop.h"
+
+namespace rh_p12_rn
+{
+
+#if defined(__linux__)
+static uint64_t toNsec(const struct timespec &ts)
+{
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static struct timespec toTimespec(uint64_t nsec)
+{
+  struct timespec _ts;
+  _ts.tv_sec  = nsec / 1000000000ULL;
+  _ts.tv_nsec = nsec % 1000000000ULL;
+  return _ts;
+}
+#endif
+
+static uint64_t getLoopTime()
+{
+#if defined(__linux__)
+  struct timespec _ts;
+  clock_gettime(CLOCK_MONOTONIC, &_ts);
+  return toNsec(_ts);
+#else
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static void sleepUntil(uint64_t deadline_nsec)
+{
+#if defined(__linux__)
+  struct timespec _ts = toTimespec(deadline_nsec);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &_ts, NULL) != 0)
+  {
+    // EINTR : sleep again towards the same deadline
+  }
+#else
+  std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline_nsec)));
+#endif
+}
+
+ControlLoop::ControlLoop(uint32_t period_usec)
+  : period_nsec_((uint64_t)period_usec * 1000),
+    priority_(0),
+    cpu_(-1),
+    lock_memory_(false),
+    thread_(NULL),
+    is_running_(false),
+    jitter_sum_(0)
+{
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+bool ControlLoop::start(const Step &step)
+{
+  if (thread_ != NULL)
+    return false;
+
+  bool _is_memory_locked = false;
+#if defined(__linux__)
+  if (lock_memory_)
+    _is_memory_locked = (mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+#endif
+
+  resetStats();
+  {
+    std::lock_guard<std::mutex> _lock(stats_mutex_);
+    stats_.is_memory_locked = _is_memory_locked;
+  }
+
+  step_       = step;
+  is_running_ = true;
+  thread_     = new std::thread(&ControlLoop::run, this);
+  return true;
+}
+
+void ControlLoop::stop()
+{
+  if (thread_ == NULL)
+    return;
+
+  is_running_ = false;
+  thread_->join();
+  delete thread_;
+  thread_ = NULL;
+}
+
+void ControlLoop::applyThreadSettings()
+{
+  bool _is_realtime   = false;
+  bool _is_cpu_pinned = false;
+
+#if defined(__linux__)
+  if (priority_ > 0)
+  {
+    struct sched_param _param;
+    memset(&_param, 0, sizeof(_param));
+    _param.sched_priority = priority_;
+    _is_realtime = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &_param) == 0);
+  }
+
+  if (cpu_ >= 0)
+  {
+    cpu_set_t _set;
+    CPU_ZERO(&_set);
+    CPU_SET(cpu_, &_set);
+    _is_cpu_pinned = (pthread_setaffinity_np(pthread_self(), sizeof(_set), &_set) == 0);
+  }
+#endif
+
+  std::lock_guard<std::mutex> _lock(stats_mutex_);
+  stats_.is_realtime    = _is_realtime;
+  stats_.is_cpu_pinned  = _is_cpu_pinned;
+}
+
+void ControlLoop::run()
+{
+  applyThreadSettings();
+
+  uint64_t _deadline = getLoopTime();
+
+  while (is_running_)
+  {
+    _deadline += period_nsec_;
+    sleepUntil(_deadline);
+
+    uint64_t _wake    = getLoopTime();
+    int64_t  _jitter  = (int64_t)(_wake - _deadline);
+
+    step_();
+    uint64_t _done    = getLoopTime();
+
+    // skip the deadlines the step has already run past
+    uint64_t _missed  = 0;
+    while (_deadline + period_nsec_ <= _done)
+    {
+      _deadline += period_nsec_;
+      _missed++;
+    }
+
+    record(_jitter, _done - _wake, _missed);
+  }
+}
+
+void ControlLoop::record(int64_t jitter_nsec, uint64_t step_nsec, uint64_t missed)
+{
+  std::lock_guard<std::mutex> _lock(stats_mutex_);
+
+  stats_.cycle_count++;
+  if (missed > 0)
+  {
+    stats_.overrun_count++;
+    stats_.missed_count += missed;
+  }
+
+  if (stats_.cycle_count == 1 || jitter_nsec < stats_.min_jitter_nsec)
+    stats_.min_jitter_nsec = jitter_nsec;
+  if (stats_.cycle_count == 1 || jitter_nsec > stats_.max_jitter_nsec)
+    stats_.max_jitter_nsec = jitter_nsec;
+  jitter_sum_ += jitter_nsec;
+  stats_.mean_jitter_nsec = jitter_sum_ / stats_.cycle_count;
+
+  if (step_nsec > stats_.max_step_nsec)
+    stats_.max_step_nsec = step_nsec;
+
+  int _bucket = 0;
+  uint64_t _usec = (jitter_nsec > 0)? (uint64_t)jitter_nsec / 1000 : 0;
+  while (_bucket < JITTER_HISTOGRAM_SIZE - 1 && _usec >= (1ULL << _bucket))
+    _bucket++;
+  stats_.jitter_histogram[_bucket]++;
+}
+
+ControlLoopStats ControlLoop::getStats()
+{
+  std::lock_guard<std::mutex> _lock(stats_mutex_);
+  return stats_;
+}
+
+void ControlLoop::resetStats()
+{
+  std::lock_guard<std::mutex> _lock(stats_mutex_);
+  bool _is_realtime       = stats_.is_realtime;
+  bool _is_cpu_pinned     = stats_.is_cpu_pinned;
+  bool _is_memory_locked  = stats_.is_memory_locked;
+
+  memset(&stats_, 0, sizeof(stats_));
+  jitter_sum_ = 0;
+
+  if (thread_ != NULL)
+  {
+    stats_.is_realtime      = _is_realtime;
+    stats_.is_cpu_pinned    = _is_cpu_pinned;
+    stats_.is_memory_locked = _is_memory_locked;
+  }
+}
+
+}
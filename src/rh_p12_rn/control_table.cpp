@@ -0,0 +1,86 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <stddef.h>
+#include "rh_p12_rn/control_table.h"
+
+namespace rh_p12_rn
+{
+
+const ControlTable CONTROL_TABLE_RH_P12_RN =
+{
+  "RH-P12-RN",
+  35073,      // model number
+
+  11,         // operating mode
+  49,         // indirect address 1
+  634,        // indirect data 1
+  256,        // indirect slots
+  562,        // torque enable
+  ADDR_NONE,  // goal PWM
+  604,        // goal current
+  600,        // goal velocity
+  606,        // goal acceleration
+  596,        // goal position
+  610,        // moving
+  611,        // present position
+  615,        // present velocity
+  621,        // present current
+  623,        // present input voltage
+  625,        // present temperature
+
+  0,          // min position
+  1150,       // max position
+  820         // max current
+};
+
+const ControlTable CONTROL_TABLE_RH_P12_RNA =
+{
+  "RH-P12-RN(A)",
+  35074,      // model number
+
+  11,         // operating mode
+  168,        // indirect address 1
+  634,        // indirect data 1
+  128,        // indirect slots
+  512,        // torque enable
+  548,        // goal PWM
+  550,        // goal current
+  552,        // goal velocity
+  556,        // profile acceleration
+  564,        // goal position
+  570,        // moving
+  580,        // present position
+  576,        // present velocity
+  574,        // present current
+  592,        // present input voltage
+  594,        // present temperature
+
+  0,          // min position
+  1150,       // max position
+  1984        // max current
+};
+
+const ControlTable *findControlTable(uint16_t model_number)
+{
+  if (model_number == CONTROL_TABLE_RH_P12_RN.model_number)
+    return &CONTROL_TABLE_RH_P12_RN;
+  if (model_number == CONTROL_TABLE_RH_P12_RNA.model_number)
+    return &CONTROL_TABLE_RH_P12_RNA;
+  return NULL;
+}
+
+}
@@ -0,0 +1,303 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+
+#include <string.h>
+
+#include "rh_p12_rn/crc16.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CRC_HAS_CLMUL
+#define CRC_CLMUL_TARGET        __attribute__((target("pclmul,ssse3")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#define CRC_HAS_CLMUL
+#define CRC_CLMUL_TARGET
+#endif
+
+#define CRC_POLYNOMIAL          0x18005   // x^16 + x^15 + x^2 + 1
+
+namespace rh_p12_rn
+{
+
+static const uint16_t CRC_TABLE[256] =
+{
+  0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011,
+  0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027, 0x0022,
+  0x8063, 0x0066, 0x006C, 0x8069, 0x0078, 0x807D, 0x8077, 0x0072,
+  0x0050, 0x8055, 0x805F, 0x005A, 0x804B, 0x004E, 0x0044, 0x8041,
+  0x80C3, 0x00C6, 0x00CC, 0x80C9, 0x00D8, 0x80DD, 0x80D7, 0x00D2,
+  0x00F0, 0x80F5, 0x80FF, 0x00FA, 0x80EB, 0x00EE, 0x00E4, 0x80E1,
+  0x00A0, 0x80A5, 0x80AF, 0x00AA, 0x80BB, 0x00BE, 0x00B4, 0x80B1,
+  0x8093, 0x0096, 0x009C, 0x8099, 0x0088, 0x808D, 0x8087, 0x0082,
+  0x8183, 0x0186, 0x018C, 0x8189, 0x0198, 0x819D, 0x8197, 0x0192,
+  0x01B0, 0x81B5, 0x81BF, 0x01BA, 0x81AB, 0x01AE, 0x01A4, 0x81A1,
+  0x01E0, 0x81E5, 0x81EF, 0x01EA, 0x81FB, 0x01FE, 0x01F4, 0x81F1,
+  0x81D3, 0x01D6, 0x01DC, 0x81D9, 0x01C8, 0x81CD, 0x81C7, 0x01C2,
+  0x0140, 0x8145, 0x814F, 0x014A, 0x815B, 0x015E, 0x0154, 0x8151,
+  0x8173, 0x0176, 0x017C, 0x8179, 0x0168, 0x816D, 0x8167, 0x0162,
+  0x8123, 0x0126, 0x012C, 0x8129, 0x0138, 0x813D, 0x8137, 0x0132,
+  0x0110, 0x8115, 0x811F, 0x011A, 0x810B, 0x010E, 0x0104, 0x8101,
+  0x8303, 0x0306, 0x030C, 0x8309, 0x0318, 0x831D, 0x8317, 0x0312,
+  0x0330, 0x8335, 0x833F, 0x033A, 0x832B, 0x032E, 0x0324, 0x8321,
+  0x0360, 0x8365, 0x836F, 0x036A, 0x837B, 0x037E, 0x0374, 0x8371,
+  0x8353, 0x0356, 0x035C, 0x8359, 0x0348, 0x834D, 0x8347, 0x0342,
+  0x03C0, 0x83C5, 0x83CF, 0x03CA, 0x83DB, 0x03DE, 0x03D4, 0x83D1,
+  0x83F3, 0x03F6, 0x03FC, 0x83F9, 0x03E8, 0x83ED, 0x83E7, 0x03E2,
+  0x83A3, 0x03A6, 0x03AC, 0x83A9, 0x03B8, 0x83BD, 0x83B7, 0x03B2,
+  0x0390, 0x8395, 0x839F, 0x039A, 0x838B, 0x038E, 0x0384, 0x8381,
+  0x0280, 0x8285, 0x828F, 0x028A, 0x829B, 0x029E, 0x0294, 0x8291,
+  0x82B3, 0x02B6, 0x02BC, 0x82B9, 0x02A8, 0x82AD, 0x82A7, 0x02A2,
+  0x82E3, 0x02E6, 0x02EC, 0x82E9, 0x02F8, 0x82FD, 0x82F7, 0x02F2,
+  0x02D0, 0x82D5, 0x82DF, 0x02DA, 0x82CB, 0x02CE, 0x02C4, 0x82C1,
+  0x8243, 0x0246, 0x024C, 0x8249, 0x0258, 0x825D, 0x8257, 0x0252,
+  0x0270, 0x8275, 0x827F, 0x027A, 0x826B, 0x026E, 0x0264, 0x8261,
+  0x0220, 0x8225, 0x822F, 0x022A, 0x823B, 0x023E, 0x0234, 0x8231,
+  0x8213, 0x0216, 0x021C, 0x8219, 0x0208, 0x820D, 0x8207, 0x0202
+};
+
+static uint16_t updateCRCBytewise(uint16_t crc, const uint8_t *data, size_t size)
+{
+  for (size_t j = 0; j < size; j++)
+  {
+    uint16_t i = ((uint16_t)(crc >> 8) ^ data[j]) & 0xFF;
+    crc = (crc << 8) ^ CRC_TABLE[i];
+  }
+  return crc;
+}
+
+// table_[k][b] is the CRC of byte b followed by k zero bytes
+struct SlicingTable
+{
+  uint16_t table_[8][256];
+
+  SlicingTable()
+  {
+    memcpy(table_[0], CRC_TABLE, sizeof(CRC_TABLE));
+    for (int _k = 1; _k < 8; _k++)
+      for (int _b = 0; _b < 256; _b++)
+        table_[_k][_b] = (uint16_t)(table_[_k - 1][_b] << 8) ^ CRC_TABLE[table_[_k - 1][_b] >> 8];
+  }
+};
+
+static const SlicingTable &getSlicingTable()
+{
+  static const SlicingTable _slicing_table;
+  return _slicing_table;
+}
+
+static uint16_t updateCRCSlicing8(uint16_t crc, const uint8_t *data, size_t size)
+{
+  const uint16_t (*_t)[256] = getSlicingTable().table_;
+
+  while (size >= 8)
+  {
+    crc = _t[7][data[0] ^ (crc >> 8)] ^ _t[6][data[1] ^ (crc & 0xFF)]
+        ^ _t[5][data[2]] ^ _t[4][data[3]] ^ _t[3][data[4]]
+        ^ _t[2][data[5]] ^ _t[1][data[6]] ^ _t[0][data[7]];
+    data += 8;
+    size -= 8;
+  }
+  return updateCRCBytewise(crc, data, size);
+}
+
+#ifdef CRC_HAS_CLMUL
+
+// x^n mod P, the factor that moves a 64-bit half n bits further from the end of the data
+static uint64_t getXPowerModP(int n)
+{
+  uint32_t _r = 1;
+  for (int _i = 0; _i < n; _i++)
+  {
+    _r <<= 1;
+    if (_r & 0x10000)
+      _r ^= CRC_POLYNOMIAL;
+  }
+  return _r;
+}
+
+// The fold constants hold x^D mod P (low half) and x^(D+64) mod P (high half)
+struct FoldConstants
+{
+  uint64_t fold_[4][2];   // D = 128, 256, 384, 512
+
+  FoldConstants()
+  {
+    for (int _i = 0; _i < 4; _i++)
+    {
+      fold_[_i][0] = getXPowerModP(128 * (_i + 1));
+      fold_[_i][1] = getXPowerModP(128 * (_i + 1) + 64);
+    }
+  }
+};
+
+static const FoldConstants &getFoldConstants()
+{
+  static const FoldConstants _fold_constants;
+  return _fold_constants;
+}
+
+static bool hasClmul()
+{
+#if defined(__GNUC__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#else
+  int _info[4];
+  __cpuid(_info, 1);
+  return (_info[2] & (1 << 1)) && (_info[2] & (1 << 9));   // PCLMULQDQ, SSSE3
+#endif
+}
+
+// The data is held as a 128-bit polynomial with its first byte in the top bits
+CRC_CLMUL_TARGET static inline __m128i loadBlock(const uint8_t *data, __m128i reverse)
+{
+  return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), reverse);
+}
+
+// A value of at most 80 bits congruent to X * x^D modulo P
+CRC_CLMUL_TARGET static inline __m128i fold(__m128i x, __m128i constant)
+{
+  return _mm_xor_si128(_mm_clmulepi64_si128(x, constant, 0x00), _mm_clmulepi64_si128(x, constant, 0x11));
+}
+
+CRC_CLMUL_TARGET static uint16_t updateCRCClmul(uint16_t crc, const uint8_t *data, size_t size)
+{
+  if (size < CRC_CLMUL_MIN_SIZE)
+    return updateCRCSlicing8(crc, data, size);
+
+  const FoldConstants &_c = getFoldConstants();
+  const __m128i _reverse  = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  const __m128i _k128     = _mm_loadu_si128((const __m128i *)_c.fold_[0]);
+
+  // the CRC so far is added to the first 16 bits of the data
+  __m128i _x = _mm_xor_si128(loadBlock(data, _reverse), _mm_set_epi64x((long long)((uint64_t)crc << 48), 0));
+  data += 16;
+  size -= 16;
+
+  if (size >= 112)
+  {
+    const __m128i _k256 = _mm_loadu_si128((const __m128i *)_c.fold_[1]);
+    const __m128i _k384 = _mm_loadu_si128((const __m128i *)_c.fold_[2]);
+    const __m128i _k512 = _mm_loadu_si128((const __m128i *)_c.fold_[3]);
+
+    // four independent lanes hide the latency of the multiplier
+    __m128i _x1 = loadBlock(data, _reverse);
+    __m128i _x2 = loadBlock(data + 16, _reverse);
+    __m128i _x3 = loadBlock(data + 32, _reverse);
+    data += 48;
+    size -= 48;
+
+    while (size >= 64)
+    {
+      _x  = _mm_xor_si128(fold(_x, _k512), loadBlock(data, _reverse));
+      _x1 = _mm_xor_si128(fold(_x1, _k512), loadBlock(data + 16, _reverse));
+      _x2 = _mm_xor_si128(fold(_x2, _k512), loadBlock(data + 32, _reverse));
+      _x3 = _mm_xor_si128(fold(_x3, _k512), loadBlock(data + 48, _reverse));
+      data += 64;
+      size -= 64;
+    }
+
+    _x = _mm_xor_si128(_mm_xor_si128(fold(_x, _k384), fold(_x1, _k256)),
+                       _mm_xor_si128(fold(_x2, _k128), _x3));
+  }
+
+  while (size >= 16)
+  {
+    _x = _mm_xor_si128(fold(_x, _k128), loadBlock(data, _reverse));
+    data += 16;
+    size -= 16;
+  }
+
+  // the remaining 128 bits are reduced with the tables, then the tail follows
+  uint8_t _block[16];
+  _mm_storeu_si128((__m128i *)_block, _mm_shuffle_epi8(_x, _reverse));
+  crc = updateCRCSlicing8(0, _block, sizeof(_block));
+  return updateCRCSlicing8(crc, data, size);
+}
+
+#endif
+
+typedef uint16_t (*CRCFunction)(uint16_t, const uint8_t *, size_t);
+
+static CRCImplementation selectCRCImplementation()
+{
+#ifdef CRC_HAS_CLMUL
+  if (hasClmul())
+    return CRC_CLMUL;
+#endif
+  return CRC_SLICING_BY_8;
+}
+
+static CRCFunction getCRCFunction(CRCImplementation implementation)
+{
+  switch (implementation)
+  {
+  case CRC_BYTEWISE:
+    return updateCRCBytewise;
+#ifdef CRC_HAS_CLMUL
+  case CRC_CLMUL:
+    if (isCRCImplementationAvailable(CRC_CLMUL))
+      return updateCRCClmul;
+    break;
+#endif
+  default:
+    break;
+  }
+  return updateCRCSlicing8;
+}
+
+uint16_t updateCRC(uint16_t crc, const uint8_t *data, size_t size)
+{
+  static const CRCFunction _update = getCRCFunction(getCRCImplementation());
+  return _update(crc, data, size);
+}
+
+uint16_t updateCRC(CRCImplementation implementation, uint16_t crc, const uint8_t *data, size_t size)
+{
+  return getCRCFunction(implementation)(crc, data, size);
+}
+
+bool isCRCImplementationAvailable(CRCImplementation implementation)
+{
+  if (implementation == CRC_CLMUL)
+    return getCRCImplementation() == CRC_CLMUL;
+  return implementation == CRC_BYTEWISE || implementation == CRC_SLICING_BY_8;
+}
+
+CRCImplementation getCRCImplementation()
+{
+  static const CRCImplementation _implementation = selectCRCImplementation();
+  return _implementation;
+}
+
+const char *getCRCImplementationName(CRCImplementation implementation)
+{
+  switch (implementation)
+  {
+  case CRC_BYTEWISE:
+    return "bytewise";
+  case CRC_SLICING_BY_8:
+    return "slicing-by-8";
+  case CRC_CLMUL:
+    return "pclmulqdq";
+  }
+  return "unknown";
+}
+
+}
@@ -0,0 +1,159 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#if defined(__linux__)
+#include <glob.h>
+#endif
+
+#include <stdio.h>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include "rh_p12_rn/baud_rate.h"
+#include "rh_p12_rn/discovery.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "rh_p12_rn/protocol2.h"
+
+#define PING_STATUS_LENGTH  14    // status packet with Model Number and Firmware Version
+#define PING_ID_DELAY_MSEC  3.0   // a device waits this long per ID that did not answer before it
+
+namespace rh_p12_rn
+{
+
+DiscoveryParam::DiscoveryParam()
+  : baudrate_list(getBaudRateList()),
+    max_id(DISCOVERY_MAX_ID)
+{
+}
+
+std::vector<std::string> listSerialPorts()
+{
+  std::vector<std::string> _port_name_list;
+
+#if defined(__linux__)
+  const char *_pattern_list[2] = { "/dev/ttyUSB*", "/dev/ttyACM*" };
+  for (int i = 0; i < 2; i++)
+  {
+    glob_t _glob;
+    if (glob(_pattern_list[i], 0, NULL, &_glob) == 0)
+    {
+      for (size_t n = 0; n < _glob.gl_pathc; n++)
+        _port_name_list.push_back(_glob.gl_pathv[n]);
+    }
+    globfree(&_glob);
+  }
+#elif defined(_WIN32) || defined(_WIN64)
+  for (int i = 1; i <= 32; i++)
+  {
+    char _name[16];
+    snprintf(_name, sizeof(_name), "COM%d", i);
+    _port_name_list.push_back(_name);
+  }
+#endif
+
+  return _port_name_list;
+}
+
+int broadcastPing(dynamixel::PortHandler *port, uint8_t max_id, std::vector<DiscoveredGripper> *gripper_list)
+{
+  uint8_t _packet[P2_MIN_PACKET_LENGTH];
+  size_t  _length = buildPacket(P2_BROADCAST_ID, P2_INST_PING, NULL, 0, _packet);
+
+  port->clearPort();
+  if (port->writePort(_packet, (int)_length) != (int)_length)
+    return COMM_TX_FAIL;
+
+  // every reply on the wire, plus the wait of each device for the IDs in front of it
+  double _byte_msec = 10000.0 / port->getBaudRate();
+  port->setPacketTimeout(_byte_msec * (_length + PING_STATUS_LENGTH * (max_id + 1)) +
+                         PING_ID_DELAY_MSEC * (max_id + 1) + 16.0);
+
+  PacketStream          _stream;
+  std::vector<uint8_t>  _status;
+  uint8_t               _buffer[256];
+  while (port->isPacketTimeout() == false)
+  {
+    int _read = port->readPort(_buffer, sizeof(_buffer));
+    if (_read <= 0)
+      continue;
+
+    _stream.append(_buffer, _read);
+    while (_stream.pop(&_status))
+    {
+      if (_status.size() != PING_STATUS_LENGTH || _status[P2_INSTRUCTION] != P2_INST_STATUS)
+        continue;   // the echo of the ping on a half duplex adapter, or noise
+
+      DiscoveredGripper _gripper;
+      _gripper.port_name        = port->getPortName();
+      _gripper.baudrate         = port->getBaudRate();
+      _gripper.id               = _status[P2_ID];
+      _gripper.model_number     = _status[P2_STATUS_PARAM] | (_status[P2_STATUS_PARAM + 1] << 8);
+      _gripper.firmware_version = _status[P2_STATUS_PARAM + 2];
+      _gripper.table            = findControlTable(_gripper.model_number);
+      gripper_list->push_back(_gripper);
+    }
+  }
+
+  std::sort(gripper_list->begin(), gripper_list->end(),
+            [](const DiscoveredGripper &a, const DiscoveredGripper &b) { return a.id < b.id; });
+  return COMM_SUCCESS;
+}
+
+// pings one port at every rate, on a thread of its own
+static void discoverPort(const std::string &port_name, const DiscoveryParam &param,
+                         std::vector<DiscoveredGripper> *gripper_list)
+{
+  dynamixel::PortHandler *_port = getPortHandler(port_name.c_str(), CONTROL_TABLE_RH_P12_RN);
+  if (_port->openPort() == false)
+  {
+    delete _port;
+    return;
+  }
+
+  for (size_t i = 0; i < param.baudrate_list.size(); i++)
+  {
+    if (_port->setBaudRate(param.baudrate_list[i]) == false)
+      continue;
+
+    std::vector<DiscoveredGripper> _list;
+    broadcastPing(_port, param.max_id, &_list);
+    for (size_t n = 0; n < _list.size(); n++)
+      _list[n].port_name = port_name;   // the name given, not the one the port reports
+    gripper_list->insert(gripper_list->end(), _list.begin(), _list.end());
+  }
+
+  _port->closePort();
+  delete _port;
+}
+
+std::vector<DiscoveredGripper> discoverGrippers(const std::vector<std::string> &port_name_list,
+                                                const DiscoveryParam &param)
+{
+  std::vector<std::vector<DiscoveredGripper> > _port_list(port_name_list.size());
+  std::vector<std::thread> _thread_list;
+  for (size_t i = 0; i < port_name_list.size(); i++)
+    _thread_list.push_back(std::thread(discoverPort, std::cref(port_name_list[i]), std::cref(param), &_port_list[i]));
+  for (size_t i = 0; i < _thread_list.size(); i++)
+    _thread_list[i].join();
+
+  std::vector<DiscoveredGripper> _gripper_list;
+  for (size_t i = 0; i < _port_list.size(); i++)
+    _gripper_list.insert(_gripper_list.end(), _port_list[i].begin(), _port_list[i].end());
+  return _gripper_list;
+}
+
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include "rh_p12_rn/flat_bulk_read.h"
+
+namespace rh_p12_rn
+{
+
+FlatBulkRead::FlatBulkRead(dynamixel::PortHandler *port, dynamixel::PacketHandler *ph)
+  : FlatGroupRead(port, ph)
+{
+  makeParam();
+}
+
+void FlatBulkRead::makeParam()
+{
+  // ID, address and length of every slot, in the order of the slots
+  std::vector<uint8_t> _param;
+  _param.reserve(5 * slot_list_.size());
+  for (size_t i = 0; i < slot_list_.size(); i++)
+  {
+    const Slot &_slot = slot_list_[i];
+    _param.push_back(_slot.id);
+    _param.push_back(DXL_LOBYTE(_slot.address));
+    _param.push_back(DXL_HIBYTE(_slot.address));
+    _param.push_back(DXL_LOBYTE(_slot.length));
+    _param.push_back(DXL_HIBYTE(_slot.length));
+  }
+
+  makeBuffers(P2_INST_BULK_READ, _param);
+}
+
+bool FlatBulkRead::addParam(uint8_t id, uint16_t start_address, uint16_t data_length)
+{
+  if (addSlot(id, start_address, data_length) == false)
+    return false;
+
+  makeParam();
+  return true;
+}
+
+void FlatBulkRead::removeParam(uint8_t id)
+{
+  if (removeSlot(id) == false)
+    return;
+
+  makeParam();
+}
+
+bool FlatBulkRead::changeParam(uint8_t id, uint16_t start_address, uint16_t data_length)
+{
+  if (findSlot(id) == NULL)
+    return false;
+
+  Slot &_slot   = slot_list_[slot_of_id_[id]];
+  _slot.address = start_address;
+  _slot.length  = data_length;
+  makeParam();
+  return true;
+}
+
+void FlatBulkRead::clearParam()
+{
+  slot_list_.clear();
+  makeParam();
+}
+
+}
@@ -0,0 +1,261 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <string.h>
+#include <algorithm>
+#include "rh_p12_rn/flat_group_read.h"
+
+#define STATUS_OVERHEAD   11    // header, reserved, id, length, instruction, error and CRC
+
+namespace rh_p12_rn
+{
+
+FlatGroupRead::FlatGroupRead(dynamixel::PortHandler *port, dynamixel::PacketHandler *ph)
+  : port_(port),
+    ph_(ph),
+    arena_(NULL),
+    wait_length_(0),
+    crc_error_count_(0)
+{
+  memset(slot_of_id_, FLAT_READ_NO_SLOT, sizeof(slot_of_id_));
+}
+
+const FlatGroupRead::Slot *FlatGroupRead::findSlot(uint8_t id) const
+{
+  if (id >= FLAT_READ_ID_SLOTS || slot_of_id_[id] == FLAT_READ_NO_SLOT)
+    return NULL;
+  return &slot_list_[slot_of_id_[id]];
+}
+
+bool FlatGroupRead::addSlot(uint8_t id, uint16_t address, uint16_t length)
+{
+  if (id >= FLAT_READ_ID_SLOTS || slot_of_id_[id] != FLAT_READ_NO_SLOT)
+    return false;
+
+  Slot _slot = { id, address, length, 0, NULL };
+  slot_list_.push_back(_slot);
+  slot_of_id_[id] = (uint8_t)(slot_list_.size() - 1);
+  return true;
+}
+
+bool FlatGroupRead::removeSlot(uint8_t id)
+{
+  if (findSlot(id) == NULL)
+    return false;
+
+  slot_list_.erase(slot_list_.begin() + slot_of_id_[id]);
+  return true;
+}
+
+void FlatGroupRead::makeBuffers(uint8_t instruction, const std::vector<uint8_t> &param)
+{
+  size_t _count       = slot_list_.size();
+  size_t _arena_size  = 0;
+  size_t _wait_length = 0;
+  size_t _rx_size     = P2_MAX_PACKET_LENGTH;   // room for one packet of noise in front
+
+  memset(slot_of_id_, FLAT_READ_NO_SLOT, sizeof(slot_of_id_));
+  for (size_t i = 0; i < _count; i++)
+  {
+    Slot &_slot = slot_list_[i];
+    slot_of_id_[_slot.id] = (uint8_t)i;
+    _slot.offset  = (uint32_t)_arena_size;
+    _arena_size  += _slot.length;
+    _wait_length += STATUS_OVERHEAD + _slot.length;
+    _rx_size     += STATUS_OVERHEAD + _slot.length + _slot.length / 3 + 1;   // worst case byte stuffing
+  }
+
+  arena_storage_.assign(_arena_size + FLAT_READ_ALIGNMENT, 0);
+  uintptr_t _address = (uintptr_t)&arena_storage_[0];
+  arena_ = (uint8_t *)((_address + FLAT_READ_ALIGNMENT - 1) & ~(uintptr_t)(FLAT_READ_ALIGNMENT - 1));
+  error_list_.assign(_count, 0);
+  is_available_list_.assign(_count, 0);
+  rx_buffer_.resize(_rx_size);
+  wait_length_ = (uint16_t)std::min(_wait_length, (size_t)UINT16_MAX);
+
+  tx_packet_.resize(P2_MAX_PACKET_LENGTH);
+  tx_packet_.resize(buildPacket(P2_BROADCAST_ID, instruction, param.empty()? NULL : &param[0], param.size(), &tx_packet_[0]));
+}
+
+int FlatGroupRead::txPacket()
+{
+  if (ph_->getProtocolVersion() != 2.0 || slot_list_.empty())
+    return COMM_NOT_AVAILABLE;
+  if (port_->is_using_)
+    return COMM_PORT_BUSY;
+  port_->is_using_ = true;
+
+  port_->clearPort();
+  int _length = (int)tx_packet_.size();
+  if (port_->writePort(&tx_packet_[0], _length) != _length)
+  {
+    port_->is_using_ = false;
+    return COMM_TX_FAIL;
+  }
+
+  port_->setPacketTimeout(wait_length_);
+  return COMM_SUCCESS;
+}
+
+bool FlatGroupRead::takeStatus(const uint8_t *packet, size_t length)
+{
+  if (packet[P2_INSTRUCTION] != P2_INST_STATUS || packet[P2_ID] >= FLAT_READ_ID_SLOTS)
+    return false;
+
+  uint8_t _index = slot_of_id_[packet[P2_ID]];
+  if (_index == FLAT_READ_NO_SLOT || is_available_list_[_index])
+    return false;
+
+  // a longer packet carries byte stuffing : that one is unstuffed into the arena
+  Slot &_slot = slot_list_[_index];
+  size_t _status_length = STATUS_OVERHEAD + _slot.length;
+  if (length != _status_length)
+  {
+    length = unstuffPacket(packet, length, unstuffed_);
+    packet = unstuffed_;
+    if (length != _status_length)
+      return false;
+    memcpy(arena_ + _slot.offset, packet + P2_STATUS_PARAM, _slot.length);
+    _slot.data = arena_ + _slot.offset;
+  }
+  else
+  {
+    _slot.data = packet + P2_STATUS_PARAM;
+  }
+
+  error_list_[_index]         = packet[P2_ERROR];
+  is_available_list_[_index]  = 1;
+  return true;
+}
+
+void FlatGroupRead::keepData()
+{
+  for (size_t i = 0; i < slot_list_.size(); i++)
+  {
+    Slot &_slot = slot_list_[i];
+    if (is_available_list_[i] && _slot.data != arena_ + _slot.offset)
+    {
+      memcpy(arena_ + _slot.offset, _slot.data, _slot.length);
+      _slot.data = arena_ + _slot.offset;
+    }
+  }
+}
+
+int FlatGroupRead::rxPacket()
+{
+  if (ph_->getProtocolVersion() != 2.0 || slot_list_.empty())
+    return COMM_NOT_AVAILABLE;
+
+  std::fill(is_available_list_.begin(), is_available_list_.end(), 0);
+
+  size_t  _count  = 0;
+  size_t  _begin  = 0;      // first byte not parsed yet
+  size_t  _length = 0;
+  int     _result = COMM_RX_TIMEOUT;
+  while (true)
+  {
+    // the packets stay where they were received. The buffer holds every status packet
+    // and one packet of noise, so only a noisy line fills it up : the data received so
+    // far then goes to the arena, and the bytes not parsed yet to the front
+    if (_length == rx_buffer_.size())
+    {
+      keepData();
+      memmove(&rx_buffer_[0], &rx_buffer_[_begin], _length - _begin);
+      _length -= _begin;
+      _begin   = 0;
+      if (_length == rx_buffer_.size())
+        _length = 0;    // only noise could fill it
+    }
+
+    int _read = port_->readPort(&rx_buffer_[_length], (int)(rx_buffer_.size() - _length));
+    if (_read > 0)
+    {
+      _length += _read;
+
+      size_t _start, _packet_length;
+      while ((_packet_length = findPacket(&rx_buffer_[_begin], _length - _begin, &_start, &crc_error_count_)) != 0)
+      {
+        if (takeStatus(&rx_buffer_[_begin + _start], _packet_length))
+          _count++;
+        _begin += _start + _packet_length;
+      }
+      _begin += _start;
+
+      if (_count == slot_list_.size())
+      {
+        _result = COMM_SUCCESS;
+        break;
+      }
+    }
+
+    if (port_->isPacketTimeout())
+    {
+      _result = (_length > _begin)? COMM_RX_CORRUPT : COMM_RX_TIMEOUT;
+      break;
+    }
+  }
+
+  port_->is_using_ = false;
+  return _result;
+}
+
+int FlatGroupRead::txRxPacket()
+{
+  int _result = txPacket();
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  return rxPacket();
+}
+
+bool FlatGroupRead::isAvailable(uint8_t id, uint16_t address, uint16_t data_length) const
+{
+  const Slot *_slot = findSlot(id);
+  if (_slot == NULL || is_available_list_[slot_of_id_[id]] == 0)
+    return false;
+
+  return address >= _slot->address && address + data_length <= _slot->address + _slot->length;
+}
+
+uint32_t FlatGroupRead::getData(uint8_t id, uint16_t address, uint16_t data_length) const
+{
+  if (isAvailable(id, address, data_length) == false)
+    return 0;
+
+  const Slot *_slot = findSlot(id);
+  return getLittleEndian(_slot->data + (address - _slot->address), data_length);
+}
+
+RegisterView FlatGroupRead::getView(uint8_t id) const
+{
+  const Slot *_slot = findSlot(id);
+  if (_slot == NULL || is_available_list_[slot_of_id_[id]] == 0)
+    return RegisterView();
+
+  return RegisterView(_slot->data, _slot->address, _slot->length);
+}
+
+bool FlatGroupRead::getError(uint8_t id, uint8_t *error) const
+{
+  if (findSlot(id) == NULL || is_available_list_[slot_of_id_[id]] == 0)
+    return false;
+
+  *error = error_list_[slot_of_id_[id]];
+  return true;
+}
+
+}
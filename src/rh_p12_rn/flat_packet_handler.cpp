@@ -0,0 +1,678 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+#include "rh_p12_rn/discovery.h"
+#include "rh_p12_rn/flat_packet_handler.h"
+
+#define STATUS_MIN_LENGTH   11    // header, reserved, id, length, instruction, error and CRC
+#define MAX_ID              0xFC
+
+namespace rh_p12_rn
+{
+
+// the data of a read status packet; one with an error may come without it, and the rest is cleared
+static void copyData(const uint8_t *status, uint16_t length, uint8_t *data)
+{
+  size_t _received = DXL_MAKEWORD(status[P2_LENGTH_L], status[P2_LENGTH_H]) - 4;
+  if (_received > length)
+    _received = length;
+  memcpy(data, &status[P2_STATUS_PARAM], _received);
+  memset(data + _received, 0, length - _received);
+}
+
+static bool makeWriteParam(uint8_t *param, uint16_t address, uint16_t length, const uint8_t *data)
+{
+  if (2 + (size_t)length > P2_MAX_PACKET_LENGTH)
+    return false;
+
+  param[0] = DXL_LOBYTE(address);
+  param[1] = DXL_HIBYTE(address);
+  memcpy(&param[2], data, length);
+  return true;
+}
+
+static bool makeSyncParam(uint8_t *param, uint16_t start_address, uint16_t data_length,
+                          const uint8_t *id_param, uint16_t id_param_length)
+{
+  if (4 + (size_t)id_param_length > P2_MAX_PACKET_LENGTH)
+    return false;
+
+  param[0] = DXL_LOBYTE(start_address);
+  param[1] = DXL_HIBYTE(start_address);
+  param[2] = DXL_LOBYTE(data_length);
+  param[3] = DXL_HIBYTE(data_length);
+  memcpy(&param[4], id_param, id_param_length);
+  return true;
+}
+
+FlatPacketHandler::FlatPacketHandler()
+  : is_full_reported_(false)
+{
+  for (int i = 0; i < FLAT_PH_MAX_PORTS; i++)
+    buffer_list_[i].store(NULL);
+}
+
+FlatPacketHandler::~FlatPacketHandler()
+{
+  for (int i = 0; i < FLAT_PH_MAX_PORTS; i++)
+    delete buffer_list_[i].load();
+}
+
+FlatPacketHandler *FlatPacketHandler::getInstance()
+{
+  static FlatPacketHandler _instance;
+  return &_instance;
+}
+
+bool FlatPacketHandler::addPort(dynamixel::PortHandler *port)
+{
+  std::lock_guard<std::mutex> _lock(add_mutex_);
+
+  // buffers are filled in order and only freed by the destructor, so getBuffer() reads
+  // the list without the lock; a removed port leaves its buffer for the next one
+  PortBuffer *_free_buffer = NULL;
+  int         _index       = 0;
+  for ( ; _index < FLAT_PH_MAX_PORTS; _index++)
+  {
+    PortBuffer *_buffer = buffer_list_[_index].load(std::memory_order_acquire);
+    if (_buffer == NULL)
+      break;
+
+    dynamixel::PortHandler *_port = _buffer->port.load(std::memory_order_acquire);
+    if (_port == port)
+      return true;
+    if (_port == NULL && _free_buffer == NULL)
+      _free_buffer = _buffer;
+  }
+
+  if (_free_buffer != NULL)
+  {
+    _free_buffer->port.store(port, std::memory_order_release);
+    return true;
+  }
+
+  if (_index < FLAT_PH_MAX_PORTS)
+  {
+    PortBuffer *_buffer = new PortBuffer;
+    _buffer->port.store(port, std::memory_order_relaxed);
+    buffer_list_[_index].store(_buffer, std::memory_order_release);
+    return true;
+  }
+
+  if (is_full_reported_ == false)
+  {
+    fprintf(stderr, "[FlatPacketHandler] no buffers left for port %s : %d ports hold them, "
+                    "calls on it return COMM_NOT_AVAILABLE (removePort() frees a closed port's buffers)\n",
+            port->getPortName(), FLAT_PH_MAX_PORTS);
+    is_full_reported_ = true;
+  }
+  return false;
+}
+
+void FlatPacketHandler::removePort(dynamixel::PortHandler *port)
+{
+  std::lock_guard<std::mutex> _lock(add_mutex_);
+
+  for (int i = 0; i < FLAT_PH_MAX_PORTS; i++)
+  {
+    PortBuffer *_buffer = buffer_list_[i].load(std::memory_order_acquire);
+    if (_buffer == NULL)
+      break;
+    if (_buffer->port.load(std::memory_order_relaxed) == port)
+    {
+      _buffer->port.store(NULL, std::memory_order_release);
+      is_full_reported_ = false;
+      return;
+    }
+  }
+}
+
+FlatPacketHandler::PortBuffer *FlatPacketHandler::getBuffer(dynamixel::PortHandler *port)
+{
+  for (int i = 0; i < FLAT_PH_MAX_PORTS; i++)
+  {
+    PortBuffer *_buffer = buffer_list_[i].load(std::memory_order_acquire);
+    if (_buffer == NULL)
+      break;
+    if (_buffer->port.load(std::memory_order_acquire) == port)
+      return _buffer;
+  }
+
+  if (addPort(port) == false)
+    return NULL;
+  return getBuffer(port);
+}
+
+int FlatPacketHandler::transmit(dynamixel::PortHandler *port, PortBuffer *buffer, uint8_t id, uint8_t instruction,
+                                const uint8_t *param, size_t param_length)
+{
+  if (port->is_using_)
+    return COMM_PORT_BUSY;
+  port->is_using_ = true;
+
+  size_t _length = buildPacket(id, instruction, param, param_length, buffer->tx);
+  if (_length == 0)
+  {
+    port->is_using_ = false;
+    return COMM_TX_ERROR;
+  }
+
+  port->clearPort();
+  if (port->writePort(buffer->tx, (int)_length) != (int)_length)
+  {
+    port->is_using_ = false;
+    return COMM_TX_FAIL;
+  }
+  return COMM_SUCCESS;
+}
+
+int FlatPacketHandler::receive(dynamixel::PortHandler *port, PortBuffer *buffer)
+{
+  uint8_t  *_rx           = buffer->rx;
+  size_t    _length       = 0;
+  size_t    _wait_length  = STATUS_MIN_LENGTH;
+  int       _result;
+
+  // bytes are read up to the end of the status packet and no further, as the SDK does,
+  // so that the next status packet of a Sync Read is left in the port
+  while (true)
+  {
+    if (_length < _wait_length)
+    {
+      int _read = port->readPort(&_rx[_length], (int)(_wait_length - _length));
+      if (_read > 0)
+        _length += _read;
+    }
+
+    if (_length >= _wait_length)
+    {
+      size_t _start = 0;
+      while (_start + 3 < _length &&
+             !(_rx[_start] == 0xFF && _rx[_start + 1] == 0xFF && _rx[_start + 2] == 0xFD && _rx[_start + 3] == 0x00))
+        _start++;
+
+      if (_start > 0)
+      {
+        // drop what is in front of the header
+        memmove(_rx, _rx + _start, _length - _start);
+        _length -= _start;
+        continue;
+      }
+
+      size_t _packet_length = P2_HEADER_LENGTH + DXL_MAKEWORD(_rx[P2_LENGTH_L], _rx[P2_LENGTH_H]);
+      if (_rx[P2_ID] > MAX_ID || _rx[P2_INSTRUCTION] != P2_INST_STATUS ||
+          _packet_length < STATUS_MIN_LENGTH || _packet_length > P2_MAX_PACKET_LENGTH)
+      {
+        // not a status packet : look for the next header
+        memmove(_rx, _rx + 1, --_length);
+        continue;
+      }
+      if (_wait_length != _packet_length)
+      {
+        _wait_length = _packet_length;
+        continue;
+      }
+
+      uint16_t _crc = DXL_MAKEWORD(_rx[_packet_length - 2], _rx[_packet_length - 1]);
+      _result = (updateCRC(0, _rx, _packet_length - 2) == _crc)? COMM_SUCCESS : COMM_RX_CORRUPT;
+      break;
+    }
+    else if (port->isPacketTimeout())
+    {
+      _result = (_length == 0)? COMM_RX_TIMEOUT : COMM_RX_CORRUPT;
+      break;
+    }
+  }
+  port->is_using_ = false;
+
+  if (_result == COMM_SUCCESS)
+    unstuffPacket(_rx, _wait_length, buffer->status);
+  return _result;
+}
+
+int FlatPacketHandler::receiveFrom(dynamixel::PortHandler *port, PortBuffer *buffer, uint8_t id)
+{
+  int _result;
+  do
+  {
+    _result = receive(port, buffer);
+  } while (_result == COMM_SUCCESS && buffer->status[P2_ID] != id);
+
+  return _result;
+}
+
+int FlatPacketHandler::transact(dynamixel::PortHandler *port, PortBuffer *buffer, uint8_t id, uint8_t instruction,
+                                const uint8_t *param, size_t param_length, uint8_t *error)
+{
+  int _result = transmit(port, buffer, id, instruction, param, param_length);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  // no status packet to wait for
+  if (instruction == P2_INST_SYNC_READ || instruction == P2_INST_BULK_READ)
+    _result = COMM_NOT_AVAILABLE;
+  if (id == P2_BROADCAST_ID || instruction == P2_INST_ACTION)
+  {
+    port->is_using_ = false;
+    return _result;
+  }
+
+  if (instruction == P2_INST_READ)
+    port->setPacketTimeout((uint16_t)(DXL_MAKEWORD(param[2], param[3]) + STATUS_MIN_LENGTH));
+  else
+    port->setPacketTimeout((uint16_t)STATUS_MIN_LENGTH);
+
+  _result = receiveFrom(port, buffer, id);
+  if (_result == COMM_SUCCESS && error != 0)
+    *error = buffer->status[P2_ERROR];
+  return _result;
+}
+
+const char *FlatPacketHandler::getTxRxResult(int result)
+{
+  switch (result)
+  {
+    case COMM_SUCCESS:        return "[TxRxResult] Communication success.";
+    case COMM_PORT_BUSY:      return "[TxRxResult] Port is in use!";
+    case COMM_TX_FAIL:        return "[TxRxResult] Failed transmit instruction packet!";
+    case COMM_RX_FAIL:        return "[TxRxResult] Failed get status packet from device!";
+    case COMM_TX_ERROR:       return "[TxRxResult] Incorrect instruction packet!";
+    case COMM_RX_WAITING:     return "[TxRxResult] Now receiving status packet!";
+    case COMM_RX_TIMEOUT:     return "[TxRxResult] There is no status packet!";
+    case COMM_RX_CORRUPT:     return "[TxRxResult] Incorrect status packet!";
+    case COMM_NOT_AVAILABLE:  return "[TxRxResult] Protocol does not support this function, or no port buffers are left!";
+    default:                  return "";
+  }
+}
+
+void FlatPacketHandler::printTxRxResult(int result)
+{
+  printf("%s\n", getTxRxResult(result));
+}
+
+const char *FlatPacketHandler::getRxPacketError(uint8_t error)
+{
+  if (error & P2_ERRBIT_ALERT)
+    return "[RxPacketError] Hardware error occurred. Check the error at Control Table (Hardware Error Status)!";
+
+  switch (error & ~P2_ERRBIT_ALERT)
+  {
+    case 0:                       return "";
+    case P2_ERRNUM_RESULT_FAIL:   return "[RxPacketError] Failed to process the instruction packet!";
+    case P2_ERRNUM_INSTRUCTION:   return "[RxPacketError] Undefined instruction or incorrect instruction!";
+    case P2_ERRNUM_CRC:           return "[RxPacketError] CRC doesn't match!";
+    case P2_ERRNUM_DATA_RANGE:    return "[RxPacketError] The data value is out of range!";
+    case P2_ERRNUM_DATA_LENGTH:   return "[RxPacketError] The data length does not match as expected!";
+    case P2_ERRNUM_DATA_LIMIT:    return "[RxPacketError] The data value exceeds the limit value!";
+    case P2_ERRNUM_ACCESS:        return "[RxPacketError] Writing or Reading is not available to target address!";
+    default:                      return "[RxPacketError] Unknown error code!";
+  }
+}
+
+void FlatPacketHandler::printRxPacketError(uint8_t error)
+{
+  printf("%s\n", getRxPacketError(error));
+}
+
+int FlatPacketHandler::txPacket(dynamixel::PortHandler *port, uint8_t *txpacket)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  size_t      _length = DXL_MAKEWORD(txpacket[P2_LENGTH_L], txpacket[P2_LENGTH_H]);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+  if (_length < 3)
+    return COMM_TX_ERROR;
+
+  return transmit(port, _buffer, txpacket[P2_ID], txpacket[P2_INSTRUCTION], &txpacket[P2_INSTRUCTION_PARAM], _length - 3);
+}
+
+int FlatPacketHandler::rxPacket(dynamixel::PortHandler *port, uint8_t *rxpacket)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+
+  int _result = receive(port, _buffer);
+  if (_result == COMM_SUCCESS)
+    memcpy(rxpacket, _buffer->status, P2_HEADER_LENGTH + DXL_MAKEWORD(_buffer->status[P2_LENGTH_L], _buffer->status[P2_LENGTH_H]));
+  return _result;
+}
+
+int FlatPacketHandler::txRxPacket(dynamixel::PortHandler *port, uint8_t *txpacket, uint8_t *rxpacket, uint8_t *error)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  size_t      _length = DXL_MAKEWORD(txpacket[P2_LENGTH_L], txpacket[P2_LENGTH_H]);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+  if (_length < 3)
+    return COMM_TX_ERROR;
+
+  int _result = transact(port, _buffer, txpacket[P2_ID], txpacket[P2_INSTRUCTION], &txpacket[P2_INSTRUCTION_PARAM], _length - 3, error);
+  if (_result == COMM_SUCCESS && txpacket[P2_ID] != P2_BROADCAST_ID && txpacket[P2_INSTRUCTION] != P2_INST_ACTION)
+    memcpy(rxpacket, _buffer->status, P2_HEADER_LENGTH + DXL_MAKEWORD(_buffer->status[P2_LENGTH_L], _buffer->status[P2_LENGTH_H]));
+  return _result;
+}
+
+int FlatPacketHandler::ping(dynamixel::PortHandler *port, uint8_t id, uint8_t *error)
+{
+  return ping(port, id, 0, error);
+}
+
+int FlatPacketHandler::ping(dynamixel::PortHandler *port, uint8_t id, uint16_t *model_number, uint8_t *error)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL || id >= P2_BROADCAST_ID)
+    return COMM_NOT_AVAILABLE;
+
+  int _result = transact(port, _buffer, id, P2_INST_PING, NULL, 0, error);
+  if (_result == COMM_SUCCESS && model_number != 0)
+    *model_number = DXL_MAKEWORD(_buffer->status[P2_STATUS_PARAM], _buffer->status[P2_STATUS_PARAM + 1]);
+  return _result;
+}
+
+int FlatPacketHandler::broadcastPing(dynamixel::PortHandler *port, std::vector<uint8_t> &id_list)
+{
+  if (port->is_using_)
+    return COMM_PORT_BUSY;
+
+  // not a control cycle call : the one of the discovery is used, with its vectors
+  std::vector<DiscoveredGripper> _gripper_list;
+  port->is_using_ = true;
+  int _result = rh_p12_rn::broadcastPing(port, MAX_ID, &_gripper_list);
+  port->is_using_ = false;
+
+  id_list.clear();
+  for (size_t i = 0; i < _gripper_list.size(); i++)
+    id_list.push_back(_gripper_list[i].id);
+
+  if (_result == COMM_SUCCESS && id_list.empty())
+    return COMM_RX_TIMEOUT;
+  return _result;
+}
+
+int FlatPacketHandler::action(dynamixel::PortHandler *port, uint8_t id)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+
+  return transact(port, _buffer, id, P2_INST_ACTION, NULL, 0, 0);
+}
+
+int FlatPacketHandler::reboot(dynamixel::PortHandler *port, uint8_t id, uint8_t *error)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+
+  return transact(port, _buffer, id, P2_INST_REBOOT, NULL, 0, error);
+}
+
+int FlatPacketHandler::factoryReset(dynamixel::PortHandler *port, uint8_t id, uint8_t option, uint8_t *error)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+
+  return transact(port, _buffer, id, P2_INST_FACTORY_RESET, &option, 1, error);
+}
+
+int FlatPacketHandler::readTx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL || id >= P2_BROADCAST_ID)
+    return COMM_NOT_AVAILABLE;
+
+  uint8_t _param[4] = { DXL_LOBYTE(address), DXL_HIBYTE(address), DXL_LOBYTE(length), DXL_HIBYTE(length) };
+  int _result = transmit(port, _buffer, id, P2_INST_READ, _param, sizeof(_param));
+  if (_result == COMM_SUCCESS)
+    port->setPacketTimeout((uint16_t)(length + STATUS_MIN_LENGTH));
+  return _result;
+}
+
+int FlatPacketHandler::readRx(dynamixel::PortHandler *port, uint8_t id, uint16_t length, uint8_t *data, uint8_t *error)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+
+  int _result = receiveFrom(port, _buffer, id);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  copyData(_buffer->status, length, data);
+
+  if (error != 0)
+    *error = _buffer->status[P2_ERROR];
+  return COMM_SUCCESS;
+}
+
+int FlatPacketHandler::readTxRx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL || id >= P2_BROADCAST_ID)
+    return COMM_NOT_AVAILABLE;
+
+  uint8_t _param[4] = { DXL_LOBYTE(address), DXL_HIBYTE(address), DXL_LOBYTE(length), DXL_HIBYTE(length) };
+  int _result = transact(port, _buffer, id, P2_INST_READ, _param, sizeof(_param), error);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  copyData(_buffer->status, length, data);
+  return COMM_SUCCESS;
+}
+
+int FlatPacketHandler::read1ByteTx(dynamixel::PortHandler *port, uint8_t id, uint16_t address)
+{
+  return readTx(port, id, address, 1);
+}
+
+int FlatPacketHandler::read1ByteRx(dynamixel::PortHandler *port, uint8_t id, uint8_t *data, uint8_t *error)
+{
+  return readRx(port, id, 1, data, error);
+}
+
+int FlatPacketHandler::read1ByteTxRx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint8_t *data, uint8_t *error)
+{
+  return readTxRx(port, id, address, 1, data, error);
+}
+
+int FlatPacketHandler::read2ByteTx(dynamixel::PortHandler *port, uint8_t id, uint16_t address)
+{
+  return readTx(port, id, address, 2);
+}
+
+int FlatPacketHandler::read2ByteRx(dynamixel::PortHandler *port, uint8_t id, uint16_t *data, uint8_t *error)
+{
+  uint8_t _data[2];
+  int _result = readRx(port, id, 2, _data, error);
+  if (_result == COMM_SUCCESS)
+    *data = DXL_MAKEWORD(_data[0], _data[1]);
+  return _result;
+}
+
+int FlatPacketHandler::read2ByteTxRx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t *data, uint8_t *error)
+{
+  uint8_t _data[2];
+  int _result = readTxRx(port, id, address, 2, _data, error);
+  if (_result == COMM_SUCCESS)
+    *data = DXL_MAKEWORD(_data[0], _data[1]);
+  return _result;
+}
+
+int FlatPacketHandler::read4ByteTx(dynamixel::PortHandler *port, uint8_t id, uint16_t address)
+{
+  return readTx(port, id, address, 4);
+}
+
+int FlatPacketHandler::read4ByteRx(dynamixel::PortHandler *port, uint8_t id, uint32_t *data, uint8_t *error)
+{
+  uint8_t _data[4];
+  int _result = readRx(port, id, 4, _data, error);
+  if (_result == COMM_SUCCESS)
+    *data = DXL_MAKEDWORD(DXL_MAKEWORD(_data[0], _data[1]), DXL_MAKEWORD(_data[2], _data[3]));
+  return _result;
+}
+
+int FlatPacketHandler::read4ByteTxRx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint32_t *data, uint8_t *error)
+{
+  uint8_t _data[4];
+  int _result = readTxRx(port, id, address, 4, _data, error);
+  if (_result == COMM_SUCCESS)
+    *data = DXL_MAKEDWORD(DXL_MAKEWORD(_data[0], _data[1]), DXL_MAKEWORD(_data[2], _data[3]));
+  return _result;
+}
+
+int FlatPacketHandler::writeTxOnly(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+  if (makeWriteParam(_buffer->param, address, length, data) == false)
+    return COMM_TX_ERROR;
+
+  int _result = transmit(port, _buffer, id, P2_INST_WRITE, _buffer->param, 2 + length);
+  port->is_using_ = false;
+  return _result;
+}
+
+int FlatPacketHandler::writeTxRx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+  if (makeWriteParam(_buffer->param, address, length, data) == false)
+    return COMM_TX_ERROR;
+
+  return transact(port, _buffer, id, P2_INST_WRITE, _buffer->param, 2 + length, error);
+}
+
+int FlatPacketHandler::write1ByteTxOnly(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint8_t data)
+{
+  return writeTxOnly(port, id, address, 1, &data);
+}
+
+int FlatPacketHandler::write1ByteTxRx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint8_t data, uint8_t *error)
+{
+  return writeTxRx(port, id, address, 1, &data, error);
+}
+
+int FlatPacketHandler::write2ByteTxOnly(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t data)
+{
+  uint8_t _data[2] = { DXL_LOBYTE(data), DXL_HIBYTE(data) };
+  return writeTxOnly(port, id, address, 2, _data);
+}
+
+int FlatPacketHandler::write2ByteTxRx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t data, uint8_t *error)
+{
+  uint8_t _data[2] = { DXL_LOBYTE(data), DXL_HIBYTE(data) };
+  return writeTxRx(port, id, address, 2, _data, error);
+}
+
+int FlatPacketHandler::write4ByteTxOnly(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint32_t data)
+{
+  uint8_t _data[4] = { DXL_LOBYTE(DXL_LOWORD(data)), DXL_HIBYTE(DXL_LOWORD(data)),
+                       DXL_LOBYTE(DXL_HIWORD(data)), DXL_HIBYTE(DXL_HIWORD(data)) };
+  return writeTxOnly(port, id, address, 4, _data);
+}
+
+int FlatPacketHandler::write4ByteTxRx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint32_t data, uint8_t *error)
+{
+  uint8_t _data[4] = { DXL_LOBYTE(DXL_LOWORD(data)), DXL_HIBYTE(DXL_LOWORD(data)),
+                       DXL_LOBYTE(DXL_HIWORD(data)), DXL_HIBYTE(DXL_HIWORD(data)) };
+  return writeTxRx(port, id, address, 4, _data, error);
+}
+
+int FlatPacketHandler::regWriteTxOnly(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+  if (makeWriteParam(_buffer->param, address, length, data) == false)
+    return COMM_TX_ERROR;
+
+  int _result = transmit(port, _buffer, id, P2_INST_REG_WRITE, _buffer->param, 2 + length);
+  port->is_using_ = false;
+  return _result;
+}
+
+int FlatPacketHandler::regWriteTxRx(dynamixel::PortHandler *port, uint8_t id, uint16_t address, uint16_t length, uint8_t *data, uint8_t *error)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+  if (makeWriteParam(_buffer->param, address, length, data) == false)
+    return COMM_TX_ERROR;
+
+  return transact(port, _buffer, id, P2_INST_REG_WRITE, _buffer->param, 2 + length, error);
+}
+
+int FlatPacketHandler::syncReadTx(dynamixel::PortHandler *port, uint16_t start_address, uint16_t data_length, uint8_t *param, uint16_t param_length)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+  if (makeSyncParam(_buffer->param, start_address, data_length, param, param_length) == false)
+    return COMM_TX_ERROR;
+
+  int _result = transmit(port, _buffer, P2_BROADCAST_ID, P2_INST_SYNC_READ, _buffer->param, 4 + param_length);
+  if (_result == COMM_SUCCESS)
+    port->setPacketTimeout((uint16_t)((STATUS_MIN_LENGTH + data_length) * param_length));
+  return _result;
+}
+
+int FlatPacketHandler::syncWriteTxOnly(dynamixel::PortHandler *port, uint16_t start_address, uint16_t data_length, uint8_t *param, uint16_t param_length)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+  if (makeSyncParam(_buffer->param, start_address, data_length, param, param_length) == false)
+    return COMM_TX_ERROR;
+
+  return transact(port, _buffer, P2_BROADCAST_ID, P2_INST_SYNC_WRITE, _buffer->param, 4 + param_length, 0);
+}
+
+int FlatPacketHandler::bulkReadTx(dynamixel::PortHandler *port, uint8_t *param, uint16_t param_length)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+
+  int _result = transmit(port, _buffer, P2_BROADCAST_ID, P2_INST_BULK_READ, param, param_length);
+  if (_result == COMM_SUCCESS)
+  {
+    // ID, address and length of every device
+    int _wait_length = 0;
+    for (uint16_t i = 0; i + 4 < param_length; i += 5)
+      _wait_length += DXL_MAKEWORD(param[i + 3], param[i + 4]) + 10;
+    port->setPacketTimeout((uint16_t)_wait_length);
+  }
+  return _result;
+}
+
+int FlatPacketHandler::bulkWriteTxOnly(dynamixel::PortHandler *port, uint8_t *param, uint16_t param_length)
+{
+  PortBuffer *_buffer = getBuffer(port);
+  if (_buffer == NULL)
+    return COMM_NOT_AVAILABLE;
+
+  return transact(port, _buffer, P2_BROADCAST_ID, P2_INST_BULK_WRITE, param, param_length, 0);
+}
+
+}
@@ -0,0 +1,68 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include "rh_p12_rn/flat_sync_read.h"
+
+namespace rh_p12_rn
+{
+
+FlatSyncRead::FlatSyncRead(dynamixel::PortHandler *port, dynamixel::PacketHandler *ph, uint16_t start_address, uint16_t data_length)
+  : FlatGroupRead(port, ph),
+    start_address_(start_address),
+    data_length_(data_length)
+{
+  makeParam();
+}
+
+void FlatSyncRead::makeParam()
+{
+  std::vector<uint8_t> _param;
+  _param.reserve(4 + slot_list_.size());
+  _param.push_back(DXL_LOBYTE(start_address_));
+  _param.push_back(DXL_HIBYTE(start_address_));
+  _param.push_back(DXL_LOBYTE(data_length_));
+  _param.push_back(DXL_HIBYTE(data_length_));
+  for (size_t i = 0; i < slot_list_.size(); i++)
+    _param.push_back(slot_list_[i].id);
+
+  makeBuffers(P2_INST_SYNC_READ, _param);
+}
+
+bool FlatSyncRead::addParam(uint8_t id)
+{
+  if (addSlot(id, start_address_, data_length_) == false)
+    return false;
+
+  makeParam();
+  return true;
+}
+
+void FlatSyncRead::removeParam(uint8_t id)
+{
+  if (removeSlot(id) == false)
+    return;
+
+  makeParam();
+}
+
+void FlatSyncRead::clearParam()
+{
+  slot_list_.clear();
+  makeParam();
+}
+
+}
@@ -0,0 +1,257 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <algorithm>
+#include "rh_p12_rn/gripper_group.h"
+#include "rh_p12_rn/protocol2.h"
+
+namespace rh_p12_rn
+{
+
+GripperGroup::GripperGroup(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, const ControlTable &table)
+  : ph_(ph),
+    port_(port),
+    table_(table),
+    indirect_map_(NULL),
+    motion_read_(NULL),
+    motion_layout_(table),
+    position_write_(port, ph, table.addr_goal_position, LEN_GOAL_POSITION),
+    current_write_(port, ph, table.addr_goal_current, LEN_GOAL_CURRENT)
+{
+}
+
+GripperGroup::~GripperGroup()
+{
+  delete motion_read_;
+}
+
+bool GripperGroup::addGripper(uint8_t id)
+{
+  if (std::find(id_list_.begin(), id_list_.end(), id) != id_list_.end())
+    return false;
+
+  id_list_.push_back(id);
+  state_list_.push_back(MotionState());
+  goal_list_.push_back(Goal());
+  if (motion_read_ != NULL)
+    motion_read_->addParam(id);
+  return true;
+}
+
+bool GripperGroup::setIndirectMap(const IndirectMap *map)
+{
+  if (map != NULL &&
+      (map->getMappedAddress(table_.addr_moving, LEN_MOVING) == ADDR_NONE ||
+       map->getMappedAddress(table_.addr_present_position, LEN_PRESENT_POSITION) == ADDR_NONE ||
+       map->getMappedAddress(table_.addr_present_current, LEN_PRESENT_CURRENT) == ADDR_NONE))
+    return false;
+
+  indirect_map_ = map;
+  delete motion_read_;
+  motion_read_  = NULL;
+  return true;
+}
+
+void GripperGroup::makeMotionRead()
+{
+  uint16_t _start, _length;
+
+  if (indirect_map_ != NULL)
+  {
+    _start  = indirect_map_->getDataAddress();
+    _length = indirect_map_->getDataLength();
+    motion_layout_.addr_moving            = indirect_map_->getMappedAddress(table_.addr_moving, LEN_MOVING);
+    motion_layout_.addr_present_position  = indirect_map_->getMappedAddress(table_.addr_present_position, LEN_PRESENT_POSITION);
+    motion_layout_.addr_present_current   = indirect_map_->getMappedAddress(table_.addr_present_current, LEN_PRESENT_CURRENT);
+  }
+  else
+  {
+    // the span holding the three registers (610-622 on RH-P12-RN, 570-583 on RH-P12-RN(A))
+    _start  = std::min(table_.addr_moving, std::min(table_.addr_present_position, table_.addr_present_current));
+    _length = std::max(table_.addr_moving + LEN_MOVING,
+                       std::max(table_.addr_present_position + LEN_PRESENT_POSITION,
+                                table_.addr_present_current + LEN_PRESENT_CURRENT)) - _start;
+    motion_layout_ = MotionLayout(table_);
+  }
+
+  motion_read_ = new FlatSyncRead(port_, ph_, _start, _length);
+  for (size_t i = 0; i < id_list_.size(); i++)
+    motion_read_->addParam(id_list_[i]);
+}
+
+int GripperGroup::readMotionState()
+{
+  int _result = readMotionStateTx();
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  return readMotionStateRx();
+}
+
+int GripperGroup::readMotionStateTx()
+{
+  if (motion_read_ == NULL)
+    makeMotionRead();
+
+  return motion_read_->txPacket();
+}
+
+int GripperGroup::readMotionStateRx()
+{
+  if (motion_read_ == NULL)
+    return COMM_NOT_AVAILABLE;
+
+  int _result = motion_read_->rxPacket();
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  // decoded where the status packets were received
+  for (size_t i = 0; i < id_list_.size(); i++)
+  {
+    if (MotionView(motion_read_->getView(id_list_[i]), motion_layout_).getMotionState(&state_list_[i]) == false)
+      return COMM_RX_CORRUPT;
+  }
+  return COMM_SUCCESS;
+}
+
+void GripperGroup::setGoalPosition(size_t index, int32_t position)
+{
+  uint8_t _data[4] = { DXL_LOBYTE(DXL_LOWORD(position)), DXL_HIBYTE(DXL_LOWORD(position)),
+                       DXL_LOBYTE(DXL_HIWORD(position)), DXL_HIBYTE(DXL_HIWORD(position)) };
+
+  if (position_write_.addParam(id_list_[index], _data) == false)
+    position_write_.changeParam(id_list_[index], _data);
+  goal_list_[index].position      = position;
+  goal_list_[index].has_position  = true;
+}
+
+void GripperGroup::setGoalCurrent(size_t index, int16_t current)
+{
+  uint8_t _data[2] = { DXL_LOBYTE(current), DXL_HIBYTE(current) };
+
+  if (current_write_.addParam(id_list_[index], _data) == false)
+    current_write_.changeParam(id_list_[index], _data);
+  goal_list_[index].current     = current;
+  goal_list_[index].has_current = true;
+}
+
+void GripperGroup::clearGoals()
+{
+  position_write_.clearParam();
+  current_write_.clearParam();
+  for (size_t i = 0; i < goal_list_.size(); i++)
+    goal_list_[i] = Goal();
+}
+
+int GripperGroup::writeGoals()
+{
+  int _result = COMM_SUCCESS;
+
+  // txPacket() refuses an empty group, so it doubles as the "anything set" check
+  int _position_result = position_write_.txPacket();
+  if (_position_result != COMM_NOT_AVAILABLE)
+    _result = _position_result;
+
+  int _current_result = current_write_.txPacket();
+  if (_current_result != COMM_NOT_AVAILABLE && _result == COMM_SUCCESS)
+    _result = _current_result;
+
+  clearGoals();
+  return _result;
+}
+
+void GripperGroup::cancelStagedGoals(size_t count)
+{
+  // the register the goal was staged on gets its present value registered over it
+  for (size_t i = 0; i < count; i++)
+  {
+    const Goal &_goal = goal_list_[i];
+    if (_goal.has_position == false && _goal.has_current == false)
+      continue;
+
+    uint16_t  _address  = _goal.has_position? table_.addr_goal_position : table_.addr_goal_current;
+    uint16_t  _length   = _goal.has_position? LEN_GOAL_POSITION : LEN_GOAL_CURRENT;
+    uint8_t   _data[4];
+    uint8_t   _error    = 0;
+    if (ph_->readTxRx(port_, id_list_[i], _address, _length, _data, &_error) == COMM_SUCCESS &&
+        (_error & ~P2_ERRBIT_ALERT) == 0)
+      ph_->regWriteTxRx(port_, id_list_[i], _address, _length, _data, &_error);
+  }
+}
+
+int GripperGroup::writeGoalsOnAction()
+{
+  int     _result     = COMM_SUCCESS;
+  bool    _is_staged  = false;
+  size_t  _count      = 0;    // grippers reached, the failing one included
+
+  for (size_t i = 0; i < goal_list_.size() && _result == COMM_SUCCESS; i++)
+  {
+    const Goal &_goal = goal_list_[i];
+    uint8_t     _error = 0;
+    _count = i + 1;
+
+    if (_goal.has_position)
+    {
+      if (_goal.has_current)
+        _result = ph_->write2ByteTxRx(port_, id_list_[i], table_.addr_goal_current, (uint16_t)_goal.current, &_error);
+      if (_result == COMM_SUCCESS && (_error & ~P2_ERRBIT_ALERT) == 0)
+      {
+        uint8_t _data[4] = { DXL_LOBYTE(DXL_LOWORD(_goal.position)), DXL_HIBYTE(DXL_LOWORD(_goal.position)),
+                             DXL_LOBYTE(DXL_HIWORD(_goal.position)), DXL_HIBYTE(DXL_HIWORD(_goal.position)) };
+        _result = ph_->regWriteTxRx(port_, id_list_[i], table_.addr_goal_position, LEN_GOAL_POSITION, _data, &_error);
+      }
+    }
+    else if (_goal.has_current)
+    {
+      uint8_t _data[2] = { DXL_LOBYTE(_goal.current), DXL_HIBYTE(_goal.current) };
+      _result = ph_->regWriteTxRx(port_, id_list_[i], table_.addr_goal_current, LEN_GOAL_CURRENT, _data, &_error);
+    }
+    else
+    {
+      continue;
+    }
+
+    // a refused goal would leave that gripper behind the others
+    if (_result == COMM_SUCCESS && (_error & ~P2_ERRBIT_ALERT) != 0)
+      _result = COMM_RX_CORRUPT;
+    _is_staged = true;
+  }
+
+  if (_result != COMM_SUCCESS)
+    cancelStagedGoals(_count);
+  clearGoals();
+  if (_result != COMM_SUCCESS || _is_staged == false)
+    return _result;
+
+  return ph_->action(port_, BROADCAST_ID);
+}
+
+int GripperGroup::writeAll(uint16_t address, uint16_t length, uint32_t value)
+{
+  uint8_t _data[4] = { DXL_LOBYTE(DXL_LOWORD(value)), DXL_HIBYTE(DXL_LOWORD(value)),
+                       DXL_LOBYTE(DXL_HIWORD(value)), DXL_HIBYTE(DXL_HIWORD(value)) };
+
+  if (length == 0 || length > 4)
+    return COMM_NOT_AVAILABLE;
+
+  dynamixel::GroupSyncWrite _write(port_, ph_, address, length);
+  for (size_t i = 0; i < id_list_.size(); i++)
+    _write.addParam(id_list_[i], _data);
+  return _write.txPacket();
+}
+
+}
@@ -0,0 +1,217 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <string.h>
+
+#include "rh_p12_rn/indirect_map.h"
+
+namespace rh_p12_rn
+{
+
+IndirectMap::IndirectMap(const ControlTable &table, uint16_t first_slot)
+  : table_(table),
+    first_slot_(first_slot),
+    data_length_(0),
+    is_programmed_(false),
+    last_result_(false)
+{ }
+
+bool IndirectMap::addParam(uint16_t address, uint16_t length)
+{
+  if (address == ADDR_NONE || length == 0 || findEntry(address, length) != NULL)
+    return false;
+  if (first_slot_ + data_length_ + length > table_.indirect_slot_count)
+    return false;
+
+  Entry _entry;
+  _entry.address  = address;
+  _entry.length   = length;
+  _entry.offset   = data_length_;
+  entry_list_.push_back(_entry);
+
+  data_length_ += length;
+  data_.assign(data_length_, 0);
+
+  is_programmed_  = false;
+  last_result_    = false;
+  return true;
+}
+
+void IndirectMap::clearParam()
+{
+  entry_list_.clear();
+  data_.clear();
+  data_length_    = 0;
+  is_programmed_  = false;
+  last_result_    = false;
+}
+
+int IndirectMap::program(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id, uint8_t *error)
+{
+  if (data_length_ == 0)
+    return COMM_NOT_AVAILABLE;
+
+  // two bytes of indirect address per mapped byte
+  std::vector<uint8_t> _wanted(data_length_ * 2);
+  for (size_t i = 0; i < entry_list_.size(); i++)
+  {
+    for (uint16_t b = 0; b < entry_list_[i].length; b++)
+    {
+      uint16_t _slot = entry_list_[i].offset + b;
+      _wanted[_slot * 2]      = DXL_LOBYTE(entry_list_[i].address + b);
+      _wanted[_slot * 2 + 1]  = DXL_HIBYTE(entry_list_[i].address + b);
+    }
+  }
+
+  uint16_t _address = table_.addr_indirect_address + first_slot_ * 2;
+  std::vector<uint8_t> _current(_wanted.size());
+
+  int _result = ph->readTxRx(port, id, _address, (uint16_t)_current.size(), &_current[0], error);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  // the table lives in EEPROM, so avoid rewriting an identical mapping
+  if (memcmp(&_current[0], &_wanted[0], _wanted.size()) != 0)
+  {
+    _result = ph->writeTxRx(port, id, _address, (uint16_t)_wanted.size(), &_wanted[0], error);
+    if (_result != COMM_SUCCESS)
+      return _result;
+  }
+
+  is_programmed_ = true;
+  return COMM_SUCCESS;
+}
+
+int IndirectMap::txRxPacket(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id, uint8_t *error)
+{
+  last_result_ = false;
+  if (is_programmed_ == false)
+    return COMM_NOT_AVAILABLE;
+
+  int _result = ph->readTxRx(port, id, getDataAddress(), data_length_, &data_[0], error);
+  if (_result == COMM_SUCCESS)
+    last_result_ = true;
+  return _result;
+}
+
+int IndirectMap::txPacket(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id)
+{
+  last_result_ = false;
+  if (is_programmed_ == false)
+    return COMM_NOT_AVAILABLE;
+
+  return ph->readTx(port, id, getDataAddress(), data_length_);
+}
+
+int IndirectMap::rxPacket(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id, uint8_t *error)
+{
+  last_result_ = false;
+  if (is_programmed_ == false)
+    return COMM_NOT_AVAILABLE;
+
+  int _result = ph->readRx(port, id, data_length_, &data_[0], error);
+  if (_result == COMM_SUCCESS)
+    last_result_ = true;
+  return _result;
+}
+
+const IndirectMap::Entry *IndirectMap::findEntry(uint16_t address, uint16_t length) const
+{
+  for (size_t i = 0; i < entry_list_.size(); i++)
+  {
+    if (address >= entry_list_[i].address &&
+        address + length <= entry_list_[i].address + entry_list_[i].length)
+      return &entry_list_[i];
+  }
+  return NULL;
+}
+
+bool IndirectMap::isAvailable(uint16_t address, uint16_t length) const
+{
+  return last_result_ && findEntry(address, length) != NULL;
+}
+
+uint32_t IndirectMap::getData(uint16_t address, uint16_t length) const
+{
+  const Entry *_entry = findEntry(address, length);
+  if (last_result_ == false || _entry == NULL)
+    return 0;
+
+  const uint8_t *_p = &data_[_entry->offset + (address - _entry->address)];
+  switch (length)
+  {
+    case 1:
+      return _p[0];
+    case 2:
+      return DXL_MAKEWORD(_p[0], _p[1]);
+    case 4:
+      return DXL_MAKEDWORD(DXL_MAKEWORD(_p[0], _p[1]), DXL_MAKEWORD(_p[2], _p[3]));
+    default:
+      return 0;
+  }
+}
+
+uint16_t IndirectMap::getMappedAddress(uint16_t address, uint16_t length) const
+{
+  const Entry *_entry = findEntry(address, length);
+  if (_entry == NULL)
+    return ADDR_NONE;
+
+  return getDataAddress() + _entry->offset + (address - _entry->address);
+}
+
+static int decodeMotionState(const IndirectMap &map, MotionState *state)
+{
+  const ControlTable &_table = map.getControlTable();
+
+  if (map.isAvailable(_table.addr_moving, LEN_MOVING) == false ||
+      map.isAvailable(_table.addr_present_position, LEN_PRESENT_POSITION) == false ||
+      map.isAvailable(_table.addr_present_current, LEN_PRESENT_CURRENT) == false)
+    return COMM_NOT_AVAILABLE;
+
+  state->moving           = (uint8_t)map.getData(_table.addr_moving, LEN_MOVING);
+  state->present_position = (int32_t)map.getData(_table.addr_present_position, LEN_PRESENT_POSITION);
+  state->present_current  = (int16_t)map.getData(_table.addr_present_current, LEN_PRESENT_CURRENT);
+  return COMM_SUCCESS;
+}
+
+int readMotionState(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                    IndirectMap &map, MotionState *state, uint8_t *error)
+{
+  int _result = map.txRxPacket(ph, port, id, error);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  return decodeMotionState(map, state);
+}
+
+int readMotionStateTx(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                      IndirectMap &map)
+{
+  return map.txPacket(ph, port, id);
+}
+
+int readMotionStateRx(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                      IndirectMap &map, MotionState *state, uint8_t *error)
+{
+  int _result = map.rxPacket(ph, port, id, error);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  return decodeMotionState(map, state);
+}
+
+}
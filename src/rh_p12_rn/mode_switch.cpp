@@ -0,0 +1,129 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <string.h>
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/mode_switch.h"
+#include "rh_p12_rn/protocol2.h"
+
+namespace rh_p12_rn
+{
+
+// the goal registers restored after the switch, one contiguous span on both models
+// (600-609 on RH-P12-RN, 548-559 on RH-P12-RN(A))
+static void getGoalRange(const ControlTable &table, uint16_t *start_address, uint16_t *data_length)
+{
+  const uint16_t _address[4] = { table.addr_goal_pwm, table.addr_goal_current, table.addr_goal_velocity, table.addr_goal_acceleration };
+  const uint16_t _length[4]  = { LEN_GOAL_PWM, LEN_GOAL_CURRENT, LEN_GOAL_VELOCITY, LEN_GOAL_ACCELERATION };
+
+  uint16_t _start = 0xFFFF;
+  uint16_t _end   = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    if (_address[i] == ADDR_NONE)
+      continue;
+    if (_address[i] < _start)
+      _start = _address[i];
+    if (_address[i] + _length[i] > _end)
+      _end = _address[i] + _length[i];
+  }
+
+  *start_address  = _start;
+  *data_length    = _end - _start;
+}
+
+// writes one byte, then reads it back until the gripper reports the value
+static int writeConfirmed(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                          uint16_t address, uint8_t value, uint64_t deadline_usec, ModeSwitchStats *stats)
+{
+  int     _result     = COMM_SUCCESS;
+  bool    _is_written = false;
+  uint8_t _error      = 0;
+  uint8_t _value      = 0;
+
+  while (true)
+  {
+    // a status packet without an error number means the write was accepted
+    if (_is_written == false)
+    {
+      _result = ph->write1ByteTxRx(port, id, address, value, &_error);
+      stats->write_count++;
+      _is_written = (_result == COMM_SUCCESS && (_error & ~P2_ERRBIT_ALERT) == 0);
+    }
+
+    if (_is_written)
+    {
+      _result = ph->read1ByteTxRx(port, id, address, &_value, &_error);
+      stats->poll_count++;
+      if (_result == COMM_SUCCESS && _value == value)
+        return COMM_SUCCESS;
+    }
+
+    if (getMonotonicTimeUsec() >= deadline_usec)
+      return (_result != COMM_SUCCESS)? _result : COMM_RX_TIMEOUT;
+  }
+}
+
+int switchOperatingMode(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                        const ControlTable &table, uint8_t mode, bool torque_on,
+                        int32_t goal_current, ModeSwitchStats *stats, uint32_t timeout_usec)
+{
+  ModeSwitchStats _stats;
+  if (stats == 0)
+    stats = &_stats;
+  memset(stats, 0, sizeof(ModeSwitchStats));
+
+  uint64_t _start_usec  = getMonotonicTimeUsec();
+  uint64_t _deadline    = _start_usec + timeout_usec;
+
+  uint16_t _goal_address, _goal_length;
+  uint8_t  _goal_data[16];
+  getGoalRange(table, &_goal_address, &_goal_length);
+
+  int _result = ph->readTxRx(port, id, _goal_address, _goal_length, _goal_data);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  // Operating Mode is in the EEPROM area, which is locked while torque is on
+  _result = writeConfirmed(ph, port, id, table.addr_torque_enable, 0, _deadline, stats);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  _result = writeConfirmed(ph, port, id, table.addr_operating_mode, mode, _deadline, stats);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  if (torque_on)
+  {
+    _result = writeConfirmed(ph, port, id, table.addr_torque_enable, 1, _deadline, stats);
+    if (_result != COMM_SUCCESS)
+      return _result;
+  }
+
+  if (goal_current != KEEP_GOAL_CURRENT)
+  {
+    uint16_t _offset = table.addr_goal_current - _goal_address;
+    _goal_data[_offset]     = DXL_LOBYTE((uint16_t)goal_current);
+    _goal_data[_offset + 1] = DXL_HIBYTE((uint16_t)goal_current);
+  }
+
+  _result = ph->writeTxRx(port, id, _goal_address, _goal_length, _goal_data);
+  stats->write_count++;
+  stats->elapsed_usec = getMonotonicTimeUsec() - _start_usec;
+  return _result;
+}
+
+}
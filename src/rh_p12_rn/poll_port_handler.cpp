@@ -0,0 +1,310 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <asm/termbits.h>     // termios2 : <termios.h> cannot be included along with it
+#include <linux/serial.h>
+
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/poll_port_handler.h"
+
+#define LATENCY_TIMER           16      // ms, the packet timeout margin of PortHandlerLinux
+#define LOW_LATENCY_TIMER       1       // ms, usb-serial latency_timer set at open
+
+namespace rh_p12_rn
+{
+
+PollPortHandler::PollPortHandler(const char *port_name)
+  : socket_fd_(-1),
+    baudrate_(DEFAULT_BAUDRATE_),
+    byte_time_nsec_(0),
+    deadline_nsec_(0),
+    is_low_latency_enabled_(true),
+    was_low_latency_(false),
+    saved_latency_timer_(-1)
+{
+  state_.is_low_latency     = false;
+  state_.latency_timer_msec = -1;
+  state_.is_custom_baudrate = false;
+  is_using_ = false;
+  setPortName(port_name);
+}
+
+bool PollPortHandler::openPort()
+{
+  return setBaudRate(baudrate_);
+}
+
+void PollPortHandler::closePort()
+{
+  if (socket_fd_ != -1)
+  {
+    restoreLowLatency();
+    close(socket_fd_);
+  }
+  socket_fd_ = -1;
+}
+
+void PollPortHandler::clearPort()
+{
+  ioctl(socket_fd_, TCFLSH, TCIFLUSH);
+}
+
+void PollPortHandler::setPortName(const char *port_name)
+{
+  strncpy(port_name_, port_name, sizeof(port_name_) - 1);
+  port_name_[sizeof(port_name_) - 1] = 0;
+}
+
+char *PollPortHandler::getPortName()
+{
+  return port_name_;
+}
+
+bool PollPortHandler::setBaudRate(const int baudrate)
+{
+  closePort();
+  if (baudrate <= 0)
+    return false;
+
+  baudrate_ = baudrate;
+  return setupPort();
+}
+
+int PollPortHandler::getBaudRate()
+{
+  return baudrate_;
+}
+
+int PollPortHandler::getBytesAvailable()
+{
+  int _bytes_available = 0;
+  ioctl(socket_fd_, FIONREAD, &_bytes_available);
+  return _bytes_available;
+}
+
+int PollPortHandler::readPort(uint8_t *packet, int length)
+{
+  ssize_t _length = read(socket_fd_, packet, length);
+  if (_length > 0 || deadline_nsec_ == 0)
+    return (_length > 0)? (int)_length:0;
+
+  // nothing yet : sleep until the first byte or the deadline
+  uint64_t _now = getMonotonicTimeNsec();
+  if (_now >= deadline_nsec_)
+    return 0;
+
+  struct pollfd   _fd = { socket_fd_, POLLIN, 0 };
+  struct timespec _timeout;
+  _timeout.tv_sec   = (deadline_nsec_ - _now) / 1000000000ULL;
+  _timeout.tv_nsec  = (deadline_nsec_ - _now) % 1000000000ULL;
+  if (ppoll(&_fd, 1, &_timeout, NULL) <= 0 || (_fd.revents & POLLIN) == 0)
+    return 0;
+
+  _length = read(socket_fd_, packet, length);
+  return (_length > 0)? (int)_length:0;
+}
+
+int PollPortHandler::writePort(uint8_t *packet, int length)
+{
+  // a new transaction : the deadline of the last one must not hold up a reply-less write
+  deadline_nsec_ = 0;
+  return (int)write(socket_fd_, packet, length);
+}
+
+void PollPortHandler::setPacketTimeout(uint16_t packet_length)
+{
+  // PortHandlerLinux : wire time of the packet + 2 x latency timer + 2 ms, with the
+  // adapter's own latency timer when it is known
+  int _latency_timer = (state_.latency_timer_msec >= 0)? state_.latency_timer_msec : LATENCY_TIMER;
+  deadline_nsec_ = getMonotonicTimeNsec() + byte_time_nsec_ * packet_length + (_latency_timer * 2 + 2) * 1000000ULL;
+}
+
+void PollPortHandler::setPacketTimeout(double msec)
+{
+  deadline_nsec_ = getMonotonicTimeNsec() + (uint64_t)(msec * 1e6);
+}
+
+bool PollPortHandler::isPacketTimeout()
+{
+  if (deadline_nsec_ != 0 && getMonotonicTimeNsec() > deadline_nsec_)
+  {
+    deadline_nsec_ = 0;
+    return true;
+  }
+  return false;
+}
+
+bool PollPortHandler::setupPort()
+{
+  struct termios2 _newtio;
+
+  socket_fd_ = open(port_name_, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (socket_fd_ < 0)
+  {
+    printf("[PollPortHandler::setupPort] Error opening serial port!\n");
+    return false;
+  }
+
+  // the standard rates keep their B constant, so the other end of a pty still reads them
+  tcflag_t _cflag_baud;
+  switch (baudrate_)
+  {
+    case 9600:      _cflag_baud = B9600;    break;
+    case 19200:     _cflag_baud = B19200;   break;
+    case 38400:     _cflag_baud = B38400;   break;
+    case 57600:     _cflag_baud = B57600;   break;
+    case 115200:    _cflag_baud = B115200;  break;
+    case 230400:    _cflag_baud = B230400;  break;
+    case 460800:    _cflag_baud = B460800;  break;
+    case 500000:    _cflag_baud = B500000;  break;
+    case 576000:    _cflag_baud = B576000;  break;
+    case 921600:    _cflag_baud = B921600;  break;
+    case 1000000:   _cflag_baud = B1000000; break;
+    case 1152000:   _cflag_baud = B1152000; break;
+    case 1500000:   _cflag_baud = B1500000; break;
+    case 2000000:   _cflag_baud = B2000000; break;
+    case 2500000:   _cflag_baud = B2500000; break;
+    case 3000000:   _cflag_baud = B3000000; break;
+    case 3500000:   _cflag_baud = B3500000; break;
+    case 4000000:   _cflag_baud = B4000000; break;
+    default:        _cflag_baud = BOTHER;   break;
+  }
+
+  memset(&_newtio, 0, sizeof(_newtio));
+  _newtio.c_cflag   = _cflag_baud | CS8 | CLOCAL | CREAD;
+  _newtio.c_iflag   = IGNPAR;
+  _newtio.c_oflag   = 0;
+  _newtio.c_lflag   = 0;
+  _newtio.c_ispeed  = baudrate_;
+  _newtio.c_ospeed  = baudrate_;
+  _newtio.c_cc[VTIME] = 0;
+  _newtio.c_cc[VMIN]  = 0;
+
+  ioctl(socket_fd_, TCFLSH, TCIFLUSH);
+  if (ioctl(socket_fd_, TCSETS2, &_newtio) != 0)
+  {
+    printf("[PollPortHandler::setupPort] %s does not take %d bps (%s)\n", port_name_, baudrate_, strerror(errno));
+    close(socket_fd_);
+    socket_fd_ = -1;
+    return false;
+  }
+  state_.is_custom_baudrate = (_cflag_baud == BOTHER);
+
+  // 10 bits per byte : start, 8 data, stop
+  byte_time_nsec_ = 10000000000ULL / baudrate_;
+  deadline_nsec_  = 0;
+
+  if (is_low_latency_enabled_)
+    applyLowLatency();
+  return true;
+}
+
+void PollPortHandler::applyLowLatency()
+{
+  struct serial_struct _serial;
+
+  was_low_latency_      = false;
+  state_.is_low_latency = false;
+  if (ioctl(socket_fd_, TIOCGSERIAL, &_serial) == 0)
+  {
+    was_low_latency_ = (_serial.flags & ASYNC_LOW_LATENCY) != 0;
+    _serial.flags   |= ASYNC_LOW_LATENCY;
+    state_.is_low_latency = was_low_latency_ || ioctl(socket_fd_, TIOCSSERIAL, &_serial) == 0;
+  }
+  if (state_.is_low_latency == false)
+    printf("[PollPortHandler::openPort] could not set ASYNC_LOW_LATENCY on %s (%s)\n", port_name_, strerror(errno));
+
+  // usb-serial adapters only (FTDI, CP210x ...) : nothing to report for the others
+  char _path[PATH_MAX];
+  saved_latency_timer_      = -1;
+  state_.latency_timer_msec = -1;
+  if (getLatencyTimerPath(_path, sizeof(_path)) == false)
+    return;
+
+  FILE *_fp = fopen(_path, "r");
+  if (_fp == NULL || fscanf(_fp, "%d", &state_.latency_timer_msec) != 1)
+    state_.latency_timer_msec = -1;
+  if (_fp != NULL)
+    fclose(_fp);
+  if (state_.latency_timer_msec <= LOW_LATENCY_TIMER)
+    return;
+
+  _fp = fopen(_path, "w");
+  if (_fp != NULL && fprintf(_fp, "%d", LOW_LATENCY_TIMER) > 0 && fclose(_fp) == 0)
+  {
+    saved_latency_timer_      = state_.latency_timer_msec;
+    state_.latency_timer_msec = LOW_LATENCY_TIMER;
+    return;
+  }
+  printf("[PollPortHandler::openPort] latency_timer of %s stays %d ms : %s is not writable (%s)\n",
+         port_name_, state_.latency_timer_msec, _path, strerror(errno));
+}
+
+void PollPortHandler::restoreLowLatency()
+{
+  struct serial_struct _serial;
+
+  if (state_.is_low_latency && was_low_latency_ == false && ioctl(socket_fd_, TIOCGSERIAL, &_serial) == 0)
+  {
+    _serial.flags &= ~ASYNC_LOW_LATENCY;
+    ioctl(socket_fd_, TIOCSSERIAL, &_serial);
+  }
+  state_.is_low_latency = false;
+
+  char _path[PATH_MAX];
+  if (saved_latency_timer_ >= 0 && getLatencyTimerPath(_path, sizeof(_path)))
+  {
+    FILE *_fp = fopen(_path, "w");
+    if (_fp != NULL)
+    {
+      fprintf(_fp, "%d", saved_latency_timer_);
+      fclose(_fp);
+    }
+  }
+  saved_latency_timer_      = -1;
+  state_.latency_timer_msec = -1;
+}
+
+bool PollPortHandler::getLatencyTimerPath(char *path, size_t size)
+{
+  // /dev/serial/by-id/... links resolve to /dev/ttyUSB<n>
+  char _device[PATH_MAX];
+  if (realpath(port_name_, _device) == NULL)
+    return false;
+
+  const char *_name = strrchr(_device, '/');
+  int _length = snprintf(path, size, "/sys/bus/usb-serial/devices/%s/latency_timer", (_name != NULL)? _name + 1 : _device);
+  if (_length < 0 || (size_t)_length >= size)
+    return false;
+  return access(path, F_OK) == 0;
+}
+
+}
+
+#endif /* __linux__ */
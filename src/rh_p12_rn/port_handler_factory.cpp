@@ -0,0 +1,83 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+
+#include <string.h>
+
+#include "rh_p12_rn/adaptive_port_handler.h"
+#include "rh_p12_rn/poll_port_handler.h"
+#include "rh_p12_rn/port_handler_factory.h"
+#include "rh_p12_rn/sim_port_handler.h"
+
+namespace rh_p12_rn
+{
+
+typedef dynamixel::PortHandler *(*PortOpener)(const char *port_name, const ControlTable &table);
+
+struct PortVariant
+{
+  const char *prefix;
+  PortOpener  open;
+};
+
+static dynamixel::PortHandler *openSimPort(const char *port_name, const ControlTable &table)
+{
+  return getSimPortHandler(port_name, table);
+}
+
+static dynamixel::PortHandler *openAdaptivePort(const char *port_name, const ControlTable &table)
+{
+  return new AdaptivePortHandler(getPortHandler(port_name + strlen(ADAPTIVE_PORT_PREFIX), table));
+}
+
+#if defined(__linux__)
+static dynamixel::PortHandler *openPollPort(const char *port_name, const ControlTable &)
+{
+  return new PollPortHandler(port_name + strlen(POLL_PORT_PREFIX));
+}
+#endif
+
+// every port variant opened by name
+static const PortVariant PORT_VARIANT_LIST[] =
+{
+  { SIM_PORT_PREFIX,      openSimPort },
+  { ADAPTIVE_PORT_PREFIX, openAdaptivePort },
+#if defined(__linux__)
+  { POLL_PORT_PREFIX,     openPollPort },
+#endif
+};
+
+// a prefix not ending in ':' must be the whole name or be followed by ':'
+static bool hasPrefix(const char *port_name, const char *prefix)
+{
+  size_t _length = strlen(prefix);
+  if (strncmp(port_name, prefix, _length) != 0)
+    return false;
+  return prefix[_length - 1] == ':' || port_name[_length] == 0 || port_name[_length] == ':';
+}
+
+dynamixel::PortHandler *getPortHandler(const char *port_name, const ControlTable &table)
+{
+  for (size_t i = 0; i < sizeof(PORT_VARIANT_LIST) / sizeof(PORT_VARIANT_LIST[0]); i++)
+  {
+    if (hasPrefix(port_name, PORT_VARIANT_LIST[i].prefix))
+      return PORT_VARIANT_LIST[i].open(port_name, table);
+  }
+  return dynamixel::PortHandler::getPortHandler(port_name);
+}
+
+}
@@ -0,0 +1,152 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <string.h>
+
+#include "rh_p12_rn/protocol2.h"
+
+namespace rh_p12_rn
+{
+
+size_t buildPacket(uint8_t id, uint8_t instruction, const uint8_t *payload, size_t payload_length, uint8_t *packet)
+{
+  packet[P2_HEADER0]      = 0xFF;
+  packet[P2_HEADER1]      = 0xFF;
+  packet[P2_HEADER2]      = 0xFD;
+  packet[P2_RESERVED]     = 0x00;
+  packet[P2_ID]           = id;
+  packet[P2_INSTRUCTION]  = instruction;
+
+  // byte stuffing : 0xFD is inserted after every FF FF FD in the payload
+  size_t  _index    = P2_INSTRUCTION + 1;
+  uint8_t _prev[2]  = { 0x00, instruction };
+  for (size_t i = 0; i < payload_length; i++)
+  {
+    // room for this byte, a stuffing byte and the CRC
+    if (_index + 4 > P2_MAX_PACKET_LENGTH)
+      return 0;
+
+    packet[_index++] = payload[i];
+    if (_prev[0] == 0xFF && _prev[1] == 0xFF && payload[i] == 0xFD)
+    {
+      packet[_index++] = 0xFD;
+      _prev[0] = 0xFD;
+      _prev[1] = 0xFD;
+    }
+    else
+    {
+      _prev[0] = _prev[1];
+      _prev[1] = payload[i];
+    }
+  }
+
+  uint16_t _length = (uint16_t)(_index - P2_INSTRUCTION + 2);
+  packet[P2_LENGTH_L] = (uint8_t)(_length & 0xFF);
+  packet[P2_LENGTH_H] = (uint8_t)(_length >> 8);
+
+  uint16_t _crc = updateCRC(0, packet, _index);
+  packet[_index++] = (uint8_t)(_crc & 0xFF);
+  packet[_index++] = (uint8_t)(_crc >> 8);
+
+  return _index;
+}
+
+size_t findPacket(const uint8_t *data, size_t length, size_t *start, uint64_t *crc_error_count)
+{
+  size_t _start = 0;
+  while (true)
+  {
+    // find the header
+    while (_start + 3 <= length &&
+           !(data[_start] == 0xFF && data[_start + 1] == 0xFF && data[_start + 2] == 0xFD))
+      _start++;
+    *start = _start;
+
+    if (_start + P2_HEADER_LENGTH > length)
+      return 0;
+
+    const uint8_t *_packet = data + _start;
+    size_t _length = _packet[P2_LENGTH_L] | (_packet[P2_LENGTH_H] << 8);
+    if (_packet[P2_RESERVED] == 0xFD || _length < 3 || P2_HEADER_LENGTH + _length > P2_MAX_PACKET_LENGTH)
+    {
+      // not a header after all
+      _start++;
+      continue;
+    }
+    if (_start + P2_HEADER_LENGTH + _length > length)
+      return 0;
+
+    size_t    _packet_length  = P2_HEADER_LENGTH + _length;
+    uint16_t  _crc            = _packet[_packet_length - 2] | (_packet[_packet_length - 1] << 8);
+    if (updateCRC(0, _packet, _packet_length - 2) != _crc)
+    {
+      if (crc_error_count != 0)
+        (*crc_error_count)++;
+      _start++;
+      continue;
+    }
+    return _packet_length;
+  }
+}
+
+size_t unstuffPacket(const uint8_t *packet, size_t packet_length, uint8_t *out)
+{
+  size_t _index = P2_INSTRUCTION;
+  memcpy(out, packet, P2_INSTRUCTION);
+  for (size_t i = P2_INSTRUCTION; i < packet_length - 2; i++)
+  {
+    if (i >= P2_INSTRUCTION + 3 && packet[i] == 0xFD &&
+        packet[i - 1] == 0xFD && packet[i - 2] == 0xFF && packet[i - 3] == 0xFF)
+      continue;
+    out[_index++] = packet[i];
+  }
+  out[_index++] = packet[packet_length - 2];
+  out[_index++] = packet[packet_length - 1];
+
+  size_t _length = _index - P2_HEADER_LENGTH;
+  out[P2_LENGTH_L] = (uint8_t)(_length & 0xFF);
+  out[P2_LENGTH_H] = (uint8_t)(_length >> 8);
+  return _index;
+}
+
+PacketStream::PacketStream()
+  : crc_error_count_(0)
+{ }
+
+void PacketStream::append(const uint8_t *data, size_t length)
+{
+  buffer_.insert(buffer_.end(), data, data + length);
+}
+
+bool PacketStream::pop(std::vector<uint8_t> *packet)
+{
+  size_t _start         = 0;
+  size_t _packet_length = buffer_.empty()? 0 : findPacket(&buffer_[0], buffer_.size(), &_start, &crc_error_count_);
+  if (_packet_length == 0)
+  {
+    buffer_.erase(buffer_.begin(), buffer_.begin() + _start);
+    return false;
+  }
+
+  packet->resize(_packet_length);
+  packet->resize(unstuffPacket(&buffer_[_start], _packet_length, &(*packet)[0]));
+
+  buffer_.erase(buffer_.begin(), buffer_.begin() + _start + _packet_length);
+  return true;
+}
+
+}
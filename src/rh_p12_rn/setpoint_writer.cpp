@@ -0,0 +1,305 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <string.h>
+#include <chrono>
+
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/setpoint_writer.h"
+
+namespace rh_p12_rn
+{
+
+SetpointWriter::SetpointWriter(BusOwner *bus, uint8_t id, uint32_t interval_usec)
+  : bus_(bus),
+    id_list_(1, id),
+    interval_usec_(interval_usec),
+    shadow_(NULL),
+    thread_(NULL),
+    is_running_(false),
+    set_sequence_(0),
+    written_sequence_(0),
+    last_write_usec_(0)
+{
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+SetpointWriter::SetpointWriter(BusOwner *bus, const std::vector<uint8_t> &id_list, uint32_t interval_usec)
+  : bus_(bus),
+    id_list_(id_list),
+    interval_usec_(interval_usec),
+    shadow_(NULL),
+    thread_(NULL),
+    is_running_(false),
+    set_sequence_(0),
+    written_sequence_(0),
+    last_write_usec_(0)
+{
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+bool SetpointWriter::addRegister(uint16_t address, uint16_t length, bool is_shared)
+{
+  if (length == 0 || length > 4)
+    return false;
+
+  std::vector<Register>::iterator _it = register_list_.begin();
+  while (_it != register_list_.end() && _it->address < address)
+    _it++;
+  if (_it != register_list_.end() && address + length > _it->address)
+    return false;
+  if (_it != register_list_.begin() && (_it - 1)->address + (_it - 1)->length > address)
+    return false;
+
+  Register _register = { address, length, 0, is_shared, false, false };
+  register_list_.insert(_it, _register);
+  return true;
+}
+
+SetpointWriter::Register *SetpointWriter::findRegister(uint16_t address)
+{
+  for (size_t i = 0; i < register_list_.size(); i++)
+  {
+    if (register_list_[i].address == address)
+      return &register_list_[i];
+  }
+  return NULL;
+}
+
+bool SetpointWriter::isDirty() const
+{
+  for (size_t i = 0; i < register_list_.size(); i++)
+  {
+    if (register_list_[i].is_dirty)
+      return true;
+  }
+  return false;
+}
+
+void SetpointWriter::start()
+{
+  if (thread_ != NULL)
+    return;
+
+  is_running_ = true;
+  thread_     = new std::thread(&SetpointWriter::run, this);
+}
+
+void SetpointWriter::stop()
+{
+  if (thread_ == NULL)
+    return;
+
+  {
+    std::lock_guard<std::mutex> _lock(mutex_);
+    is_running_ = false;
+  }
+  cond_.notify_all();
+
+  thread_->join();
+  delete thread_;
+  thread_ = NULL;
+}
+
+bool SetpointWriter::set(uint16_t address, int32_t value)
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+
+  Register *_register = findRegister(address);
+  if (_register == NULL)
+    return false;
+
+  stats_.set_count++;
+  if (shadow_ != NULL && shadow_->write(address, value) == false &&
+      (_register->is_dirty == false || _register->value == value))
+  {
+    stats_.elided_count++;  // already held, or already on its way
+    return true;
+  }
+
+  _register->value    = value;
+  _register->is_known = true;
+  _register->is_dirty = true;
+  set_sequence_++;
+
+  cond_.notify_all();
+  return true;
+}
+
+bool SetpointWriter::seed(uint16_t address, int32_t value)
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+
+  Register *_register = findRegister(address);
+  if (_register == NULL)
+    return false;
+
+  if (_register->is_dirty == false)
+  {
+    _register->value    = value;
+    _register->is_known = true;
+  }
+  return true;
+}
+
+void SetpointWriter::flush()
+{
+  std::unique_lock<std::mutex> _lock(mutex_);
+
+  if (thread_ == NULL)
+  {
+    // not started : write on the caller's thread
+    std::vector<Register> _snapshot = register_list_;
+    for (size_t i = 0; i < register_list_.size(); i++)
+      register_list_[i].is_dirty = false;
+    written_sequence_ = set_sequence_;
+    _lock.unlock();
+
+    writeRegisters(_snapshot);
+    return;
+  }
+
+  uint64_t _sequence = set_sequence_;
+  last_write_usec_ = 0;   // no need to wait out the interval
+  cond_.notify_all();
+  cond_.wait(_lock, [&]() { return written_sequence_ >= _sequence || is_running_ == false; });
+}
+
+SetpointWriterStats SetpointWriter::getStats()
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+  return stats_;
+}
+
+void SetpointWriter::run()
+{
+  std::unique_lock<std::mutex> _lock(mutex_);
+
+  while (true)
+  {
+    cond_.wait(_lock, [&]() { return is_running_ == false || isDirty(); });
+    if (isDirty() == false)
+      break;  // stopped with nothing left to write
+
+    // keep collecting edits until the interval since the last write has passed
+    while (is_running_ && last_write_usec_ != 0)
+    {
+      uint64_t _now = getMonotonicTimeUsec();
+      if (_now >= last_write_usec_ + interval_usec_)
+        break;
+      cond_.wait_for(_lock, std::chrono::microseconds(last_write_usec_ + interval_usec_ - _now));
+    }
+
+    std::vector<Register> _snapshot = register_list_;
+    uint64_t              _sequence = set_sequence_;
+    for (size_t i = 0; i < register_list_.size(); i++)
+      register_list_[i].is_dirty = false;
+
+    _lock.unlock();
+    writeRegisters(_snapshot);
+    _lock.lock();
+
+    last_write_usec_  = getMonotonicTimeUsec();
+    written_sequence_ = _sequence;
+    cond_.notify_all();
+  }
+
+  written_sequence_ = set_sequence_;
+  cond_.notify_all();
+}
+
+void SetpointWriter::writeRegisters(std::vector<Register> &register_list)
+{
+  uint64_t _packet_count    = 0;
+  uint64_t _register_count  = 0;
+  uint64_t _fail_count      = 0;
+
+  for (size_t i = 0; i < register_list.size(); )
+  {
+    if (register_list[i].is_dirty == false)
+    {
+      i++;
+      continue;
+    }
+
+    uint8_t   _data[64];
+    uint16_t  _length = 0;
+
+    // extend over adjacent registers of known value up to the last dirty one,
+    // carrying a shared register only when it is dirty itself
+    size_t    _last = i;
+    uint16_t  _span = register_list[i].length;
+    for (size_t j = i + 1; j < register_list.size(); j++)
+    {
+      _span += register_list[j].length;
+      if (register_list[j].address != register_list[j - 1].address + register_list[j - 1].length ||
+          register_list[j].is_known == false || _span > sizeof(_data) ||
+          (register_list[j].is_shared && register_list[j].is_dirty == false))
+        break;
+      if (register_list[j].is_dirty)
+        _last = j;
+    }
+
+    for (size_t j = i; j <= _last; j++)
+    {
+      for (uint16_t b = 0; b < register_list[j].length; b++)
+        _data[_length++] = (uint8_t)((uint32_t)register_list[j].value >> (8 * b));
+    }
+
+    uint16_t _address = register_list[i].address;
+    int _result;
+    if (id_list_.size() == 1)
+    {
+      _result = bus_->writeTxRx(id_list_[0], _address, _length, _data);
+    }
+    else
+    {
+      _result = bus_->execute([&](dynamixel::PacketHandler *ph, dynamixel::PortHandler *port)
+      {
+        dynamixel::GroupSyncWrite _write(port, ph, _address, _length);
+        for (size_t k = 0; k < id_list_.size(); k++)
+          _write.addParam(id_list_[k], _data);
+        return _write.txPacket();
+      });
+    }
+
+    _packet_count++;
+    _register_count += _last - i + 1;
+    if (_result != COMM_SUCCESS)
+      _fail_count++;
+
+    if (shadow_ != NULL)
+    {
+      for (size_t j = i; j <= _last; j++)
+      {
+        if (_result == COMM_SUCCESS)
+          shadow_->markWritten(register_list[j].address, register_list[j].value);
+        else
+          shadow_->invalidate(register_list[j].address);
+      }
+    }
+
+    i = _last + 1;
+  }
+
+  std::lock_guard<std::mutex> _lock(mutex_);
+  stats_.packet_count   += _packet_count;
+  stats_.register_count += _register_count;
+  stats_.fail_count     += _fail_count;
+}
+
+}
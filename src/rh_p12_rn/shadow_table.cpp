@@ -0,0 +1,187 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <string.h>
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/shadow_table.h"
+
+namespace rh_p12_rn
+{
+
+static int32_t normalize(int32_t value, uint16_t length)
+{
+  // the bytes the register can hold, sign-extended
+  if (length == 1)
+    return (int8_t)value;
+  if (length == 2)
+    return (int16_t)value;
+  return value;
+}
+
+const uint64_t ShadowTable::NO_MAX_AGE;
+
+ShadowTable::ShadowTable()
+{
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+bool ShadowTable::addRegister(uint16_t address, uint16_t length, const Policy &policy)
+{
+  if (length == 0 || length > 4)
+    return false;
+
+  std::lock_guard<std::mutex> _lock(mutex_);
+
+  std::vector<Register>::iterator _it = register_list_.begin();
+  while (_it != register_list_.end() && _it->address < address)
+    _it++;
+  if (_it != register_list_.end() && address + length > _it->address)
+    return false;
+  if (_it != register_list_.begin() && (_it - 1)->address + (_it - 1)->length > address)
+    return false;
+
+  Register _register = { address, length, policy, 0, false, false, 0 };
+  register_list_.insert(_it, _register);
+  return true;
+}
+
+ShadowTable::Register *ShadowTable::findRegister(uint16_t address)
+{
+  for (size_t i = 0; i < register_list_.size(); i++)
+  {
+    if (register_list_[i].address == address)
+      return &register_list_[i];
+  }
+  return NULL;
+}
+
+bool ShadowTable::read(uint16_t address, int32_t *value)
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+
+  Register *_register = findRegister(address);
+  if (_register == NULL)
+    return false;
+
+  if (_register->is_known && _register->is_dirty == false &&
+      _register->policy.max_age_usec != NO_MAX_AGE &&
+      getMonotonicTimeUsec() - _register->update_usec > _register->policy.max_age_usec)
+  {
+    _register->is_known = false;  // too old to trust
+  }
+
+  if (_register->is_known == false)
+  {
+    stats_.read_miss_count++;
+    return false;
+  }
+
+  *value = _register->value;
+  stats_.read_hit_count++;
+  stats_.saved_bytes += _register->length;
+  return true;
+}
+
+bool ShadowTable::write(uint16_t address, int32_t value)
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+
+  Register *_register = findRegister(address);
+  if (_register == NULL)
+    return true;
+
+  value = normalize(value, _register->length);
+  if (_register->is_known && _register->value == value)
+  {
+    stats_.write_elided_count++;
+    stats_.saved_bytes += _register->length;
+    return false;
+  }
+
+  _register->value    = value;
+  _register->is_known = true;
+  _register->is_dirty = true;
+  stats_.write_count++;
+  return true;
+}
+
+void ShadowTable::markWritten(uint16_t address, int32_t value)
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+
+  Register *_register = findRegister(address);
+  if (_register == NULL)
+    return;
+
+  value = normalize(value, _register->length);
+  if (_register->is_dirty && _register->value != value)
+    return;   // a newer value is on its way
+
+  _register->value        = value;
+  _register->is_known     = true;
+  _register->is_dirty     = false;
+  _register->update_usec  = getMonotonicTimeUsec();
+}
+
+void ShadowTable::update(uint16_t address, int32_t value)
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+
+  Register *_register = findRegister(address);
+  if (_register == NULL || _register->is_dirty)
+    return;
+
+  _register->value        = normalize(value, _register->length);
+  _register->is_known     = true;
+  _register->update_usec  = getMonotonicTimeUsec();
+}
+
+void ShadowTable::invalidate(uint16_t address)
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+
+  Register *_register = findRegister(address);
+  if (_register == NULL || _register->is_known == false)
+    return;
+
+  _register->is_known = false;
+  _register->is_dirty = false;
+  stats_.invalidate_count++;
+}
+
+void ShadowTable::invalidateOn(uint8_t event)
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+
+  for (size_t i = 0; i < register_list_.size(); i++)
+  {
+    Register &_register = register_list_[i];
+    if (_register.is_known && (_register.policy.invalidate_on & event) != 0)
+    {
+      _register.is_known = false;
+      _register.is_dirty = false;
+      stats_.invalidate_count++;
+    }
+  }
+}
+
+ShadowTableStats ShadowTable::getStats()
+{
+  std::lock_guard<std::mutex> _lock(mutex_);
+  return stats_;
+}
+
+}
@@ -0,0 +1,508 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#include "rh_p12_rn/baud_rate.h"
+#include "rh_p12_rn/protocol2.h"
+#include "rh_p12_rn/sim_gripper.h"
+
+#define SIM_FIRMWARE_VERSION    1
+#define SIM_BAUD_RATE_VALUE     4       // 2 Mbps
+#define SIM_RETURN_DELAY_TIME   250     // 500 us
+#define SIM_PRESENT_VOLTAGE     240     // 24.0 V
+#define SIM_PRESENT_TEMPERATURE 30
+#define SIM_MAX_STEP_SEC        0.001
+
+namespace rh_p12_rn
+{
+
+SimGripper::SimGripper(const ControlTable &table, uint8_t id)
+  : table_(table),
+    position_(table.min_position),
+    object_position_(SIM_NO_OBJECT),
+    last_update_nsec_(0),
+    goal_change_nsec_(0),
+    registered_address_(0),
+    is_registered_(false)
+{
+  memset(memory_, 0, sizeof(memory_));
+  memory_[ADDR_ID] = id;
+  factoryReset(P2_RESET_EXCEPT_ID);
+}
+
+void SimGripper::reboot()
+{
+  // the RAM area starts at Torque Enable
+  memset(memory_ + table_.addr_torque_enable, 0, SIM_CONTROL_TABLE_SIZE - table_.addr_torque_enable);
+
+  setValue(table_.addr_goal_current, LEN_GOAL_CURRENT, table_.max_current);
+  setValue(table_.addr_goal_position, LEN_GOAL_POSITION, (int32_t)position_);
+
+  velocity_             = 0.0;
+  present_current_      = 0;
+  goal_change_nsec_     = 0;
+  is_registered_        = false;
+  updatePresent();
+}
+
+uint8_t SimGripper::factoryReset(uint8_t option)
+{
+  if (option != P2_RESET_ALL && option != P2_RESET_EXCEPT_ID && option != P2_RESET_EXCEPT_ID_BAUD)
+    return P2_ERRNUM_DATA_RANGE;
+
+  uint8_t _id         = memory_[ADDR_ID];
+  uint8_t _baud_rate  = memory_[ADDR_BAUD_RATE];
+  memset(memory_, 0, table_.addr_torque_enable);
+
+  setValue(ADDR_MODEL_NUMBER, LEN_MODEL_NUMBER, table_.model_number);
+  memory_[ADDR_FIRMWARE_VERSION]  = SIM_FIRMWARE_VERSION;
+  memory_[ADDR_ID]                = (option == P2_RESET_ALL)? 1 : _id;
+  memory_[ADDR_BAUD_RATE]         = (option == P2_RESET_EXCEPT_ID_BAUD)? _baud_rate : SIM_BAUD_RATE_VALUE;
+  memory_[ADDR_RETURN_DELAY_TIME] = SIM_RETURN_DELAY_TIME;
+  memory_[table_.addr_operating_mode] = 5;
+
+  // every Indirect Address points at its own Indirect Data by default
+  for (uint16_t i = 0; i < table_.indirect_slot_count; i++)
+    setValue(table_.addr_indirect_address + i * 2, 2, table_.addr_indirect_data + i);
+
+  reboot();
+  return 0;
+}
+
+int SimGripper::getBaudRate() const
+{
+  return getBaudRate(memory_[ADDR_BAUD_RATE]);
+}
+
+int SimGripper::getBaudRate(uint8_t baud_rate_value)
+{
+  return getBaudRateOfValue(baud_rate_value);
+}
+
+uint16_t SimGripper::resolveAddress(uint16_t address) const
+{
+  if (address < table_.addr_indirect_data || address >= table_.addr_indirect_data + table_.indirect_slot_count)
+    return address;
+
+  uint16_t _slot    = address - table_.addr_indirect_data;
+  uint16_t _target  = (uint16_t)getValue(table_.addr_indirect_address + _slot * 2, 2);
+  if (_target >= SIM_CONTROL_TABLE_SIZE)
+    return address;
+  return _target;
+}
+
+bool SimGripper::isWritable(uint16_t address) const
+{
+  if (address < ADDR_ID)
+    return false;   // model number, model information, firmware version
+  if (address < table_.addr_torque_enable && memory_[table_.addr_torque_enable] != 0)
+    return false;   // EEPROM area is locked while torque is on
+  if (address >= table_.addr_moving && address <= table_.addr_present_temperature)
+    return false;   // present values
+  return true;
+}
+
+int32_t SimGripper::getValue(uint16_t address, uint16_t length) const
+{
+  uint32_t _value = 0;
+  for (uint16_t i = 0; i < length; i++)
+    _value |= (uint32_t)memory_[address + i] << (8 * i);
+
+  if (length == 1)
+    return (int8_t)_value;
+  if (length == 2)
+    return (int16_t)_value;
+  return (int32_t)_value;
+}
+
+void SimGripper::setValue(uint16_t address, uint16_t length, int32_t value)
+{
+  if (address == ADDR_NONE)
+    return;
+  for (uint16_t i = 0; i < length; i++)
+    memory_[address + i] = (uint8_t)((uint32_t)value >> (8 * i));
+}
+
+void SimGripper::updatePresent()
+{
+  setValue(table_.addr_present_position, LEN_PRESENT_POSITION, (int32_t)lround(position_));
+  setValue(table_.addr_present_velocity, LEN_PRESENT_VELOCITY, (int32_t)lround(velocity_));
+  setValue(table_.addr_present_current, LEN_PRESENT_CURRENT, present_current_);
+  setValue(table_.addr_present_voltage, LEN_PRESENT_VOLTAGE, SIM_PRESENT_VOLTAGE);
+  setValue(table_.addr_present_temperature, LEN_PRESENT_TEMPERATURE, SIM_PRESENT_TEMPERATURE);
+}
+
+void SimGripper::update(uint64_t now_nsec)
+{
+  if (last_update_nsec_ == 0 || now_nsec < last_update_nsec_)
+    last_update_nsec_ = now_nsec;
+
+  double _dt = (now_nsec - last_update_nsec_) / 1e9;
+  last_update_nsec_ = now_nsec;
+  if (_dt <= 0.0)
+    return;
+
+  bool    _torque_on    = memory_[table_.addr_torque_enable] != 0;
+  bool    _current_ctrl = memory_[table_.addr_operating_mode] == 0;
+  int32_t _goal_current = getValue(table_.addr_goal_current, LEN_GOAL_CURRENT);
+  int32_t _goal         = getValue(table_.addr_goal_position, LEN_GOAL_POSITION);
+  bool    _is_blocked   = false;
+
+  _goal_current = std::max(-table_.max_current, std::min(table_.max_current, _goal_current));
+  _goal         = std::max(table_.min_position, std::min(table_.max_position, _goal));
+
+  while (_dt > 0.0)
+  {
+    double _step  = std::min(_dt, SIM_MAX_STEP_SEC);
+    double _speed = 0.0;
+    _dt -= _step;
+
+    if (!_torque_on || _goal_current == 0)
+      _speed = 0.0;
+    else if (_current_ctrl)
+      _speed = param_.max_speed * _goal_current / table_.max_current;
+    else
+      _speed = std::max(-param_.max_speed, std::min(param_.max_speed, (_goal - position_) / param_.time_constant_sec));
+
+    double _position = position_ + _speed * _step;
+    _is_blocked = false;
+    if (_position > table_.max_position && _speed > 0.0)
+    {
+      _position   = table_.max_position;
+      _is_blocked = _current_ctrl;
+    }
+    if (_position < table_.min_position && _speed < 0.0)
+    {
+      _position   = table_.min_position;
+      _is_blocked = _current_ctrl;
+    }
+    if (object_position_ != SIM_NO_OBJECT && _speed > 0.0 && _position > object_position_)
+    {
+      _position   = std::max(position_, (double)object_position_);
+      _is_blocked = true;
+    }
+
+    velocity_ = (_position - position_) / _step;
+    position_ = _position;
+  }
+
+  // the fingers push against the object or the stroke end with the full Goal Current
+  if (_is_blocked)
+  {
+    velocity_         = 0.0;
+    present_current_  = (_goal_current < 0 || (!_current_ctrl && _goal < position_))? -abs(_goal_current):abs(_goal_current);
+  }
+  else
+  {
+    present_current_  = (int32_t)lround(velocity_ * param_.current_per_speed);
+    present_current_  = std::max(-abs(_goal_current), std::min(abs(_goal_current), present_current_));
+  }
+  updatePresent();
+
+  int32_t _moving = 0;
+  if (_torque_on)
+  {
+    if (_current_ctrl)
+      _moving = (fabs(velocity_) >= 1.0)? 1:0;
+    else
+      _moving = (abs(_goal - (int32_t)lround(position_)) > param_.moving_threshold)? 1:0;
+  }
+  setValue(table_.addr_moving, LEN_MOVING, _moving);
+}
+
+uint8_t SimGripper::read(uint16_t address, uint16_t length, uint8_t *data) const
+{
+  if (length == 0 || address + length > SIM_CONTROL_TABLE_SIZE)
+    return P2_ERRNUM_DATA_RANGE;
+
+  for (uint16_t i = 0; i < length; i++)
+    data[i] = memory_[resolveAddress(address + i)];
+  return 0;
+}
+
+uint8_t SimGripper::write(uint16_t address, uint16_t length, const uint8_t *data)
+{
+  if (length == 0 || address + length > SIM_CONTROL_TABLE_SIZE)
+    return P2_ERRNUM_DATA_RANGE;
+
+  for (uint16_t i = 0; i < length; i++)
+  {
+    if (!isWritable(resolveAddress(address + i)))
+      return P2_ERRNUM_ACCESS;
+  }
+
+  uint8_t _backup[SIM_CONTROL_TABLE_SIZE];
+  memcpy(_backup, memory_, sizeof(memory_));
+  for (uint16_t i = 0; i < length; i++)
+    memory_[resolveAddress(address + i)] = data[i];
+
+  int32_t _goal_position  = getValue(table_.addr_goal_position, LEN_GOAL_POSITION);
+  int32_t _goal_current   = getValue(table_.addr_goal_current, LEN_GOAL_CURRENT);
+  if (_goal_position < table_.min_position || _goal_position > table_.max_position ||
+      _goal_current < -table_.max_current || _goal_current > table_.max_current ||
+      getBaudRate(memory_[ADDR_BAUD_RATE]) == 0 || memory_[ADDR_ID] >= P2_BROADCAST_ID)
+  {
+    memcpy(memory_, _backup, sizeof(memory_));
+    return P2_ERRNUM_DATA_LIMIT;
+  }
+
+  if (memcmp(&memory_[table_.addr_goal_position], &_backup[table_.addr_goal_position], LEN_GOAL_POSITION) != 0 ||
+      memcmp(&memory_[table_.addr_goal_current], &_backup[table_.addr_goal_current], LEN_GOAL_CURRENT) != 0)
+    goal_change_nsec_ = last_update_nsec_;
+  return 0;
+}
+
+uint8_t SimGripper::regWrite(uint16_t address, uint16_t length, const uint8_t *data)
+{
+  if (length == 0 || address + length > SIM_CONTROL_TABLE_SIZE)
+    return P2_ERRNUM_DATA_RANGE;
+
+  registered_data_.assign(data, data + length);
+  registered_address_ = address;
+  is_registered_      = true;
+  return 0;
+}
+
+void SimGripper::action()
+{
+  if (!is_registered_)
+    return;
+
+  write(registered_address_, (uint16_t)registered_data_.size(), &registered_data_[0]);
+  is_registered_ = false;
+}
+
+SimBus::SimBus()
+  : packet_count_(0)
+{ }
+
+SimBus::~SimBus()
+{
+  for (size_t i = 0; i < gripper_list_.size(); i++)
+    delete gripper_list_[i];
+}
+
+SimGripper *SimBus::addGripper(const ControlTable &table, uint8_t id)
+{
+  SimGripper *_gripper = new SimGripper(table, id);
+  gripper_list_.push_back(_gripper);
+  return _gripper;
+}
+
+SimGripper *SimBus::getGripper(uint8_t id) const
+{
+  for (size_t i = 0; i < gripper_list_.size(); i++)
+  {
+    if (gripper_list_[i]->getID() == id)
+      return gripper_list_[i];
+  }
+  return NULL;
+}
+
+void SimBus::update(uint64_t now_nsec)
+{
+  for (size_t i = 0; i < gripper_list_.size(); i++)
+    gripper_list_[i]->update(now_nsec);
+}
+
+void SimBus::addStatus(SimGripper *gripper, uint8_t error, const uint8_t *param, size_t param_length,
+                       std::vector<uint8_t> *data, std::vector<Reply> *reply_list)
+{
+  uint8_t _packet[P2_MAX_PACKET_LENGTH];
+
+  payload_.resize(1 + param_length);
+  payload_[0] = error;
+  if (param_length > 0)
+    memcpy(&payload_[1], param, param_length);
+
+  Reply _reply;
+  _reply.offset             = data->size();
+  _reply.length             = buildPacket(gripper->getID(), P2_INST_STATUS, &payload_[0], payload_.size(), _packet);
+  _reply.return_delay_usec  = gripper->getReturnDelayTime();
+
+  data->insert(data->end(), _packet, _packet + _reply.length);
+  reply_list->push_back(_reply);
+}
+
+void SimBus::process(const uint8_t *packet, size_t length, int baudrate, uint64_t now_nsec,
+                     std::vector<uint8_t> *data, std::vector<Reply> *reply_list)
+{
+  if (length < P2_MIN_PACKET_LENGTH)
+    return;
+
+  packet_count_++;
+  update(now_nsec);
+
+  uint8_t         _id           = packet[P2_ID];
+  uint8_t         _instruction  = packet[P2_INSTRUCTION];
+  const uint8_t  *_param        = packet + P2_INSTRUCTION_PARAM;
+  size_t          _param_length = length - P2_MIN_PACKET_LENGTH;
+  uint8_t         _buffer[SIM_CONTROL_TABLE_SIZE];
+
+  // grippers that hear the packet
+  std::vector<SimGripper *> _target_list;
+  for (size_t i = 0; i < gripper_list_.size(); i++)
+  {
+    if (gripper_list_[i]->getBaudRate() == baudrate && (_id == P2_BROADCAST_ID || gripper_list_[i]->getID() == _id))
+      _target_list.push_back(gripper_list_[i]);
+  }
+  if (_target_list.empty())
+    return;
+
+  bool      _is_broadcast = (_id == P2_BROADCAST_ID);
+  uint16_t  _address      = (_param_length >= 2)? (_param[0] | (_param[1] << 8)):0;
+  uint16_t  _length       = (_param_length >= 4)? (_param[2] | (_param[3] << 8)):0;
+
+  switch (_instruction)
+  {
+    case P2_INST_PING:
+    {
+      // a broadcast ping is answered in ID order
+      std::vector<SimGripper *> _list = _target_list;
+      std::sort(_list.begin(), _list.end(), [](SimGripper *a, SimGripper *b) { return a->getID() < b->getID(); });
+      for (size_t i = 0; i < _list.size(); i++)
+      {
+        uint16_t _model = _list[i]->getControlTable().model_number;
+        uint8_t  _info[3] = { (uint8_t)(_model & 0xFF), (uint8_t)(_model >> 8), 0 };
+        _list[i]->read(ADDR_FIRMWARE_VERSION, 1, &_info[2]);
+        addStatus(_list[i], 0, _info, sizeof(_info), data, reply_list);
+      }
+      break;
+    }
+
+    case P2_INST_READ:
+      if (_is_broadcast)
+        break;
+      if (_param_length != 4)
+        addStatus(_target_list[0], P2_ERRNUM_DATA_LENGTH, NULL, 0, data, reply_list);
+      else
+      {
+        uint8_t _error = _target_list[0]->read(_address, _length, _buffer);
+        addStatus(_target_list[0], _error, _buffer, (_error == 0)? _length:0, data, reply_list);
+      }
+      break;
+
+    case P2_INST_WRITE:
+    case P2_INST_REG_WRITE:
+      for (size_t i = 0; i < _target_list.size(); i++)
+      {
+        uint8_t _error = P2_ERRNUM_DATA_LENGTH;
+        if (_param_length > 2 && _instruction == P2_INST_WRITE)
+          _error = _target_list[i]->write(_address, (uint16_t)(_param_length - 2), _param + 2);
+        else if (_param_length > 2)
+          _error = _target_list[i]->regWrite(_address, (uint16_t)(_param_length - 2), _param + 2);
+        if (!_is_broadcast)
+          addStatus(_target_list[i], _error, NULL, 0, data, reply_list);
+      }
+      break;
+
+    case P2_INST_ACTION:
+      for (size_t i = 0; i < _target_list.size(); i++)
+      {
+        _target_list[i]->action();
+        if (!_is_broadcast)
+          addStatus(_target_list[i], 0, NULL, 0, data, reply_list);
+      }
+      break;
+
+    case P2_INST_REBOOT:
+      for (size_t i = 0; i < _target_list.size(); i++)
+      {
+        if (!_is_broadcast)
+          addStatus(_target_list[i], 0, NULL, 0, data, reply_list);
+        _target_list[i]->reboot();
+      }
+      break;
+
+    case P2_INST_FACTORY_RESET:
+    {
+      // the status goes out before the reset, from the old ID and baud rate
+      uint8_t _error = 0;
+      if (_param_length != 1)
+        _error = P2_ERRNUM_DATA_LENGTH;
+      else if (_param[0] != P2_RESET_ALL && _param[0] != P2_RESET_EXCEPT_ID && _param[0] != P2_RESET_EXCEPT_ID_BAUD)
+        _error = P2_ERRNUM_DATA_RANGE;
+
+      for (size_t i = 0; i < _target_list.size(); i++)
+      {
+        if (!_is_broadcast)
+          addStatus(_target_list[i], _error, NULL, 0, data, reply_list);
+        if (_error == 0)
+          _target_list[i]->factoryReset(_param[0]);
+      }
+      break;
+    }
+
+    case P2_INST_SYNC_READ:
+      // replies follow the order of the ID list
+      for (size_t p = 4; _is_broadcast && _param_length >= 4 && p < _param_length; p++)
+      {
+        SimGripper *_gripper = getGripper(_param[p]);
+        if (_gripper == NULL || _gripper->getBaudRate() != baudrate)
+          continue;
+        uint8_t _error = _gripper->read(_address, _length, _buffer);
+        addStatus(_gripper, _error, _buffer, (_error == 0)? _length:0, data, reply_list);
+      }
+      break;
+
+    case P2_INST_SYNC_WRITE:
+      for (size_t p = 4; _is_broadcast && _length > 0 && p + 1 + _length <= _param_length; p += 1 + _length)
+      {
+        SimGripper *_gripper = getGripper(_param[p]);
+        if (_gripper != NULL && _gripper->getBaudRate() == baudrate)
+          _gripper->write(_address, _length, _param + p + 1);
+      }
+      break;
+
+    case P2_INST_BULK_READ:
+      for (size_t p = 0; _is_broadcast && p + 5 <= _param_length; p += 5)
+      {
+        SimGripper *_gripper = getGripper(_param[p]);
+        if (_gripper == NULL || _gripper->getBaudRate() != baudrate)
+          continue;
+        uint16_t  _bulk_address = _param[p + 1] | (_param[p + 2] << 8);
+        uint16_t  _bulk_length  = _param[p + 3] | (_param[p + 4] << 8);
+        uint8_t   _error        = _gripper->read(_bulk_address, _bulk_length, _buffer);
+        addStatus(_gripper, _error, _buffer, (_error == 0)? _bulk_length:0, data, reply_list);
+      }
+      break;
+
+    case P2_INST_BULK_WRITE:
+      for (size_t p = 0; _is_broadcast && p + 5 <= _param_length; )
+      {
+        uint16_t _bulk_address  = _param[p + 1] | (_param[p + 2] << 8);
+        uint16_t _bulk_length   = _param[p + 3] | (_param[p + 4] << 8);
+        if (p + 5 + _bulk_length > _param_length)
+          break;
+        SimGripper *_gripper = getGripper(_param[p]);
+        if (_gripper != NULL && _gripper->getBaudRate() == baudrate)
+          _gripper->write(_bulk_address, _bulk_length, _param + p + 5);
+        p += 5 + _bulk_length;
+      }
+      break;
+
+    default:
+      if (!_is_broadcast)
+        addStatus(_target_list[0], P2_ERRNUM_INSTRUCTION, NULL, 0, data, reply_list);
+      break;
+  }
+}
+
+}
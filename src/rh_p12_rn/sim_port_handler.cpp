@@ -0,0 +1,257 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/sim_port_handler.h"
+
+#define SIM_LATENCY_TIMER       16      // ms, the same packet timeout margin as PortHandlerLinux
+
+namespace rh_p12_rn
+{
+
+SimPortHandler::SimPortHandler(const char *port_name)
+  : baudrate_(DEFAULT_BAUDRATE_),
+    is_timing_enabled_(true),
+    latency_usec_(0),
+    byte_time_nsec_(0),
+    bus_free_nsec_(0),
+    packet_start_time_(0.0),
+    packet_timeout_(0.0),
+    tx_time_per_byte_(0.0),
+    rx_read_(0)
+{
+  is_using_ = false;
+  setPortName(port_name);
+  setBaudRate(baudrate_);
+}
+
+bool SimPortHandler::openPort()
+{
+  return setBaudRate(baudrate_);
+}
+
+void SimPortHandler::closePort()
+{
+  clearPort();
+}
+
+void SimPortHandler::clearPort()
+{
+  tx_stream_.clear();
+  rx_data_.clear();
+  rx_segment_list_.clear();
+  rx_read_ = 0;
+}
+
+void SimPortHandler::setPortName(const char *port_name)
+{
+  strncpy(port_name_, port_name, sizeof(port_name_) - 1);
+  port_name_[sizeof(port_name_) - 1] = 0;
+}
+
+char *SimPortHandler::getPortName()
+{
+  return port_name_;
+}
+
+bool SimPortHandler::setBaudRate(const int baudrate)
+{
+  if (baudrate <= 0)
+    return false;
+
+  baudrate_         = baudrate;
+  byte_time_nsec_   = 10ULL * 1000000000ULL / baudrate;   // start bit, 8 data bits, stop bit
+  tx_time_per_byte_ = (1000.0 / (double)baudrate_) * 10.0;
+  return true;
+}
+
+int SimPortHandler::getBaudRate()
+{
+  return baudrate_;
+}
+
+size_t SimPortHandler::getArrivedLength(uint64_t now_nsec) const
+{
+  if (!is_timing_enabled_)
+    return rx_data_.size();
+
+  size_t _length = 0;
+  for (size_t i = 0; i < rx_segment_list_.size(); i++)
+  {
+    const Segment &_segment = rx_segment_list_[i];
+    if (now_nsec < _segment.start_nsec)
+      break;
+
+    size_t _bytes = (byte_time_nsec_ == 0)? _segment.length:(size_t)((now_nsec - _segment.start_nsec) / byte_time_nsec_);
+    if (_bytes < _segment.length)
+      return _length + _bytes;
+    _length += _segment.length;
+  }
+  return _length;
+}
+
+int SimPortHandler::getBytesAvailable()
+{
+  return (int)(getArrivedLength(getMonotonicTimeNsec()) - rx_read_);
+}
+
+int SimPortHandler::readPort(uint8_t *packet, int length)
+{
+  size_t _available = getArrivedLength(getMonotonicTimeNsec()) - rx_read_;
+  size_t _length    = std::min((size_t)length, _available);
+
+  if (_length > 0)
+  {
+    memcpy(packet, &rx_data_[rx_read_], _length);
+    rx_read_ += _length;
+  }
+  if (rx_read_ == rx_data_.size())
+  {
+    rx_data_.clear();
+    rx_segment_list_.clear();
+    rx_read_ = 0;
+  }
+  return (int)_length;
+}
+
+int SimPortHandler::writePort(uint8_t *packet, int length)
+{
+  uint64_t _now     = getMonotonicTimeNsec();
+  uint64_t _cursor  = std::max(_now, bus_free_nsec_) + byte_time_nsec_ * length;
+
+  // the adapter latency is paid once per transfer in each direction
+  _cursor += latency_usec_ * 1000ULL;
+
+  tx_stream_.append(packet, length);
+  while (tx_stream_.pop(&tx_packet_))
+  {
+    size_t _first = reply_list_.size();
+    bus_.process(&tx_packet_[0], tx_packet_.size(), baudrate_, _now, &rx_data_, &reply_list_);
+
+    for (size_t i = _first; i < reply_list_.size(); i++)
+    {
+      Segment _segment;
+      _segment.offset     = reply_list_[i].offset;
+      _segment.length     = reply_list_[i].length;
+      _segment.start_nsec = _cursor + reply_list_[i].return_delay_usec * 1000ULL;
+      rx_segment_list_.push_back(_segment);
+
+      _cursor = _segment.start_nsec + byte_time_nsec_ * _segment.length;
+    }
+  }
+  reply_list_.clear();
+
+  bus_free_nsec_ = (is_timing_enabled_)? _cursor:0;
+  return length;
+}
+
+void SimPortHandler::setPacketTimeout(uint16_t packet_length)
+{
+  packet_start_time_  = getCurrentTime();
+  packet_timeout_     = (tx_time_per_byte_ * (double)packet_length) + (SIM_LATENCY_TIMER * 2.0) + 2.0;
+}
+
+void SimPortHandler::setPacketTimeout(double msec)
+{
+  packet_start_time_  = getCurrentTime();
+  packet_timeout_     = msec;
+}
+
+bool SimPortHandler::isPacketTimeout()
+{
+  // nothing more is on its way : waiting out the timeout only costs time
+  if (!is_timing_enabled_ && rx_read_ == rx_data_.size())
+  {
+    packet_timeout_ = 0;
+    return true;
+  }
+
+  if (getTimeSinceStart() > packet_timeout_)
+  {
+    packet_timeout_ = 0;
+    return true;
+  }
+  return false;
+}
+
+double SimPortHandler::getCurrentTime()
+{
+  return (double)getMonotonicTimeNsec() / 1000000.0;
+}
+
+double SimPortHandler::getTimeSinceStart()
+{
+  double _time = getCurrentTime() - packet_start_time_;
+  if (_time < 0.0)
+    packet_start_time_ = getCurrentTime();
+
+  return _time;
+}
+
+SimPortHandler *getSimPortHandler(const char *port_name, const ControlTable &table)
+{
+  size_t _prefix_length = strlen(SIM_PORT_PREFIX);
+  if (strncmp(port_name, SIM_PORT_PREFIX, _prefix_length) != 0 ||
+      (port_name[_prefix_length] != 0 && port_name[_prefix_length] != ':'))
+    return NULL;
+
+  const ControlTable   *_table = &table;
+  std::vector<uint8_t>  _id_list;
+  bool                  _is_fast = false;
+
+  // sim[:<id>[,<id>...]][:rn|:rna][:fast]
+  const char *_token = port_name + _prefix_length;
+  while (*_token == ':')
+  {
+    _token++;
+    size_t _length = strcspn(_token, ":");
+
+    if (_length == 2 && strncmp(_token, "rn", 2) == 0)
+      _table = &CONTROL_TABLE_RH_P12_RN;
+    else if (_length == 3 && strncmp(_token, "rna", 3) == 0)
+      _table = &CONTROL_TABLE_RH_P12_RNA;
+    else if (_length == 4 && strncmp(_token, "fast", 4) == 0)
+      _is_fast = true;
+    else
+    {
+      for (const char *_id = _token; _id < _token + _length; _id += strcspn(_id, ",:") + 1)
+      {
+        int _value = (*_id >= '0' && *_id <= '9')? atoi(_id):-1;
+        if (_value < 0 || _value >= P2_BROADCAST_ID - 1)
+          fprintf(stderr, "[%s] ignoring ID %.*s\n", port_name, (int)strcspn(_id, ",:"), _id);
+        else
+          _id_list.push_back((uint8_t)_value);
+      }
+    }
+    _token += _length;
+  }
+  if (_id_list.empty())
+    _id_list.push_back(1);
+
+  SimPortHandler *_port = new SimPortHandler(port_name);
+  for (size_t i = 0; i < _id_list.size(); i++)
+    _port->getBus().addGripper(*_table, _id_list[i]);
+  _port->setWireTiming(!_is_fast);
+  return _port;
+}
+
+}
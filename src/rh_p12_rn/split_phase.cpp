@@ -0,0 +1,61 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+#include <string.h>
+
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/split_phase.h"
+
+namespace rh_p12_rn
+{
+
+SplitPhaseEngine::SplitPhaseEngine()
+{
+  resetStats();
+}
+
+void SplitPhaseEngine::resetStats()
+{
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+int SplitPhaseEngine::run(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port,
+                          const Phase &tx, const Work &work, const Phase &rx)
+{
+  int _result = tx(ph, port);
+
+  uint64_t _sent = getMonotonicTimeNsec();
+  if (work)
+    work();
+  uint64_t _worked = getMonotonicTimeNsec();
+
+  if (_result == COMM_SUCCESS)
+    _result = rx(ph, port);
+  uint64_t _received = getMonotonicTimeNsec();
+
+  stats_.count++;
+  if (_result != COMM_SUCCESS)
+    stats_.fail_count++;
+  stats_.work_nsec  += _worked - _sent;
+  stats_.wait_nsec  += _received - _worked;
+  if (_received - _worked > stats_.max_wait_nsec)
+    stats_.max_wait_nsec = _received - _worked;
+
+  return _result;
+}
+
+}
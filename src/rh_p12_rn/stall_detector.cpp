@@ -0,0 +1,161 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "rh_p12_rn/stall_detector.h"
+#include "rh_p12_rn/register_view.h"
+
+namespace rh_p12_rn
+{
+
+// the span holding Moving, Present Position and Present Current
+static void getMotionStateRange(const ControlTable &table, uint16_t *start, uint16_t *length)
+{
+  uint16_t  _end  = std::max(table.addr_moving + LEN_MOVING,
+                             std::max(table.addr_present_position + LEN_PRESENT_POSITION,
+                                      table.addr_present_current + LEN_PRESENT_CURRENT));
+
+  *start  = std::min(table.addr_moving, std::min(table.addr_present_position, table.addr_present_current));
+  *length = _end - *start;
+}
+
+static void decodeMotionState(const ControlTable &table, const uint8_t *data, uint16_t start, uint16_t length, MotionState *state)
+{
+  MotionLayout _layout(table);
+  MotionView(RegisterView(data, start, length), _layout).getMotionState(state);
+}
+
+int readMotionState(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                    const ControlTable &table, MotionState *state, uint8_t *error)
+{
+  uint16_t  _start, _length;
+  uint8_t   _data[32];
+
+  getMotionStateRange(table, &_start, &_length);
+  if (_length > sizeof(_data))
+    return COMM_NOT_AVAILABLE;
+
+  int _result = ph->readTxRx(port, id, _start, _length, _data, error);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  decodeMotionState(table, _data, _start, _length, state);
+  return COMM_SUCCESS;
+}
+
+int readMotionStateTx(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                      const ControlTable &table)
+{
+  uint16_t  _start, _length;
+
+  getMotionStateRange(table, &_start, &_length);
+  return ph->readTx(port, id, _start, _length);
+}
+
+int readMotionStateRx(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                      const ControlTable &table, MotionState *state, uint8_t *error)
+{
+  uint16_t  _start, _length;
+  uint8_t   _data[32];
+
+  getMotionStateRange(table, &_start, &_length);
+  if (_length > sizeof(_data))
+    return COMM_NOT_AVAILABLE;
+
+  int _result = ph->readRx(port, id, _length, _data, error);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  decodeMotionState(table, _data, _start, _length, state);
+  return COMM_SUCCESS;
+}
+
+const int32_t StallDetector::NO_GOAL_POSITION;
+
+StallDetector::Param::Param()
+  : position_tolerance(10),
+    stall_position_delta(2),
+    stall_current(0),
+    settle_time_usec(10 * 1000),
+    stall_time_usec(20 * 1000),
+    idle_time_usec(300 * 1000),
+    start_grace_usec(50 * 1000)
+{ }
+
+StallDetector::StallDetector()
+{
+  reset(NO_GOAL_POSITION, 0);
+}
+
+void StallDetector::reset(int32_t goal_position, uint64_t now_usec)
+{
+  goal_position_    = goal_position;
+  start_time_       = now_usec;
+
+  is_in_tolerance_  = false;
+  in_tolerance_time_ = now_usec;
+
+  has_anchor_       = false;
+  anchor_position_  = 0;
+  anchor_time_      = now_usec;
+}
+
+StallDetector::Event StallDetector::update(const MotionState &state, uint64_t now_usec)
+{
+  // arrival : in tolerance and either stopped or settled there
+  if (goal_position_ != NO_GOAL_POSITION &&
+      abs(state.present_position - goal_position_) <= param_.position_tolerance)
+  {
+    if (is_in_tolerance_ == false)
+    {
+      is_in_tolerance_  = true;
+      in_tolerance_time_ = now_usec;
+    }
+
+    if (state.moving == 0 || now_usec - in_tolerance_time_ >= param_.settle_time_usec)
+      return EVENT_ARRIVED;
+  }
+  else
+  {
+    is_in_tolerance_ = false;
+  }
+
+  // stall : standing still long enough, confirmed by the current draw
+  if (has_anchor_ == false || abs(state.present_position - anchor_position_) > param_.stall_position_delta)
+  {
+    has_anchor_       = true;
+    anchor_position_  = state.present_position;
+    anchor_time_      = now_usec;
+  }
+
+  if (now_usec - start_time_ < param_.start_grace_usec)
+    return EVENT_NONE;
+
+  uint64_t _still_time = now_usec - anchor_time_;
+
+  if (state.moving == 0 && _still_time >= param_.stall_time_usec &&
+      (param_.stall_current == 0 || abs(state.present_current) >= param_.stall_current))
+    return EVENT_STALLED;
+
+  if (_still_time >= param_.idle_time_usec)
+    return EVENT_STALLED;
+
+  return EVENT_NONE;
+}
+
+}
@@ -0,0 +1,131 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+#include "rh_p12_rn/status_block.h"
+
+namespace rh_p12_rn
+{
+
+namespace
+{
+
+struct Field
+{
+  uint16_t  address;
+  uint16_t  length;
+};
+
+// every StatusBlock register of the model, ADDR_NONE entries included
+void getFields(const ControlTable &table, Field *fields)
+{
+  fields[0].address  = table.addr_goal_pwm;            fields[0].length  = LEN_GOAL_PWM;
+  fields[1].address  = table.addr_goal_current;        fields[1].length  = LEN_GOAL_CURRENT;
+  fields[2].address  = table.addr_goal_velocity;       fields[2].length  = LEN_GOAL_VELOCITY;
+  fields[3].address  = table.addr_goal_acceleration;   fields[3].length  = LEN_GOAL_ACCELERATION;
+  fields[4].address  = table.addr_goal_position;       fields[4].length  = LEN_GOAL_POSITION;
+  fields[5].address  = table.addr_moving;              fields[5].length  = LEN_MOVING;
+  fields[6].address  = table.addr_present_position;    fields[6].length  = LEN_PRESENT_POSITION;
+  fields[7].address  = table.addr_present_velocity;    fields[7].length  = LEN_PRESENT_VELOCITY;
+  fields[8].address  = table.addr_present_current;     fields[8].length  = LEN_PRESENT_CURRENT;
+  fields[9].address  = table.addr_present_voltage;     fields[9].length  = LEN_PRESENT_VOLTAGE;
+  fields[10].address = table.addr_present_temperature; fields[10].length = LEN_PRESENT_TEMPERATURE;
+}
+
+const int FIELD_COUNT = 11;
+const int MAX_BLOCK_LENGTH = 64;
+
+uint32_t getValue(const uint8_t *data, uint16_t start_address, uint16_t address, uint16_t length)
+{
+  if (address == ADDR_NONE)
+    return 0;
+
+  const uint8_t *_p = &data[address - start_address];
+  switch (length)
+  {
+    case 1:
+      return _p[0];
+    case 2:
+      return DXL_MAKEWORD(_p[0], _p[1]);
+    default:
+      return DXL_MAKEDWORD(DXL_MAKEWORD(_p[0], _p[1]), DXL_MAKEWORD(_p[2], _p[3]));
+  }
+}
+
+}
+
+void getStatusBlockRange(const ControlTable &table, uint16_t *start_address, uint16_t *data_length)
+{
+  Field _fields[FIELD_COUNT];
+  getFields(table, _fields);
+
+  uint16_t _start = 0xFFFF;
+  uint16_t _end   = 0;
+  for (int i = 0; i < FIELD_COUNT; i++)
+  {
+    if (_fields[i].address == ADDR_NONE)
+      continue;
+    if (_fields[i].address < _start)
+      _start = _fields[i].address;
+    if (_fields[i].address + _fields[i].length > _end)
+      _end = _fields[i].address + _fields[i].length;
+  }
+
+  *start_address  = _start;
+  *data_length    = _end - _start;
+}
+
+bool decodeStatusBlock(const ControlTable &table, const uint8_t *data, uint16_t start_address, uint16_t data_length,
+                       StatusBlock *block)
+{
+  uint16_t _start, _length;
+  getStatusBlockRange(table, &_start, &_length);
+  if (_start < start_address || _start + _length > start_address + data_length)
+    return false;
+
+  block->goal_pwm             = (int16_t)getValue(data, start_address, table.addr_goal_pwm, LEN_GOAL_PWM);
+  block->goal_current         = (int16_t)getValue(data, start_address, table.addr_goal_current, LEN_GOAL_CURRENT);
+  block->goal_velocity        = (int32_t)getValue(data, start_address, table.addr_goal_velocity, LEN_GOAL_VELOCITY);
+  block->goal_acceleration    = (int32_t)getValue(data, start_address, table.addr_goal_acceleration, LEN_GOAL_ACCELERATION);
+  block->goal_position        = (int32_t)getValue(data, start_address, table.addr_goal_position, LEN_GOAL_POSITION);
+  block->moving               = (uint8_t)getValue(data, start_address, table.addr_moving, LEN_MOVING);
+  block->present_position     = (int32_t)getValue(data, start_address, table.addr_present_position, LEN_PRESENT_POSITION);
+  block->present_velocity     = (int32_t)getValue(data, start_address, table.addr_present_velocity, LEN_PRESENT_VELOCITY);
+  block->present_current      = (int16_t)getValue(data, start_address, table.addr_present_current, LEN_PRESENT_CURRENT);
+  block->present_voltage      = (uint16_t)getValue(data, start_address, table.addr_present_voltage, LEN_PRESENT_VOLTAGE);
+  block->present_temperature  = (uint8_t)getValue(data, start_address, table.addr_present_temperature, LEN_PRESENT_TEMPERATURE);
+
+  return true;
+}
+
+int readStatusBlock(dynamixel::PacketHandler *ph, dynamixel::PortHandler *port, uint8_t id,
+                    const ControlTable &table, StatusBlock *block, uint8_t *error)
+{
+  uint8_t   _data[MAX_BLOCK_LENGTH];
+  uint16_t  _start, _length;
+
+  getStatusBlockRange(table, &_start, &_length);
+  if (_length > MAX_BLOCK_LENGTH)
+    return COMM_NOT_AVAILABLE;
+
+  int _result = ph->readTxRx(port, id, _start, _length, _data, error);
+  if (_result != COMM_SUCCESS)
+    return _result;
+
+  decodeStatusBlock(table, _data, _start, _length, block);
+  return COMM_SUCCESS;
+}
+
+}
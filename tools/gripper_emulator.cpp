@@ -0,0 +1,266 @@
+/*******************************************************************************
+* Copyright 2017 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+// Gripper emulator : a pseudo-terminal with simulated RH-P12-RN / RH-P12-RN(A)
+// grippers behind it. The examples and benchmarks open the printed /dev/pts/N
+// (or the -l link) exactly as they open /dev/ttyUSB0, so the whole
+// PortHandlerLinux path runs without hardware.
+//
+// Status packets leave at their wire time : the instruction's own transfer
+// time, the Return Delay Time of the gripper, then 10 bits per byte at the
+// baud rate the client set on the terminal (-b when it is not a standard one).
+//
+// usage : gripper_emulator [-b baudrate] [-l link] [-f] [rn|rna:]<id>[,<id>...] ...
+//         -f sends every reply at once instead of at its wire time
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "rh_p12_rn/clock.h"
+#include "rh_p12_rn/control_table.h"
+#include "rh_p12_rn/protocol2.h"
+#include "rh_p12_rn/sim_gripper.h"
+
+using rh_p12_rn::getMonotonicTimeNsec;
+
+struct OutputByte
+{
+  uint8_t   data;
+  uint64_t  due_nsec;
+};
+
+volatile sig_atomic_t g_is_running = 1;
+
+void onSignal(int)
+{
+  g_is_running = 0;
+}
+
+int getTerminalBaudRate(int fd, int default_baudrate)
+{
+  struct termios _tio;
+  if (tcgetattr(fd, &_tio) != 0)
+    return default_baudrate;
+
+  switch (cfgetospeed(&_tio))
+  {
+    case B9600:     return 9600;
+    case B57600:    return 57600;
+    case B115200:   return 115200;
+    case B1000000:  return 1000000;
+    case B2000000:  return 2000000;
+    case B3000000:  return 3000000;
+    case B4000000:  return 4000000;
+    default:        return default_baudrate;
+  }
+}
+
+// [rn|rna:]<id>[,<id>...]
+bool addGrippers(rh_p12_rn::SimBus *bus, const char *spec)
+{
+  const rh_p12_rn::ControlTable *_table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RN;
+
+  if (strncmp(spec, "rna:", 4) == 0)
+  {
+    _table = &rh_p12_rn::CONTROL_TABLE_RH_P12_RNA;
+    spec += 4;
+  }
+  else if (strncmp(spec, "rn:", 3) == 0)
+  {
+    spec += 3;
+  }
+
+  for (const char *_id = spec; *_id != 0; _id += strcspn(_id, ","), _id += (*_id == ',')? 1:0)
+  {
+    int _value = (*_id >= '0' && *_id <= '9')? atoi(_id):-1;
+    if (_value < 0 || _value >= P2_BROADCAST_ID - 1 || bus->getGripper((uint8_t)_value) != NULL)
+    {
+      fprintf(stderr, "invalid or duplicate ID in %s\n", spec);
+      return false;
+    }
+    bus->addGripper(*_table, (uint8_t)_value);
+    printf(" - %-13s ID %d\n", _table->name, _value);
+  }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  int         _default_baudrate = 2000000;
+  const char *_link             = NULL;
+  bool        _is_timing        = true;
+  int         _opt;
+
+  rh_p12_rn::SimBus _bus;
+
+  while ((_opt = getopt(argc, argv, "b:l:f")) != -1)
+  {
+    switch (_opt)
+    {
+      case 'b': _default_baudrate = atoi(optarg); break;
+      case 'l': _link = optarg; break;
+      case 'f': _is_timing = false; break;
+      default:
+        fprintf(stderr, "usage : %s [-b baudrate] [-l link] [-f] [rn|rna:]<id>[,<id>...] ...\n", argv[0]);
+        return 1;
+    }
+  }
+
+  printf("Grippers :\n");
+  for (int i = optind; i < argc; i++)
+  {
+    if (!addGrippers(&_bus, argv[i]))
+      return 1;
+  }
+  if (_bus.getGripperCount() == 0)
+    addGrippers(&_bus, "1");
+
+  // pseudo-terminal in raw mode
+  int _master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (_master < 0 || grantpt(_master) != 0 || unlockpt(_master) != 0)
+  {
+    perror("posix_openpt");
+    return 1;
+  }
+
+  struct termios _tio;
+  tcgetattr(_master, &_tio);
+  cfmakeraw(&_tio);
+  tcsetattr(_master, TCSANOW, &_tio);
+
+  const char *_slave_name = ptsname(_master);
+
+  // keep the slave open so the master does not see EIO between clients
+  int _slave = open(_slave_name, O_RDWR | O_NOCTTY);
+  fcntl(_master, F_SETFL, fcntl(_master, F_GETFL) | O_NONBLOCK);
+
+  if (_link != NULL)
+  {
+    unlink(_link);
+    if (symlink(_slave_name, _link) != 0)
+    {
+      perror("symlink");
+      _link = NULL;
+    }
+  }
+
+  printf("Device   : %s%s%s\n", _slave_name, (_link != NULL)? " -> ":"", (_link != NULL)? _link:"");
+  printf("Timing   : %s\n\n", (_is_timing)? "wire time":"immediate");
+  fflush(stdout);
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  rh_p12_rn::PacketStream             _stream;
+  std::vector<uint8_t>                _packet;
+  std::vector<uint8_t>                _reply_data;
+  std::vector<rh_p12_rn::SimBus::Reply> _reply_list;
+  std::deque<OutputByte>              _output;
+  uint64_t                            _bus_free_nsec = 0;
+  uint64_t                            _reply_count   = 0;
+
+  while (g_is_running)
+  {
+    uint64_t _now = getMonotonicTimeNsec();
+
+    // send every byte that is due; the ones the pty does not take yet stay queued
+    uint8_t _chunk[256];
+    size_t  _chunk_length = 0;
+    bool    _is_blocked   = false;
+    for (size_t i = 0; i < _output.size() && _output[i].due_nsec <= _now && _chunk_length < sizeof(_chunk); i++)
+      _chunk[_chunk_length++] = _output[i].data;
+    if (_chunk_length > 0)
+    {
+      ssize_t _written = write(_master, _chunk, _chunk_length);
+      if (_written < 0 && errno != EAGAIN)
+      {
+        perror("write");
+        _written = _chunk_length;   // the client is gone : drop them
+      }
+      if (_written < 0)
+        _written = 0;
+      _output.erase(_output.begin(), _output.begin() + _written);
+      _is_blocked = ((size_t)_written < _chunk_length);
+    }
+
+    // wait for the next instruction byte and the next due byte, or for room in the pty
+    struct pollfd   _fd = { _master, (short)(POLLIN | ((_is_blocked)? POLLOUT:0)), 0 };
+    struct timespec _timeout;
+    struct timespec *_timeout_ptr = NULL;
+    if (!_output.empty() && !_is_blocked)
+    {
+      uint64_t _wait = (_output.front().due_nsec > _now)? _output.front().due_nsec - _now:0;
+      _timeout.tv_sec   = _wait / 1000000000ULL;
+      _timeout.tv_nsec  = _wait % 1000000000ULL;
+      _timeout_ptr      = &_timeout;
+    }
+    if (ppoll(&_fd, 1, _timeout_ptr, NULL) <= 0 || (_fd.revents & POLLIN) == 0)
+      continue;
+
+    uint8_t _buffer[1024];
+    ssize_t _length = read(_master, _buffer, sizeof(_buffer));
+    if (_length <= 0)
+      continue;
+
+    _now = getMonotonicTimeNsec();
+    int       _baudrate   = getTerminalBaudRate(_master, _default_baudrate);
+    uint64_t  _byte_nsec  = (_is_timing)? 10ULL * 1000000000ULL / _baudrate:0;
+
+    _stream.append(_buffer, _length);
+    while (_stream.pop(&_packet))
+    {
+      _reply_data.clear();
+      _reply_list.clear();
+      _bus.process(&_packet[0], _packet.size(), _baudrate, _now, &_reply_data, &_reply_list);
+
+      // the instruction is on the wire first, then each gripper answers in turn
+      uint64_t _cursor = std::max(_now, _bus_free_nsec) + _byte_nsec * _packet.size();
+      for (size_t r = 0; r < _reply_list.size(); r++)
+      {
+        if (_is_timing)
+          _cursor += _reply_list[r].return_delay_usec * 1000ULL;
+        for (size_t i = 0; i < _reply_list[r].length; i++)
+        {
+          _cursor += _byte_nsec;
+          OutputByte _byte = { _reply_data[_reply_list[r].offset + i], (_is_timing)? _cursor:0 };
+          _output.push_back(_byte);
+        }
+        _reply_count++;
+      }
+      _bus_free_nsec = (_is_timing)? _cursor:0;
+    }
+  }
+
+  printf("\n%lu instruction packets, %lu status packets, %lu CRC errors\n",
+         (unsigned long)_bus.getPacketCount(), (unsigned long)_reply_count, (unsigned long)_stream.getCRCErrorCount());
+
+  if (_link != NULL)
+    unlink(_link);
+  close(_slave);
+  close(_master);
+  return 0;
+}